@@ -21,6 +21,7 @@
  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  THE SOFTWARE.
 ******************************************************************************/
+#ifndef SUBCORE
 #include "main.h"
 #include "BM1383AGLV.h"
 
@@ -30,6 +31,11 @@ BM1383AGLV::BM1383AGLV(void)
 }
 
 byte BM1383AGLV::init(void)
+{
+  return (init(BM1383AGLV_MODE_CONTROL_VAL & BM1383AGLV_MODE_CONTROL_AVE_MASK));
+}
+
+byte BM1383AGLV::init(unsigned char average)
 {
   byte rc;
   unsigned char reg;
@@ -63,7 +69,7 @@ byte BM1383AGLV::init(void)
     return (rc);
   }
 
-  reg = BM1383AGLV_MODE_CONTROL_VAL;
+  reg = (BM1383AGLV_MODE_CONTROL_VAL & ~BM1383AGLV_MODE_CONTROL_AVE_MASK) | (average & BM1383AGLV_MODE_CONTROL_AVE_MASK);
   rc = write(BM1383AGLV_MODE_CONTROL, &reg, sizeof(reg));
   if (rc != 0) {
     Serial.println("Can't write BM1383AGLV MODE_CONTROL register");
@@ -119,6 +125,28 @@ byte BM1383AGLV::get_val( float *press, float *temp)
   return (rc);
 }
 
+byte BM1383AGLV::get_rawpress(unsigned long *press)
+{
+  byte rc;
+  unsigned char val[GET_BYTE_PRESS_TEMP];
+  unsigned long rawpress;
+
+  rc = get_rawval(val);
+  if (rc != 0) {
+    return (rc);
+  }
+
+  rawpress = (((unsigned long)val[0] << 16) | ((unsigned long)val[1] << 8) | val[2] & 0xFC) >> 2;
+
+  if (rawpress == 0) {
+    return (-1);
+  }
+
+  *press = rawpress;
+
+  return (rc);
+}
+
 byte BM1383AGLV::write(unsigned char memory_address, unsigned char *data, unsigned char size)
 {
   byte rc;
@@ -152,3 +180,5 @@ byte BM1383AGLV::read(unsigned char memory_address, unsigned char *data, int siz
 
   return (rc);
 }
+
+#endif /* SUBCORE */
@@ -36,7 +36,13 @@
 #define BM1383AGLV_POWER_DOWN_PWR_DOWN          (1 << 0)
 #define BM1383AGLV_RESET_RSTB                   (1 << 0)
 #define BM1383AGLV_MODE_CONTROL_AVE_NON         (0 << 5)
+#define BM1383AGLV_MODE_CONTROL_AVE_NUM2        (1 << 5)
+#define BM1383AGLV_MODE_CONTROL_AVE_NUM4        (2 << 5)
+#define BM1383AGLV_MODE_CONTROL_AVE_NUM8        (3 << 5)
+#define BM1383AGLV_MODE_CONTROL_AVE_NUM16       (4 << 5)
+#define BM1383AGLV_MODE_CONTROL_AVE_NUM32       (5 << 5)
 #define BM1383AGLV_MODE_CONTROL_AVE_NUM64       (6 << 5)
+#define BM1383AGLV_MODE_CONTROL_AVE_MASK        (7 << 5)
 #define BM1383AGLV_MODE_CONTROL_RESERVED_3BIT   (1 << 3)
 #define BM1383AGLV_MODE_CONTROL_MODE_CONTINUOUS (4 << 0)
 
@@ -55,8 +61,10 @@ class BM1383AGLV
   public:
       BM1383AGLV(void);
     byte init(void) ;
+    byte init(unsigned char average);
     byte get_rawval(unsigned char *data);
     byte get_val(float *press, float *temp);
+    byte get_rawpress(unsigned long *press);
     byte write(unsigned char memory_address, unsigned char *data, unsigned char size);
     byte read(unsigned char memory_address, unsigned char *data, int size);
 };
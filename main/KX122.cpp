@@ -17,15 +17,64 @@
  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  THE SOFTWARE.
 ******************************************************************************/
+#ifndef SUBCORE
 #include "main.h"
 #include "KX122.h"
 
+// Bytes per BUF_READ burst, whole samples within the Wire receive buffer
+#ifdef BUFFER_LENGTH
+#define KX122_BUF_READ_MAX        ((BUFFER_LENGTH / KX122_BUF_SAMPLE_SIZE) * KX122_BUF_SAMPLE_SIZE)
+#else
+#define KX122_BUF_READ_MAX        (5 * KX122_BUF_SAMPLE_SIZE)
+#endif
+
+// Sample period for each ODCNTL OSA setting [us]
+static const unsigned long kx122_period_us[] = {
+  80000,    // 12.5Hz
+  40000,    // 25Hz
+  20000,    // 50Hz
+  10000,    // 100Hz
+  5000,     // 200Hz
+  2500,     // 400Hz
+  1250,     // 800Hz
+  625,      // 1600Hz
+  1280000,  // 0.781Hz
+  640000,   // 1.563Hz
+  320000,   // 3.125Hz
+  160000,   // 6.25Hz
+  313,      // 3200Hz
+  156,      // 6400Hz
+  78,       // 12800Hz
+  39,       // 25600Hz
+};
+
 KX122::KX122(int slave_address)
 {
   _device_address = slave_address;
+  _odr = KX122_ODCNTL_VAL & KX122_ODCNTL_OSAMASK;
 }
 
 byte KX122::init(void)
+{
+  KX122_CONFIG config;
+
+  config.odr = KX122_ODCNTL_VAL;
+  config.range = KX122_CNTL1_VAL & KX122_CNTL1_GSELMASK;
+
+  return (init(&config));
+}
+
+unsigned long KX122::period_us(unsigned char odr)
+{
+  return (kx122_period_us[odr & KX122_ODCNTL_OSAMASK]);
+}
+
+unsigned long KX122::get_period_us(void)
+{
+  return (period_us(_odr));
+}
+
+byte KX122::init(const KX122_CONFIG *config)
 {
   byte rc;
   unsigned char reg;
@@ -45,19 +94,20 @@ byte KX122::init(void)
     return (rc);
   }
 
-  reg = KX122_CNTL1_VAL;
+  reg = (KX122_CNTL1_VAL & ~KX122_CNTL1_GSELMASK) | (config->range & KX122_CNTL1_GSELMASK);
   rc = write(KX122_CNTL1, &reg, sizeof(reg));
   if (rc != 0) {
     Serial.println("Can't write KX122 CNTL1 register at first");
     return (rc);
   }
 
-  reg = KX122_ODCNTL_VAL;
+  reg = (KX122_ODCNTL_VAL & ~KX122_ODCNTL_OSAMASK) | (config->odr & KX122_ODCNTL_OSAMASK);
   rc = write(KX122_ODCNTL, &reg, sizeof(reg));
   if (rc != 0) {
     Serial.println("Can't write KX122 ODCNTL register");
     return (rc);
   }
+  _odr = config->odr & KX122_ODCNTL_OSAMASK;
 
   rc = read(KX122_CNTL1, &reg, sizeof(reg));
   if (rc != 0) {
@@ -79,6 +129,8 @@ byte KX122::init(void)
     case KX122_CNTL1_GSEL_8G : _g_sens = 4096;  break;
     default: break;
   }
+
+  return (rc);
 }
 
 byte KX122::get_rawval(unsigned char *data)
@@ -93,20 +145,37 @@ byte KX122::get_rawval(unsigned char *data)
   return (rc);
 }
 
-byte KX122::get_val(float *data)
+byte KX122::get_cnt(signed short *data)
 {
   byte rc;
   unsigned char val[6];
-  signed short acc[3];
 
   rc = get_rawval(val);
   if (rc != 0) {
     return (rc);
   }
 
-  acc[0] = ((signed short)val[1] << 8) | (val[0]);
-  acc[1] = ((signed short)val[3] << 8) | (val[2]);
-  acc[2] = ((signed short)val[5] << 8) | (val[4]);
+  data[0] = ((signed short)val[1] << 8) | (val[0]);
+  data[1] = ((signed short)val[3] << 8) | (val[2]);
+  data[2] = ((signed short)val[5] << 8) | (val[4]);
+
+  return (rc);
+}
+
+unsigned short KX122::get_sens(void)
+{
+  return (_g_sens);
+}
+
+byte KX122::get_val(float *data)
+{
+  byte rc;
+  signed short acc[3];
+
+  rc = get_cnt(acc);
+  if (rc != 0) {
+    return (rc);
+  }
 
   // Convert LSB to g
   data[0] = (float)acc[0] / _g_sens;
@@ -116,6 +185,315 @@ byte KX122::get_val(float *data)
   return (rc);  
 }
 
+byte KX122::init_buf(unsigned char threshold)
+{
+  byte rc;
+  unsigned char reg;
+  unsigned char cntl1;
+
+  // Buffer settings can only be changed in stand-by mode
+  rc = read(KX122_CNTL1, &cntl1, sizeof(cntl1));
+  if (rc != 0) {
+    Serial.println("Can't read KX122 CNTL1 register");
+    return (rc);
+  }
+
+  reg = cntl1 & ~KX122_CNTL1_PC1;
+  rc = write(KX122_CNTL1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 CNTL1 register");
+    return (rc);
+  }
+
+  reg = threshold;
+  rc = write(KX122_BUF_CNTL1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 BUF_CNTL1 register");
+    return (rc);
+  }
+
+  reg = KX122_BUF_CNTL2_VAL;
+  rc = write(KX122_BUF_CNTL2, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 BUF_CNTL2 register");
+    return (rc);
+  }
+
+  rc = clear_buf();
+  if (rc != 0) {
+    return (rc);
+  }
+
+  reg = cntl1 | KX122_CNTL1_PC1;
+  rc = write(KX122_CNTL1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 CNTL1 register");
+    return (rc);
+  }
+
+  return (rc);
+}
+
+byte KX122::init_drdy(void)
+{
+  byte rc;
+  unsigned char reg;
+  unsigned char cntl1;
+
+  // Interrupt settings can only be changed in stand-by mode
+  rc = read(KX122_CNTL1, &cntl1, sizeof(cntl1));
+  if (rc != 0) {
+    Serial.println("Can't read KX122 CNTL1 register");
+    return (rc);
+  }
+
+  reg = cntl1 & ~KX122_CNTL1_PC1;
+  rc = write(KX122_CNTL1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 CNTL1 register");
+    return (rc);
+  }
+
+  // INT1 pin, active high pulse per new sample
+  reg = KX122_INC1_VAL;
+  rc = write(KX122_INC1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 INC1 register");
+    return (rc);
+  }
+
+  rc = read(KX122_INC4, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't read KX122 INC4 register");
+    return (rc);
+  }
+  reg |= KX122_INC4_DRDYI1;
+  rc = write(KX122_INC4, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 INC4 register");
+    return (rc);
+  }
+
+  reg = cntl1 | KX122_CNTL1_DRDYE | KX122_CNTL1_PC1;
+  rc = write(KX122_CNTL1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 CNTL1 register");
+    return (rc);
+  }
+
+  return (rc);
+}
+
+// threshold is in 1/16 [G], count in 1/100 [s]
+byte KX122::init_wuf(unsigned char threshold, unsigned char count)
+{
+  byte rc;
+  unsigned char reg;
+  unsigned char cntl1;
+
+  // Wake-up settings can only be changed in stand-by mode
+  rc = read(KX122_CNTL1, &cntl1, sizeof(cntl1));
+  if (rc != 0) {
+    Serial.println("Can't read KX122 CNTL1 register");
+    return (rc);
+  }
+
+  reg = cntl1 & ~KX122_CNTL1_PC1;
+  rc = write(KX122_CNTL1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 CNTL1 register");
+    return (rc);
+  }
+
+  rc = read(KX122_CNTL3, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't read KX122 CNTL3 register");
+    return (rc);
+  }
+  reg = (reg & ~KX122_CNTL3_OWUFMASK) | KX122_CNTL3_OWUF_100HZ;
+  rc = write(KX122_CNTL3, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 CNTL3 register");
+    return (rc);
+  }
+
+  reg = KX122_INC2_ALL_AXES;
+  rc = write(KX122_INC2, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 INC2 register");
+    return (rc);
+  }
+
+  reg = count;
+  rc = write(KX122_WUFC, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 WUFC register");
+    return (rc);
+  }
+
+  reg = threshold;
+  rc = write(KX122_ATH, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 ATH register");
+    return (rc);
+  }
+
+  // Only the status register is polled, INT1 keeps its own routing
+  rc = read(KX122_INT_REL, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't read KX122 INT_REL register");
+    return (rc);
+  }
+
+  reg = cntl1 | KX122_CNTL1_WUFE | KX122_CNTL1_PC1;
+  rc = write(KX122_CNTL1, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 CNTL1 register");
+    return (rc);
+  }
+
+  return (rc);
+}
+
+byte KX122::get_wuf(bool *motion)
+{
+  byte rc;
+  unsigned char reg;
+
+  rc = read(KX122_INS2, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't read KX122 INS2 register");
+    return (rc);
+  }
+
+  *motion = ((reg & KX122_INS2_WUFS) != 0);
+  if (*motion) {
+    // Reading INT_REL releases the latched wake-up status
+    rc = read(KX122_INT_REL, &reg, sizeof(reg));
+    if (rc != 0) {
+      Serial.println("Can't read KX122 INT_REL register");
+    }
+  }
+
+  return (rc);
+}
+
+byte KX122::clear_buf(void)
+{
+  byte rc;
+  unsigned char reg;
+
+  // Any value written to BUF_CLEAR empties the buffer
+  reg = 0;
+  rc = write(KX122_BUF_CLEAR, &reg, sizeof(reg));
+  if (rc != 0) {
+    Serial.println("Can't write KX122 BUF_CLEAR register");
+  }
+
+  return (rc);
+}
+
+byte KX122::get_buf_num(unsigned short *num)
+{
+  byte rc;
+  unsigned char val[2];
+
+  // BUF_STATUS_1 and BUF_STATUS_2 hold the buffer level in bytes
+  rc = read(KX122_BUF_STATUS_1, val, sizeof(val));
+  if (rc != 0) {
+    Serial.println("Can't get KX122 buffer status");
+    return (rc);
+  }
+
+  *num = (((unsigned short)(val[1] & KX122_BUF_STATUS_2_SMPMASK) << 8) | val[0]) / KX122_BUF_SAMPLE_SIZE;
+
+  return (rc);
+}
+
+byte KX122::get_buf_rawval(unsigned char *data, unsigned short num)
+{
+  byte rc = 0;
+  int size;
+  int chunk;
+
+  // Burst read from BUF_READ, split to fit the Wire receive buffer
+  size = (int)num * KX122_BUF_SAMPLE_SIZE;
+  while (size > 0) {
+    chunk = (size > KX122_BUF_READ_MAX) ? KX122_BUF_READ_MAX : size;
+    rc = read(KX122_BUF_READ, data, chunk);
+    if (rc != 0) {
+      Serial.println("Can't get KX122 buffer value");
+      return (rc);
+    }
+    data += chunk;
+    size -= chunk;
+  }
+
+  return (rc);
+}
+
+byte KX122::get_buf_cnt(signed short *data, unsigned short max_num, unsigned short *num)
+{
+  byte rc;
+  unsigned char val[KX122_BUF_READ_MAX];
+  unsigned short remain;
+  unsigned short chunk;
+  unsigned short cnt;
+
+  *num = 0;
+
+  rc = get_buf_num(&remain);
+  if (rc != 0) {
+    return (rc);
+  }
+  if (remain > max_num) {
+    remain = max_num;
+  }
+
+  while (remain > 0) {
+    chunk = (remain > (KX122_BUF_READ_MAX / KX122_BUF_SAMPLE_SIZE)) ? (KX122_BUF_READ_MAX / KX122_BUF_SAMPLE_SIZE) : remain;
+    rc = get_buf_rawval(val, chunk);
+    if (rc != 0) {
+      return (rc);
+    }
+
+    for (cnt = 0; cnt < chunk * 3; cnt++) {
+      data[cnt] = ((signed short)val[cnt * 2 + 1] << 8) | (val[cnt * 2]);
+    }
+    data += chunk * 3;
+    *num += chunk;
+    remain -= chunk;
+  }
+
+  return (rc);
+}
+
+byte KX122::get_buf_val(float *data, unsigned short max_num, unsigned short *num)
+{
+  byte rc;
+  signed short acc[KX122_BUF_READ_MAX / 2];
+  unsigned short chunk;
+  unsigned short cnt;
+
+  *num = 0;
+
+  do {
+    rc = get_buf_cnt(acc, min(max_num - *num, KX122_BUF_READ_MAX / KX122_BUF_SAMPLE_SIZE), &chunk);
+    if (rc != 0) {
+      return (rc);
+    }
+
+    // Convert LSB to g
+    for (cnt = 0; cnt < chunk * 3; cnt++) {
+      data[cnt] = (float)acc[cnt] / _g_sens;
+    }
+    data += chunk * 3;
+    *num += chunk;
+  } while ((chunk == KX122_BUF_READ_MAX / KX122_BUF_SAMPLE_SIZE) && (*num < max_num));
+
+  return (rc);
+}
+
 byte KX122::write(unsigned char memory_address, unsigned char *data, unsigned char size)
 {
   byte rc;
@@ -150,3 +528,5 @@ byte KX122::read(unsigned char memory_address, unsigned char *data, int size)
 
   return (0);
 }
+
+#endif /* SUBCORE */
@@ -30,8 +30,29 @@
 
 #define KX122_XOUT_L              (0x06)
 #define KX122_WHO_AM_I            (0x0F)
+#define KX122_INS2                (0x13)
+#define KX122_INT_REL             (0x17)
 #define KX122_CNTL1               (0x18)
+#define KX122_CNTL3               (0x1A)
 #define KX122_ODCNTL              (0x1B)
+#define KX122_INC1                (0x1C)
+#define KX122_INC2                (0x1D)
+#define KX122_INC4                (0x1F)
+#define KX122_WUFC                (0x23)
+#define KX122_ATH                 (0x30)
+#define KX122_BUF_CNTL1           (0x3A)
+#define KX122_BUF_CNTL2           (0x3B)
+#define KX122_BUF_STATUS_1        (0x3C)
+#define KX122_BUF_STATUS_2        (0x3D)
+#define KX122_BUF_CLEAR           (0x3E)
+#define KX122_BUF_READ            (0x3F)
+
+#define KX122_INS2_WUFS           (1 << 1)
+
+#define KX122_CNTL3_OWUF_100HZ    (7)
+#define KX122_CNTL3_OWUFMASK      (0x07)
+
+#define KX122_INC2_ALL_AXES       (0x3F)   // Wake-up on both directions of X/Y/Z
 
 #define KX122_CNTL1_TPE           (1 << 0)
 #define KX122_CNTL1_WUFE          (1 << 1)
@@ -44,26 +65,85 @@
 #define KX122_CNTL1_RES           (1 << 6)
 #define KX122_CNTL1_PC1           (1 << 7)
 
+#define KX122_ODCNTL_OSA_12_5HZ   (0)
+#define KX122_ODCNTL_OSA_25HZ     (1)
 #define KX122_ODCNTL_OSA_50HZ     (2)
 #define KX122_ODCNTL_OSA_100HZ    (3)
+#define KX122_ODCNTL_OSA_200HZ    (4)
+#define KX122_ODCNTL_OSA_400HZ    (5)
+#define KX122_ODCNTL_OSA_800HZ    (6)
+#define KX122_ODCNTL_OSA_1600HZ   (7)
+#define KX122_ODCNTL_OSA_0_781HZ  (8)
+#define KX122_ODCNTL_OSA_1_563HZ  (9)
+#define KX122_ODCNTL_OSA_3_125HZ  (10)
+#define KX122_ODCNTL_OSA_6_25HZ   (11)
+#define KX122_ODCNTL_OSA_3200HZ   (12)
+#define KX122_ODCNTL_OSA_6400HZ   (13)
+#define KX122_ODCNTL_OSA_12800HZ  (14)
+#define KX122_ODCNTL_OSA_25600HZ  (15)
+#define KX122_ODCNTL_OSAMASK      (0x0F)
 #define KX122_ODCNTL_LPRO         (1 << 6)
 #define KX122_IIR_BYPASS          (1 << 7)
 
+#define KX122_INC1_IEL1           (1 << 3)
+#define KX122_INC1_IEA1           (1 << 4)
+#define KX122_INC1_IEN1           (1 << 5)
+
+#define KX122_INC4_WUFI1          (1 << 1)
+#define KX122_INC4_DRDYI1         (1 << 4)
+#define KX122_INC4_WMI1           (1 << 5)
+#define KX122_INC4_BFI1           (1 << 6)
+
+#define KX122_BUF_CNTL2_BUFE      (1 << 7)
+#define KX122_BUF_CNTL2_BRES      (1 << 6)
+#define KX122_BUF_CNTL2_BFIE      (1 << 5)
+#define KX122_BUF_CNTL2_BM_FIFO   (0)
+#define KX122_BUF_CNTL2_BM_STREAM (1)
+#define KX122_BUF_CNTL2_BM_TRIG   (2)
+#define KX122_BUF_STATUS_2_SMPMASK (0x07)
+
+#define KX122_BUF_SAMPLE_SIZE     (6)       // XYZ, 16bit resolution
+#define KX122_BUF_SAMPLE_MAX      (341)     // 2048 byte buffer / 6
+
 #define KX122_CNTL1_VAL           (KX122_CNTL1_RES | KX122_CNTL1_GSEL_4G)
 #define KX122_ODCNTL_VAL          (KX122_ODCNTL_OSA_50HZ)
+#define KX122_INC1_VAL            (KX122_INC1_IEN1 | KX122_INC1_IEA1 | KX122_INC1_IEL1)
+#define KX122_BUF_CNTL2_VAL       (KX122_BUF_CNTL2_BUFE | KX122_BUF_CNTL2_BRES | KX122_BUF_CNTL2_BM_STREAM)
+
+// Output data rate and acceleration range
+typedef struct
+{
+  unsigned char odr;        // KX122_ODCNTL_OSA_xxx
+  unsigned char range;      // KX122_CNTL1_GSEL_xxx
+} KX122_CONFIG;
 
 class KX122
 {
   public:
       KX122(int slave_address);
     byte init(void);
+    byte init(const KX122_CONFIG *config);
+    unsigned long get_period_us(void);
+    static unsigned long period_us(unsigned char odr);
     byte get_rawval(unsigned char *data);
     byte get_val(float *data);
+    byte get_cnt(signed short *data);
+    unsigned short get_sens(void);
+    byte init_buf(unsigned char threshold);
+    byte clear_buf(void);
+    byte init_drdy(void);
+    byte init_wuf(unsigned char threshold, unsigned char count);
+    byte get_wuf(bool *motion);
+    byte get_buf_num(unsigned short *num);
+    byte get_buf_rawval(unsigned char *data, unsigned short num);
+    byte get_buf_cnt(signed short *data, unsigned short max_num, unsigned short *num);
+    byte get_buf_val(float *data, unsigned short max_num, unsigned short *num);
     byte write(unsigned char memory_address, unsigned char *data, unsigned char size);
     byte read(unsigned char memory_address, unsigned char *data, int size);
   private:
     int _device_address;
     unsigned short _g_sens;
+    unsigned char _odr;
 };
 
 #endif // _KX122_H_
@@ -23,6 +23,12 @@
  * @brief Handling I/O operation on the SD card
  */
 
+#ifndef SUBCORE
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sched.h>
+#include <errno.h>
 #include "SDHC_file.h"
 
 SDClass theSD;  /**< SDClass object */
@@ -36,46 +42,651 @@ boolean BeginSDCard(void)
   return true;
 }
 
-volatile void OpenSD(const char* pName, int flag)
+static SdStream SensorStream;  /**< Sensor file stream */
+static SdStream NmeaStream;    /**< NMEA file stream */
+static SdStream SummaryStream; /**< Activity summary file stream */
+static SdStream BurstStream;   /**< Burst file stream */
+
+/**
+ * @brief Set the size of a file, allocating or releasing clusters.
+ * 
+ * @param [in] pPath Full path
+ * @param [in] size New file size
+ * @return true if success, false if failure
+ */
+static boolean SdTruncate(const char* pPath, unsigned long size)
 {
-  if (theSD.exists("/") == false)
+  int fd;
+  boolean result;
+
+  fd = open(pPath, O_WRONLY | O_CREAT, 0666);
+  if (fd < 0)
   {
-    return 0;
+    return false;
+  }
+  result = (ftruncate(fd, size) == 0);
+  close(fd);
+
+  return result;
+}
+
+/**
+ * @brief Preallocate and open the file of the stream. Called by the writer.
+ * 
+ * @param [in,out] pStream Stream with path, flag and request set
+ * @return true if success, false if failure
+ */
+static boolean SdStreamAttach(SdStream* pStream)
+{
+  struct stat st;
+  int flag = pStream->flag;
+
+  pStream->end = 0;
+  pStream->reserve = 0;
+
+  if (pStream->request != 0)
+  {
+    /* Allocate the extent before the file is opened for writing. */
+    if (stat(pStream->path, &st) == 0)
+    {
+      pStream->end = st.st_size;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    if ((pStream->end + pStream->request > pStream->end) &&
+        (SdTruncate(pStream->path, pStream->end + pStream->request) == true))
+    {
+      pStream->reserve = pStream->end + pStream->request;
+      /* Write inside the extent instead of after it. */
+      flag &= ~O_APPEND;
+    }
+    else
+    {
+      /* Card full, grow on demand. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
   }
 
   /* Open file. */
-  myFile = theSD.open(pName, flag);
+  pStream->file = theSD.open(&pStream->path[sizeof(SD_MOUNT_DIR) - 1], flag);
+  if (pStream->file == NULL)
+  {
+    pStream->file = File();
+    return false;
+  }
+
+  if (pStream->reserve != 0)
+  {
+    pStream->file.seek(pStream->end);
+  }
+  else
+  {
+    pStream->end = pStream->file.size();
+  }
+
+  return true;
 }
 
-volatile int WriteSD(const char* pBuff, unsigned long write_size)
+/**
+ * @brief Close the file of the stream and trim it. Called by the writer.
+ * 
+ * @param [in,out] pStream Stream
+ */
+static void SdStreamDetach(SdStream* pStream)
 {
-  unsigned long write_result = 0;
+  if (pStream->opened == true)
+  {
+    pStream->file.close();
+    pStream->file = File();
+    pStream->opened = false;
 
-  if (myFile == NULL)
+    if (pStream->reserve > pStream->end)
+    {
+      /* Release the unused part of the extent. */
+      SdTruncate(pStream->path, pStream->end);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    pStream->reserve = 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Close the old file, rewrite the note and open the next file. Called by the writer.
+ * 
+ * @param [in,out] pStream Stream with next, next_flag, next_request and note_name set
+ */
+static void SdStreamSwitch(SdStream* pStream)
+{
+  File note;
+
+  SdStreamDetach(pStream);
+
+  if (pStream->note_name[0] != '\0')
+  {
+    /* Remove first, FILE_WRITE appends. */
+    theSD.remove(pStream->note_name);
+    note = theSD.open(pStream->note_name, FILE_WRITE);
+    if (note == NULL)
+    {
+      pStream->stat.errors += 1;
+    }
+    else
+    {
+      if (note.write(pStream->note, strlen(pStream->note)) != strlen(pStream->note))
+      {
+        pStream->stat.errors += 1;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      note.close();
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (pStream->next[0] != '\0')
+  {
+    memcpy(pStream->path, pStream->next, sizeof(pStream->path));
+    pStream->flag = pStream->next_flag;
+    pStream->request = pStream->next_request;
+    pStream->opened = SdStreamAttach(pStream);
+    if (pStream->opened == false)
+    {
+      /* Buffers of this file are counted as errors. */
+      pStream->stat.errors += 1;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Open the file, then write queued buffers until the stream is closed.
+ * 
+ * @param [in] arg Stream
+ * @return NULL
+ */
+static void* SdStreamWriter(void* arg)
+{
+  SdStream* pStream = (SdStream*)arg;
+  unsigned long write_result;
+  unsigned long start;
+  unsigned long elapsed;
+  int index;
+  boolean stop;
+
+  /* Preallocation may take long on a large card, the caller only waits for the result. */
+  pStream->opened = SdStreamAttach(pStream);
+  __sync_synchronize();
+  sem_post(&pStream->attached);
+  if (pStream->opened == false)
+  {
+    return NULL;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  do
+  {
+    while ((sem_wait(&pStream->ready) != 0) && (errno == EINTR))
+    {
+      /* Interrupted, wait again. */
+    }
+
+    /* Buffers queued before stop was set are written first. */
+    stop = pStream->stop;
+    __sync_synchronize();
+
+    while (1)
+    {
+      if ((pStream->switching == true) && (pStream->tail == pStream->switch_at))
+      {
+        /* Every buffer of the old file is written. */
+        __sync_synchronize();
+        SdStreamSwitch(pStream);
+        __sync_synchronize();
+        pStream->switching = false;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      if (pStream->tail == pStream->head)
+      {
+        break;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+
+      index = pStream->tail % SD_WRITE_BUFFER_NUM;
+      start = micros();
+      write_result = (pStream->opened == true) ? pStream->file.write(pStream->buff[index], pStream->used[index]) : 0;
+      elapsed = micros() - start;
+
+      pStream->stat.writes += 1;
+      pStream->end += write_result;
+      if (write_result != pStream->used[index])
+      {
+        pStream->stat.errors += 1;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      if (elapsed > pStream->stat.stall_max_us)
+      {
+        pStream->stat.stall_max_us = elapsed;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+
+      /* Release the buffer after it has been written. */
+      __sync_synchronize();
+      pStream->tail += 1;
+    }
+  } while (stop == false);
+
+  SdStreamDetach(pStream);
+
+  return NULL;
+}
+
+boolean SdStreamOpen(SdStream* pStream, const char* pName, int flag, unsigned long reserve)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+
+  pStream->length = 0;
+  pStream->size = 0;
+  pStream->end = 0;
+  pStream->reserve = 0;
+  pStream->request = reserve;
+  pStream->flag = flag;
+  pStream->head = 0;
+  pStream->tail = 0;
+  pStream->stop = false;
+  pStream->opened = false;
+  pStream->switching = false;
+  pStream->switch_at = 0;
+  pStream->running = false;
+  memset(&pStream->stat, 0, sizeof(pStream->stat));
+  snprintf(pStream->path, sizeof(pStream->path), SD_MOUNT_DIR "%s", pName);
+
+  if (theSD.exists("/") == false)
+  {
+    return false;
+  }
+
+  /* Start the writer, it opens the file. */
+  sem_init(&pStream->ready, 0, 0);
+  sem_init(&pStream->attached, 0, 0);
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, SD_WRITER_STACK);
+  sched_getparam(0, &param);
+  param.sched_priority += SD_WRITER_PRIORITY;
+  pthread_attr_setschedparam(&attr, &param);
+  if (pthread_create(&pStream->thread, &attr, SdStreamWriter, pStream) == 0)
+  {
+    while ((sem_wait(&pStream->attached) != 0) && (errno == EINTR))
+    {
+      /* Interrupted, wait again. */
+    }
+    __sync_synchronize();
+    if (pStream->opened == true)
+    {
+      pStream->running = true;
+    }
+    else
+    {
+      pthread_join(pStream->thread, NULL);
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  pthread_attr_destroy(&attr);
+
+  if (pStream->running == false)
+  {
+    sem_destroy(&pStream->ready);
+    sem_destroy(&pStream->attached);
+    return false;
+  }
+
+  /* Fill the first buffer only up to the next sector boundary of the file. */
+  pStream->size = pStream->end;
+  pStream->limit = SD_WRITE_BUFFER_SIZE - (pStream->size % SD_SECTOR_SIZE);
+
+  return true;
+}
+
+/**
+ * @brief Queue the filled buffer to the writer and move to the next one.
+ * 
+ * @param [in,out] pStream Opened stream
+ */
+static void SdStreamSubmit(SdStream* pStream)
+{
+  unsigned long pending;
+
+  if (pStream->length != 0)
+  {
+    pStream->used[pStream->head % SD_WRITE_BUFFER_NUM] = pStream->length;
+    pStream->size += pStream->length;
+    pStream->length = 0;
+    pStream->limit = SD_WRITE_BUFFER_SIZE - (pStream->size % SD_SECTOR_SIZE);
+
+    /* Publish the buffer contents before the index. */
+    __sync_synchronize();
+    pStream->head += 1;
+    sem_post(&pStream->ready);
+
+    pending = pStream->head - pStream->tail;
+    if (pending > pStream->stat.pending_max)
+    {
+      pStream->stat.pending_max = pending;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+unsigned long SdStreamWrite(SdStream* pStream, const char* pBuff, unsigned long write_size)
+{
+  unsigned long done = 0;
+  unsigned long copy;
+  unsigned long pending;
+  unsigned long room = 0;
+
+  if (pStream->running == false)
   {
     /* if the file didn't open, print an error. */
+    return 0;
+  }
+
+  /* Room in the buffer being filled and in the free ones. */
+  pending = pStream->head - pStream->tail;
+  if (pending < SD_WRITE_BUFFER_NUM)
+  {
+    room = (pStream->limit - pStream->length) + (SD_WRITE_BUFFER_NUM - 1 - pending) * SD_WRITE_BUFFER_SIZE;
   }
   else
   {
-    /* Write file. */
-    write_result = myFile.write(pBuff, write_size);
+    /* do nothing. */
   }
-  return write_result;
+  if (write_size > room)
+  {
+    /* The card is behind, drop whole writes to keep records intact. */
+    pStream->stat.dropped += 1;
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  while (done < write_size)
+  {
+    copy = pStream->limit - pStream->length;
+    if (copy > write_size - done)
+    {
+      copy = write_size - done;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    memcpy(&pStream->buff[pStream->head % SD_WRITE_BUFFER_NUM][pStream->length], &pBuff[done], copy);
+    pStream->length += copy;
+    done += copy;
+
+    if (pStream->length >= pStream->limit)
+    {
+      SdStreamSubmit(pStream);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  return done;
 }
 
-volatile void CloseSD(void)
+boolean SdStreamFlush(SdStream* pStream)
 {
-  if (myFile == NULL)
+  if (pStream->running == false)
+  {
+    return false;
+  }
+
+  /* An empty slot always exists here, a full one would have been dropped. */
+  SdStreamSubmit(pStream);
+
+  return true;
+}
+
+boolean SdStreamRotate(SdStream* pStream, const char* pName, int flag, unsigned long reserve,
+                       const char* pNoteName, const char* pNote)
+{
+  if (pStream->running == false)
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  while (pStream->switching == true)
+  {
+    /* Only when files are switched faster than the card is written. */
+    usleep(1000);
+  }
+  __sync_synchronize();
+
+  /* The old file ends with the buffer being filled. */
+  SdStreamSubmit(pStream);
+
+  if (pName != NULL)
+  {
+    snprintf(pStream->next, sizeof(pStream->next), SD_MOUNT_DIR "%s", pName);
+  }
+  else
+  {
+    pStream->next[0] = '\0';
+  }
+  pStream->next_flag = flag;
+  pStream->next_request = reserve;
+  if ((pNoteName != NULL) && (pNote != NULL))
+  {
+    snprintf(pStream->note_name, sizeof(pStream->note_name), "%s", pNoteName);
+    snprintf(pStream->note, sizeof(pStream->note), "%s", pNote);
+  }
+  else
+  {
+    pStream->note_name[0] = '\0';
+  }
+  pStream->switch_at = pStream->head;
+
+  /* Publish the request before the flag. */
+  __sync_synchronize();
+  pStream->switching = true;
+  sem_post(&pStream->ready);
+
+  /* The next file starts empty, on a sector boundary. */
+  pStream->size = 0;
+  pStream->limit = SD_WRITE_BUFFER_SIZE;
+
+  return true;
+}
+
+void SdStreamClose(SdStream* pStream)
+{
+  if (pStream->running == false)
   {
     /* if the file didn't open, print an error. */
   }
   else
   {
-    /* Close file. */
-    myFile.close();
+    SdStreamSubmit(pStream);
+
+    /* Let the writer empty the queue and exit. */
+    __sync_synchronize();
+    pStream->stop = true;
+    sem_post(&pStream->ready);
+    pthread_join(pStream->thread, NULL);
+    sem_destroy(&pStream->ready);
+    sem_destroy(&pStream->attached);
+    pStream->running = false;
   }
 }
 
+boolean OpenSD(const char* pName, int flag, unsigned long reserve)
+{
+  return SdStreamOpen(&SensorStream, pName, flag, reserve);
+}
+
+boolean RotateSD(const char* pName, int flag, unsigned long reserve, const char* pIndexName, const char* pIndex)
+{
+  return SdStreamRotate(&SensorStream, pName, flag, reserve, pIndexName, pIndex);
+}
+
+volatile int WriteSD(const char* pBuff, unsigned long write_size)
+{
+  return SdStreamWrite(&SensorStream, pBuff, write_size);
+}
+
+volatile void CloseSD(void)
+{
+  SdStreamClose(&SensorStream);
+}
+
+void GetSDStat(SdStreamStat* pStat)
+{
+  *pStat = SensorStream.stat;
+}
+
+int PendingSD(void)
+{
+  return (int)(SensorStream.head - SensorStream.tail);
+}
+
+boolean OpenNmea(const char* pName, int flag)
+{
+  return SdStreamOpen(&NmeaStream, pName, flag, 0);
+}
+
+boolean RotateNmea(const char* pName, int flag)
+{
+  return SdStreamRotate(&NmeaStream, pName, flag, 0, NULL, NULL);
+}
+
+int WriteNmea(const char* pBuff, unsigned long write_size)
+{
+  return SdStreamWrite(&NmeaStream, pBuff, write_size);
+}
+
+void FlushNmea(void)
+{
+  SdStreamFlush(&NmeaStream);
+}
+
+void CloseNmea(void)
+{
+  SdStreamClose(&NmeaStream);
+}
+
+void GetNmeaStat(SdStreamStat* pStat)
+{
+  *pStat = NmeaStream.stat;
+}
+
+boolean OpenSummary(const char* pName, int flag)
+{
+  return SdStreamOpen(&SummaryStream, pName, flag, 0);
+}
+
+boolean RotateSummary(const char* pName, int flag)
+{
+  return SdStreamRotate(&SummaryStream, pName, flag, 0, NULL, NULL);
+}
+
+int WriteSummary(const char* pBuff, unsigned long write_size)
+{
+  return SdStreamWrite(&SummaryStream, pBuff, write_size);
+}
+
+void CloseSummary(void)
+{
+  SdStreamClose(&SummaryStream);
+}
+
+void GetSummaryStat(SdStreamStat* pStat)
+{
+  *pStat = SummaryStream.stat;
+}
+
+boolean OpenBurst(const char* pName, int flag)
+{
+  return SdStreamOpen(&BurstStream, pName, flag, 0);
+}
+
+boolean RotateBurst(const char* pName, int flag)
+{
+  return SdStreamRotate(&BurstStream, pName, flag, 0, NULL, NULL);
+}
+
+int WriteBurst(const char* pBuff, unsigned long write_size)
+{
+  return SdStreamWrite(&BurstStream, pBuff, write_size);
+}
+
+void CloseBurst(void)
+{
+  SdStreamClose(&BurstStream);
+}
+
+void GetBurstStat(SdStreamStat* pStat)
+{
+  *pStat = BurstStream.stat;
+}
+
 volatile int WriteBinary(const char* pBuff, const char* pName, unsigned long write_size, int flag)
 {
   unsigned long write_result = 0;
@@ -163,3 +774,5 @@ boolean IsFileExist(const char* pName)
 {
   return theSD.exists(pName);
 }
+
+#endif /* SUBCORE */
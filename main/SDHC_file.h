@@ -28,6 +28,74 @@
 
 #include "main.h"
 
+#include <pthread.h>
+#include <semaphore.h>
+
+#define SD_SECTOR_SIZE         512            /**< [byte] SD card sector. */
+#define SD_WRITE_BUFFER_SIZE   4096           /**< [byte] One write buffer, multiple of SD_SECTOR_SIZE. */
+#define SD_WRITE_BUFFER_NUM    4              /**< Buffers between the sampling loop and the writer. */
+#define SD_WRITER_STACK        4096           /**< [byte] Writer thread stack. */
+#define SD_WRITER_PRIORITY     10             /**< Writer priority above the loop, it mostly waits for the card. */
+#ifndef SD_MOUNT_DIR
+#define SD_MOUNT_DIR           "/mnt/sd0/"    /**< Mount point of the SD card, a host directory in tests. */
+#endif
+#define SD_PATH_LEN            64             /**< Path length including SD_MOUNT_DIR */
+#define SD_RESERVE_MAX         0x7FFFFFFFUL   /**< [byte] Largest preallocated file. */
+#define SD_NOTE_SIZE           16             /**< [byte] Small file rewritten by the writer between two files. */
+
+/**
+ * @brief Counters of a buffered file.
+ */
+typedef struct {
+  unsigned long writes;               /**< Number of File::write calls */
+  unsigned long errors;               /**< Number of failed writes */
+  unsigned long dropped;              /**< Writes dropped because every buffer was queued */
+  unsigned long pending_max;          /**< Most buffers waiting for the writer at once */
+  unsigned long stall_max_us;         /**< [us] Longest File::write */
+} SdStreamStat;
+
+/**
+ * @brief Buffered writer for one file on the SD card.
+ * 
+ * Data is collected in sector aligned buffers used in turn. A full buffer
+ * is queued to a writer thread that owns the file and writes it with a
+ * single File::write, so the caller never waits for the card and the
+ * card only sees whole sector writes. When every buffer is queued the
+ * data is dropped and counted instead of blocking the caller.
+ * The writer also opens, preallocates, closes and trims the file, and
+ * switches to the next file when it reaches the point queued by
+ * SdStreamRotate, so files are changed without stopping the caller.
+ */
+typedef struct {
+  File          file;                 /**< Opened file, used by the writer thread */
+  unsigned long length;               /**< Bytes in the buffer being filled */
+  unsigned long limit;                /**< Bytes to fill until the next sector boundary */
+  unsigned long size;                 /**< File size including queued buffers */
+  unsigned long end;                  /**< File size written, used by the writer */
+  unsigned long reserve;              /**< Preallocated file size, 0 if none */
+  unsigned long request;              /**< Bytes to preallocate when the writer opens the file */
+  int           flag;                 /**< File access mode when the writer opens the file */
+  char          path[SD_PATH_LEN];    /**< Full path, used to preallocate and trim the file */
+  volatile unsigned long head;        /**< Buffers queued, written by the caller */
+  volatile unsigned long tail;        /**< Buffers written, written by the writer */
+  volatile boolean stop;              /**< Writer exits once the queue is empty */
+  volatile boolean opened;            /**< Writer opened the file */
+  char          next[SD_PATH_LEN];    /**< Full path of the next file, empty to close only */
+  int           next_flag;            /**< File access mode of the next file */
+  unsigned long next_request;         /**< Bytes to preallocate for the next file */
+  char          note_name[SD_PATH_LEN]; /**< Small file rewritten between the files, empty for none */
+  char          note[SD_NOTE_SIZE];   /**< Contents of note_name */
+  volatile unsigned long switch_at;   /**< Buffers of the old file, written by the caller */
+  volatile boolean switching;         /**< Switch queued, set by the caller and cleared by the writer */
+  boolean       running;              /**< Writer thread started */
+  pthread_t     thread;               /**< Writer thread */
+  sem_t         ready;                /**< Posted for each queued buffer */
+  sem_t         attached;             /**< Posted once the writer tried to open the file */
+  SdStreamStat  stat;                 /**< Counters */
+  unsigned long used[SD_WRITE_BUFFER_NUM]; /**< Bytes in each queued buffer */
+  char          buff[SD_WRITE_BUFFER_NUM][SD_WRITE_BUFFER_SIZE] __attribute__((aligned(SD_SECTOR_SIZE)));
+} SdStream;
+
 /**
  * @brief Mount SD card.
  * 
@@ -35,10 +103,243 @@
  */
 boolean BeginSDCard(void);
 
-volatile void OpenSD(const char* pName, int flag);
+/**
+ * @brief Open a buffered file on the SD card and start its writer.
+ * 
+ * The writer thread allocates clusters for reserve bytes before it opens
+ * the file, so the file does not grow while it is written. The unused
+ * part is trimmed on close. Waits until the file is open, call it before
+ * sampling starts.
+ * 
+ * @param [out] pStream Stream to initialize
+ * @param [in] pName File name
+ * @param [in] flag File access mode
+ * @param [in] reserve Bytes to preallocate, 0 to grow the file on demand
+ * @return true if success, false if failure
+ */
+boolean SdStreamOpen(SdStream* pStream, const char* pName, int flag, unsigned long reserve);
+
+/**
+ * @brief Append data to a buffered file.
+ * 
+ * @param [in,out] pStream Opened stream
+ * @param [in] pBuff Data to be written
+ * @param [in] write_size Bytes to be written
+ * @return write_size, 0 if the data was dropped
+ */
+unsigned long SdStreamWrite(SdStream* pStream, const char* pBuff, unsigned long write_size);
+
+/**
+ * @brief Queue the partially filled buffer to the writer.
+ * 
+ * @param [in,out] pStream Opened stream
+ * @return true if success, false if failure
+ */
+boolean SdStreamFlush(SdStream* pStream);
+
+/**
+ * @brief Switch a buffered file to the next file in the writer thread.
+ * 
+ * Data written before the call goes to the old file, data written after
+ * it to the next one. The writer closes and trims the old file, rewrites
+ * pNoteName, then preallocates and opens the next file when it reaches
+ * that point, so the caller does not wait for the card. The next file is
+ * expected to be new, its first buffer is filled up to a full buffer.
+ * Waits only if the previous switch is still queued.
+ * 
+ * @param [in,out] pStream Opened stream
+ * @param [in] pName Next file name, NULL to close the file only
+ * @param [in] flag File access mode
+ * @param [in] reserve Bytes to preallocate, 0 to grow the file on demand
+ * @param [in] pNoteName File rewritten between the files, NULL for none
+ * @param [in] pNote Contents of pNoteName, shorter than SD_NOTE_SIZE
+ * @return true if queued, false if the writer is not running
+ */
+boolean SdStreamRotate(SdStream* pStream, const char* pName, int flag, unsigned long reserve,
+                       const char* pNoteName, const char* pNote);
+
+/**
+ * @brief Flush and close a buffered file.
+ * 
+ * Waits until the writer has written every queued buffer.
+ * A preallocated file is trimmed to the bytes written.
+ * 
+ * @param [in,out] pStream Opened stream
+ */
+void SdStreamClose(SdStream* pStream);
+
+/**
+ * @brief Open the sensor file.
+ * 
+ * @param [in] pName File name
+ * @param [in] flag File access mode
+ * @param [in] reserve Bytes to preallocate, 0 to grow the file on demand
+ * @return true if success, false if failure
+ */
+boolean OpenSD(const char* pName, int flag, unsigned long reserve);
+
+/**
+ * @brief Switch the sensor file in its writer thread, see SdStreamRotate.
+ * 
+ * @param [in] pName Next file name
+ * @param [in] flag File access mode
+ * @param [in] reserve Bytes to preallocate, 0 to grow the file on demand
+ * @param [in] pIndexName Index file rewritten between the files
+ * @param [in] pIndex Contents of the index file
+ * @return true if queued, false if the sensor file is not open
+ */
+boolean RotateSD(const char* pName, int flag, unsigned long reserve, const char* pIndexName, const char* pIndex);
+
+/**
+ * @brief Append data to the sensor file through the stream buffers.
+ * 
+ * @param [in] pBuff %Buffer to be written
+ * @param [in] write_size Bytes to be written
+ * @return Bytes accepted, 0 if the data was dropped
+ */
 volatile int WriteSD(const char* pBuff, unsigned long write_size);
+
+/**
+ * @brief Flush and close the sensor file.
+ */
 volatile void CloseSD(void);
 
+/**
+ * @brief Get the counters of the sensor file.
+ * 
+ * @param [out] pStat Counters since the stream was opened, across rotations
+ */
+void GetSDStat(SdStreamStat* pStat);
+
+/**
+ * @brief Get the buffers of the sensor file waiting for the writer.
+ * 
+ * @return Number of buffers, at most SD_WRITE_BUFFER_NUM
+ */
+int PendingSD(void);
+
+/**
+ * @brief Open the NMEA file.
+ * 
+ * @param [in] pName File name
+ * @param [in] flag File access mode
+ * @return true if success, false if failure
+ */
+boolean OpenNmea(const char* pName, int flag);
+
+/**
+ * @brief Switch the NMEA file in its writer thread, see SdStreamRotate.
+ * 
+ * @param [in] pName Next file name, NULL to close the file only
+ * @param [in] flag File access mode
+ * @return true if queued, false if the NMEA writer is not running
+ */
+boolean RotateNmea(const char* pName, int flag);
+
+/**
+ * @brief Append sentences to the NMEA file through the stream buffers.
+ * 
+ * @param [in] pBuff %Buffer to be written
+ * @param [in] write_size Bytes to be written
+ * @return Bytes accepted, 0 if the data was dropped
+ */
+int WriteNmea(const char* pBuff, unsigned long write_size);
+
+/**
+ * @brief Queue the sentences collected so far to the writer.
+ */
+void FlushNmea(void);
+
+/**
+ * @brief Flush and close the NMEA file.
+ */
+void CloseNmea(void);
+
+/**
+ * @brief Get the counters of the NMEA file.
+ * 
+ * @param [out] pStat Counters since the stream was opened, across rotations
+ */
+void GetNmeaStat(SdStreamStat* pStat);
+
+/**
+ * @brief Open the activity summary file.
+ * 
+ * @param [in] pName File name
+ * @param [in] flag File access mode
+ * @return true if success, false if failure
+ */
+boolean OpenSummary(const char* pName, int flag);
+
+/**
+ * @brief Switch the activity summary file in its writer thread, see SdStreamRotate.
+ * 
+ * @param [in] pName Next file name
+ * @param [in] flag File access mode
+ * @return true if queued, false if the summary file is not open
+ */
+boolean RotateSummary(const char* pName, int flag);
+
+/**
+ * @brief Append records to the activity summary file through the stream buffers.
+ * 
+ * @param [in] pBuff %Buffer to be written
+ * @param [in] write_size Bytes to be written
+ * @return Bytes accepted, 0 if the data was dropped
+ */
+int WriteSummary(const char* pBuff, unsigned long write_size);
+
+/**
+ * @brief Flush and close the activity summary file.
+ */
+void CloseSummary(void);
+
+/**
+ * @brief Get the counters of the activity summary file.
+ * 
+ * @param [out] pStat Counters since the stream was opened, across rotations
+ */
+void GetSummaryStat(SdStreamStat* pStat);
+
+/**
+ * @brief Open the burst file.
+ * 
+ * @param [in] pName File name
+ * @param [in] flag File access mode
+ * @return true if success, false if failure
+ */
+boolean OpenBurst(const char* pName, int flag);
+
+/**
+ * @brief Switch the burst file in its writer thread, see SdStreamRotate.
+ * 
+ * @param [in] pName Next file name
+ * @param [in] flag File access mode
+ * @return true if queued, false if the burst file is not open
+ */
+boolean RotateBurst(const char* pName, int flag);
+
+/**
+ * @brief Append records to the burst file through the stream buffers.
+ * 
+ * @param [in] pBuff %Buffer to be written
+ * @param [in] write_size Bytes to be written
+ * @return Bytes accepted, 0 if the data was dropped
+ */
+int WriteBurst(const char* pBuff, unsigned long write_size);
+
+/**
+ * @brief Flush and close the burst file.
+ */
+void CloseBurst(void);
+
+/**
+ * @brief Get the counters of the burst file.
+ * 
+ * @param [out] pStat Counters since the stream was opened, across rotations
+ */
+void GetBurstStat(SdStreamStat* pStat);
+
 /**
  * @brief Write binary data to SD card.
  * 
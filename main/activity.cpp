@@ -0,0 +1,394 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file activity.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Activity features of the acceleration over fixed windows.
+ */
+
+#ifndef SUBCORE
+#include "activity.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define CORDIC_STEPS           14             /**< Iterations of the angle approximation */
+#define CORDIC_SCALE           8              /**< Input shift, keeps the rounding error below 0.01 deg */
+
+/**
+ * @brief Integer square root.
+ * 
+ * @param [in] value Radicand
+ * @return floor(sqrt(value))
+ */
+static uint32_t ActivitySqrt(uint64_t value)
+{
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return (uint32_t)root;
+}
+
+/**
+ * @brief Angle of a vector by CORDIC.
+ * 
+ * @param [in] y Y component
+ * @param [in] x X component
+ * @return atan2(y, x) [0.01 deg]
+ */
+static int32_t ActivityAtan2(int32_t y, int32_t x)
+{
+  /* atan(2^-i) [0.01 deg] */
+  static const int16_t Angle[CORDIC_STEPS] =
+  {
+    4500, 2657, 1404, 713, 358, 179, 90, 45, 22, 11, 6, 3, 1, 1,
+  };
+  int32_t angle = 0;
+  int32_t next;
+  int cnt;
+
+  if ((x == 0) && (y == 0))
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  x <<= CORDIC_SCALE;
+  y <<= CORDIC_SCALE;
+
+  /* Turn into the right half plane. */
+  if (x < 0)
+  {
+    next = x;
+    if (y >= 0)
+    {
+      x = y;
+      y = -next;
+      angle = 9000;
+    }
+    else
+    {
+      x = -y;
+      y = next;
+      angle = -9000;
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Rotate the vector onto the x axis. */
+  for (cnt = 0; cnt < CORDIC_STEPS; cnt++)
+  {
+    next = x;
+    if (y > 0)
+    {
+      x += y >> cnt;
+      y -= next >> cnt;
+      angle += Angle[cnt];
+    }
+    else
+    {
+      x -= y >> cnt;
+      y += next >> cnt;
+      angle -= Angle[cnt];
+    }
+  }
+
+  return angle;
+}
+
+/**
+ * @brief Convert counts to mG, rounded.
+ * 
+ * @param [in] value Value [counts * num]
+ * @param [in] num Divisor of value
+ * @param [in] sens Counts per G
+ * @return value / num [mG]
+ */
+static int32_t ActivityMilliG(int64_t value, uint32_t num, uint16_t sens)
+{
+  int64_t div = (int64_t)num * sens;
+
+  if (div == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  value *= 1000;
+  return (int32_t)((value >= 0) ? ((value + div / 2) / div) : -((-value + div / 2) / div));
+}
+
+void ActivityBegin(ActivityWindow *pWin, uint32_t window)
+{
+  pWin->window = (window > ACTIVITY_WINDOW_MAX) ? ACTIVITY_WINDOW_MAX : window;
+  pWin->primed = 0;
+  pWin->num = 0;
+}
+
+bool ActivityPut(ActivityWindow *pWin, const SensorRecord *pRecord, ActivityRecord *pOut)
+{
+  int32_t acc;
+  int32_t dyn;
+  uint64_t sq = 0;
+  uint32_t odba = 0;
+  int cnt;
+
+  if (pWin->window == 0)
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (pWin->primed == 0)
+  {
+    /* Start the running mean at the first sample. */
+    for (cnt = 0; cnt < 3; cnt++)
+    {
+      pWin->gravity[cnt] = (int32_t)pRecord->acc[cnt] << ACTIVITY_HP_SHIFT;
+    }
+    pWin->primed = 1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (pWin->num == 0)
+  {
+    pWin->first = *pRecord;
+    pWin->sens = pRecord->sens;
+    pWin->odba = 0;
+    pWin->vedba = 0;
+    for (cnt = 0; cnt < 3; cnt++)
+    {
+      pWin->sum[cnt] = 0;
+      pWin->sumsq[cnt] = 0;
+      pWin->min[cnt] = pRecord->acc[cnt];
+      pWin->max[cnt] = pRecord->acc[cnt];
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    acc = pRecord->acc[cnt];
+
+    /* High pass: the sample minus the gravity estimate. */
+    pWin->gravity[cnt] += acc - (pWin->gravity[cnt] >> ACTIVITY_HP_SHIFT);
+    dyn = acc - ((pWin->gravity[cnt] + (1 << (ACTIVITY_HP_SHIFT - 1))) >> ACTIVITY_HP_SHIFT);
+    odba += (dyn < 0) ? -dyn : dyn;
+    sq += (uint64_t)((int64_t)dyn * dyn);
+
+    pWin->sum[cnt] += acc;
+    pWin->sumsq[cnt] += (uint64_t)(acc * acc);
+    if (acc < pWin->min[cnt])
+    {
+      pWin->min[cnt] = acc;
+    }
+    else if (acc > pWin->max[cnt])
+    {
+      pWin->max[cnt] = acc;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  pWin->odba += odba;
+  pWin->vedba += ActivitySqrt(sq);
+  pWin->num++;
+
+  if (pWin->num >= pWin->window)
+  {
+    return ActivityFlush(pWin, pOut);
+  }
+  else
+  {
+    return false;
+  }
+}
+
+bool ActivityFlush(ActivityWindow *pWin, ActivityRecord *pOut)
+{
+  uint32_t num = pWin->num;
+  uint16_t sens = pWin->sens;
+  int64_t square;
+  int32_t horizontal;
+  int32_t angle;
+  int cnt;
+
+  if (num == 0)
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pOut->sec = pWin->first.sec;
+  pOut->msec = pWin->first.msec;
+  pOut->device = pWin->first.device;
+  pOut->seq = pWin->first.seq;
+  pOut->num = num;
+  pOut->odba = ActivityMilliG(pWin->odba, num, sens);
+  pOut->vedba = ActivityMilliG(pWin->vedba, num, sens);
+
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    pOut->mean[cnt] = ActivityMilliG(pWin->sum[cnt], num, sens);
+    pOut->min[cnt] = ActivityMilliG(pWin->min[cnt], 1, sens);
+    pOut->max[cnt] = ActivityMilliG(pWin->max[cnt], 1, sens);
+
+    /* n^2 var = n sum(x^2) - sum(x)^2 [counts^2], in 64 bits up to ACTIVITY_WINDOW_MAX. */
+    square = (int64_t)(pWin->sumsq[cnt] * num) - pWin->sum[cnt] * pWin->sum[cnt];
+    if ((square > 0) && (sens != 0))
+    {
+      /* Scale to mG^2 between the divisions by n to keep the resolution. */
+      square = square / num * 1000 / sens * 1000 / sens / num;
+      pOut->var[cnt] = (uint32_t)square;
+    }
+    else
+    {
+      pOut->var[cnt] = 0;
+    }
+  }
+
+  /* Orientation of the mean acceleration, X forward, Z up at rest. */
+  horizontal = (int32_t)ActivitySqrt((uint64_t)((int64_t)pOut->mean[1] * pOut->mean[1] +
+                                                (int64_t)pOut->mean[2] * pOut->mean[2]));
+  angle = ActivityAtan2(-pOut->mean[0], horizontal);
+  pOut->pitch = (int16_t)((angle + ((angle < 0) ? -5 : 5)) / 10);
+  angle = ActivityAtan2(pOut->mean[1], pOut->mean[2]);
+  pOut->roll = (int16_t)((angle + ((angle < 0) ? -5 : 5)) / 10);
+
+  pWin->num = 0;
+
+  return true;
+}
+
+int FormatActivityRecord(char *pBuff, int size, const ActivityRecord *pRecord)
+{
+  static const char Sign[] = ACTIVITY_RECORD_SIGN ",0x";
+  static const char Hex[] = "0123456789ABCDEF";
+  char *p = pBuff;
+  int cnt;
+
+  if (size < ACTIVITY_RECORD_MAX)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  for (cnt = 0; Sign[cnt] != '\0'; cnt++)
+  {
+    *p++ = Sign[cnt];
+  }
+  for (cnt = 12; cnt >= 0; cnt -= 4)
+  {
+    *p++ = Hex[(pRecord->device >> cnt) & 0x0F];
+  }
+  *p++ = ',';
+
+  p = FormatSensorTime(p, pRecord->sec, pRecord->msec);
+  *p++ = ',';
+  p = FormatUint(p, pRecord->seq, 1);
+  *p++ = ',';
+  p = FormatUint(p, pRecord->num, 1);
+  *p++ = ',';
+  p = FormatUint(p, pRecord->odba, 1);
+  *p++ = ',';
+  p = FormatUint(p, pRecord->vedba, 1);
+  *p++ = ',';
+
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    p = FormatFixed(p, pRecord->mean[cnt], 0);
+    *p++ = ',';
+  }
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    p = FormatUint(p, pRecord->var[cnt], 1);
+    *p++ = ',';
+  }
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    p = FormatFixed(p, pRecord->min[cnt], 0);
+    *p++ = ',';
+  }
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    p = FormatFixed(p, pRecord->max[cnt], 0);
+    *p++ = ',';
+  }
+
+  p = FormatFixed(p, pRecord->pitch, 1);
+  *p++ = ',';
+  p = FormatFixed(p, pRecord->roll, 1);
+
+  *p++ = '\n';
+  *p = '\0';
+
+  return (int)(p - pBuff);
+}
+
+#endif /* SUBCORE */
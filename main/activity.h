@@ -0,0 +1,131 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef _ACTIVITY_H_
+#define _ACTIVITY_H_
+
+/**
+ * @file activity.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Activity features of the acceleration over fixed windows.
+ * @details Gravity is removed from each sample by a running mean of
+ *          2^ACTIVITY_HP_SHIFT samples. The rest is the dynamic body
+ *          acceleration, summed per window as ODBA (|x|+|y|+|z|) and
+ *          VeDBA (sqrt(x^2+y^2+z^2)). Mean, variance, minimum and maximum
+ *          are kept per axis of the raw acceleration, pitch and roll are
+ *          taken from the mean. Integer arithmetic only.
+ *          $A00300,0xDDDD,YYYY/MM/DD hh:mm:ss.sss,seq,num,odba,vedba,
+ *          mean x/y/z,var x/y/z,min x/y/z,max x/y/z,pitch,roll\n
+ *          in mG, mG^2 and degrees.
+ */
+
+#include <stdint.h>
+#include "sensor_format.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define ACTIVITY_RECORD_SIGN   "$A00300"      /**< Record sign name */
+#define ACTIVITY_RECORD_MAX    256            /**< Longest possible record */
+#define ACTIVITY_HP_SHIFT      7              /**< Gravity running mean of 2^n samples, 2.6 s at 50 Hz */
+#define ACTIVITY_WINDOW_MAX    65535          /**< Most samples per window, keeps the sums in 64 bits */
+
+/**
+ * @struct ActivityRecord
+ * @brief Features of one window
+ */
+typedef struct
+{
+  uint32_t sec;           /**< Time of the first sample [s since 1970/01/01] */
+  uint16_t msec;          /**< Time of the first sample [ms] */
+  uint16_t device;        /**< Device number */
+  uint32_t seq;           /**< Sequence number of the first sample */
+  uint32_t num;           /**< Samples in the window */
+  uint32_t odba;          /**< Mean ODBA [mG] */
+  uint32_t vedba;         /**< Mean VeDBA [mG] */
+  int32_t  mean[3];       /**< Mean acceleration X/Y/Z [mG] */
+  uint32_t var[3];        /**< Variance X/Y/Z [mG^2] */
+  int32_t  min[3];        /**< Minimum X/Y/Z [mG] */
+  int32_t  max[3];        /**< Maximum X/Y/Z [mG] */
+  int16_t  pitch;         /**< Pitch [0.1 deg], nose up positive */
+  int16_t  roll;          /**< Roll [0.1 deg] */
+} ActivityRecord;
+
+/**
+ * @struct ActivityWindow
+ * @brief Window under construction
+ */
+typedef struct
+{
+  uint32_t window;        /**< Samples per window, 0 off */
+  int      primed;        /**< gravity holds a value */
+  int32_t  gravity[3];    /**< Running mean << ACTIVITY_HP_SHIFT [counts] */
+  uint32_t num;           /**< Samples in the window */
+  int64_t  sum[3];        /**< Sum of the acceleration [counts] */
+  uint64_t sumsq[3];      /**< Sum of the squared acceleration [counts^2] */
+  int16_t  min[3];        /**< Minimum [counts] */
+  int16_t  max[3];        /**< Maximum [counts] */
+  uint64_t odba;          /**< Sum of ODBA [counts] */
+  uint64_t vedba;         /**< Sum of VeDBA [counts] */
+  uint16_t sens;          /**< Counts per G of the window */
+  SensorRecord first;     /**< First sample of the window */
+} ActivityWindow;
+
+/**
+ * @brief Start with a new gravity estimate and an empty window.
+ * 
+ * @param [out] pWin Window
+ * @param [in] window Samples per window, 0 off, at most ACTIVITY_WINDOW_MAX
+ */
+void ActivityBegin(ActivityWindow *pWin, uint32_t window);
+
+/**
+ * @brief Add one sample.
+ * 
+ * @param [in,out] pWin Window
+ * @param [in] pRecord Sensor sample
+ * @param [out] pOut Features of the closed window
+ * @return true if a window was closed by this sample
+ */
+bool ActivityPut(ActivityWindow *pWin, const SensorRecord *pRecord, ActivityRecord *pOut);
+
+/**
+ * @brief Close the window under construction, e.g. before the file is closed.
+ * 
+ * @param [in,out] pWin Window
+ * @param [out] pOut Features of the closed window
+ * @return true if the window had samples
+ */
+bool ActivityFlush(ActivityWindow *pWin, ActivityRecord *pOut);
+
+/**
+ * @brief Write one CSV activity record.
+ * 
+ * @param [out] pBuff Output buffer
+ * @param [in] size Size of pBuff, at least ACTIVITY_RECORD_MAX
+ * @param [in] pRecord Activity record
+ * @return Bytes written, without terminating NUL
+ */
+int FormatActivityRecord(char *pBuff, int size, const ActivityRecord *pRecord);
+
+#endif /* _ACTIVITY_H_ */
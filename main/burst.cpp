@@ -0,0 +1,244 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file burst.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Full rate samples around activity events.
+ */
+
+#ifndef SUBCORE
+#include "burst.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define BURST_RING_MASK        (BURST_RING_SIZE - 1)
+
+/**
+ * @struct BurstEntry
+ * @brief One sample in the ring
+ */
+typedef struct
+{
+  uint64_t count_us;      /**< Timebase counter [us] */
+  int16_t  acc[3];        /**< Acceleration X/Y/Z [counts] */
+} BurstEntry;
+
+/**
+ * @brief private variables
+ */
+static BurstEntry Ring[BURST_RING_SIZE];      /**< Latest samples */
+static uint32_t Head = 0;                     /**< Samples put since BurstBegin() */
+static BurstSource Source = eBurstOff;        /**< Trigger source */
+static uint64_t Threshold2 = 0;               /**< Squared trigger threshold [counts^2] */
+static uint32_t PreNum = 0;                   /**< Samples before the trigger */
+static uint32_t PostNum = 0;                  /**< Samples from the trigger on */
+static int Primed = 0;                        /**< Gravity holds a value */
+static int32_t Gravity[3];                    /**< Running mean << BURST_HP_SHIFT [counts] */
+static bool Active = false;                   /**< A burst is captured or read out */
+static uint32_t Tag = 0;                      /**< Tag of the burst */
+static uint32_t TriggerIdx = 0;               /**< Ring index of the trigger */
+static uint32_t EndIdx = 0;                   /**< Ring index after the last sample of the burst */
+static uint32_t OutIdx = 0;                   /**< Ring index of the next sample to read out */
+static BurstStat Stat;                        /**< Counters */
+
+void BurstBegin(BurstSource trigger, uint32_t threshold, uint32_t pre, uint32_t post)
+{
+  Source = trigger;
+  Threshold2 = (uint64_t)threshold * threshold;
+  PreNum = (pre > BURST_RING_SIZE / 2) ? BURST_RING_SIZE / 2 : pre;
+  PostNum = (post == 0) ? 1 : post;
+  Head = 0;
+  Primed = 0;
+  Active = false;
+  OutIdx = 0;
+  Stat.triggers = 0;
+  Stat.extended = 0;
+  Stat.missed = 0;
+  Stat.written = 0;
+  Stat.dropped = 0;
+}
+
+void BurstTrigger(uint32_t tag)
+{
+  uint32_t first;
+
+  if ((Active == true) && ((int32_t)(Head - EndIdx) < 0))
+  {
+    /* Still capturing, keep the tag and move the end. */
+    EndIdx = Head + PostNum;
+    Stat.extended++;
+  }
+  else if (Active == true)
+  {
+    /* The last burst is complete but not read out yet. */
+    Stat.missed++;
+  }
+  else
+  {
+    /* Samples already read out are not written again. */
+    first = ((Head - OutIdx) > PreNum) ? (Head - PreNum) : OutIdx;
+    Active = true;
+    Tag = tag;
+    TriggerIdx = Head;
+    EndIdx = Head + PostNum;
+    OutIdx = first;
+    Stat.triggers++;
+  }
+}
+
+void BurstPut(const int16_t *acc, uint64_t count_us, uint32_t tag)
+{
+  BurstEntry *pEntry;
+  int32_t dyn[3];
+  uint64_t dyn2 = 0;
+  int axis;
+
+  if (Source == eBurstDba)
+  {
+    /* Gravity removed by a running mean, the same as the activity features. */
+    for (axis = 0; axis < 3; axis++)
+    {
+      if (Primed == 0)
+      {
+        Gravity[axis] = (int32_t)acc[axis] << BURST_HP_SHIFT;
+      }
+      else
+      {
+        Gravity[axis] += acc[axis] - (Gravity[axis] >> BURST_HP_SHIFT);
+      }
+      dyn[axis] = acc[axis] - (Gravity[axis] >> BURST_HP_SHIFT);
+      dyn2 += (uint64_t)((int64_t)dyn[axis] * dyn[axis]);
+    }
+    Primed = 1;
+
+    if (dyn2 > Threshold2)
+    {
+      /* The sample that crossed the threshold is index 0. */
+      BurstTrigger(tag);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pEntry = &Ring[Head & BURST_RING_MASK];
+  pEntry->count_us = count_us;
+  pEntry->acc[0] = acc[0];
+  pEntry->acc[1] = acc[1];
+  pEntry->acc[2] = acc[2];
+  Head++;
+}
+
+bool BurstGet(BurstSample *pSample)
+{
+  const BurstEntry *pEntry;
+  uint32_t first;
+  uint32_t last;
+
+  if (Active == false)
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if ((Head - OutIdx) > BURST_RING_SIZE)
+  {
+    /* Read out too late, the oldest samples are overwritten. */
+    first = Head - BURST_RING_SIZE;
+    if ((int32_t)(first - EndIdx) > 0)
+    {
+      first = EndIdx;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    Stat.dropped += first - OutIdx;
+    OutIdx = first;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  last = ((int32_t)(Head - EndIdx) < 0) ? Head : EndIdx;
+  if (OutIdx == EndIdx)
+  {
+    /* The rest of the burst was overwritten. */
+    Active = false;
+    return false;
+  }
+  else if (OutIdx == last)
+  {
+    /* Waiting for samples after the trigger. */
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pEntry = &Ring[OutIdx & BURST_RING_MASK];
+  pSample->count_us = pEntry->count_us;
+  pSample->index = (int32_t)(OutIdx - TriggerIdx);
+  pSample->trigger = Tag;
+  pSample->acc[0] = pEntry->acc[0];
+  pSample->acc[1] = pEntry->acc[1];
+  pSample->acc[2] = pEntry->acc[2];
+  OutIdx++;
+  Stat.written++;
+
+  if (OutIdx == EndIdx)
+  {
+    Active = false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return true;
+}
+
+bool BurstActive(void)
+{
+  return Active;
+}
+
+void BurstGetStat(BurstStat *pStat)
+{
+  *pStat = Stat;
+}
+
+#endif /* SUBCORE */
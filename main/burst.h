@@ -0,0 +1,136 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _BURST_H_
+#define _BURST_H_
+
+/**
+ * @file burst.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Full rate samples around activity events.
+ * @details Every sample at the accelerometer output data rate goes into a
+ *          ring that holds the pre-trigger window. A trigger, from the
+ *          dynamic acceleration or from the KX122 wake-up engine, marks the
+ *          ring from pre samples before it to post samples after it for
+ *          output. A trigger during a burst extends it under the same tag.
+ *          Called from the main loop only, there is no locking.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Macro definitions
+ */
+#define BURST_RING_SIZE        4096           /**< Samples in the ring, power of two */
+#define BURST_HP_SHIFT         7              /**< Gravity running mean of 2^n samples */
+
+#if (BURST_RING_SIZE & (BURST_RING_SIZE - 1)) != 0
+#error "BURST_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * @enum BurstSource
+ * @brief Burst trigger source
+ */
+enum BurstSource
+{
+  eBurstOff,          /**< No bursts, samples at AccRate only */
+  eBurstDba,          /**< Dynamic acceleration above the threshold */
+  eBurstWakeup,       /**< KX122 wake-up engine, see KX122::init_wuf() */
+};
+
+/**
+ * @struct BurstSample
+ * @brief One full rate sample of a burst
+ */
+typedef struct
+{
+  uint64_t count_us;      /**< Timebase counter when the sample was taken [us] */
+  int32_t  index;         /**< Samples from the trigger, negative before it */
+  uint32_t trigger;       /**< Tag of the burst, see BurstPut() */
+  int16_t  acc[3];        /**< Acceleration X/Y/Z [counts] */
+} BurstSample;
+
+/**
+ * @struct BurstStat
+ * @brief Burst counters
+ */
+typedef struct
+{
+  uint32_t triggers;      /**< Bursts started */
+  uint32_t extended;      /**< Triggers that extended a burst */
+  uint32_t missed;        /**< Triggers while a finished burst was still read out */
+  uint32_t written;       /**< Samples read out */
+  uint32_t dropped;       /**< Samples overwritten before they were read out */
+} BurstStat;
+
+/**
+ * @brief Empty the ring and start the gravity estimate again.
+ * 
+ * @param [in] trigger Trigger source
+ * @param [in] threshold Dynamic acceleration that triggers eBurstDba [counts]
+ * @param [in] pre Samples before the trigger, at most BURST_RING_SIZE / 2
+ * @param [in] post Samples from the trigger on, at least 1
+ */
+void BurstBegin(BurstSource trigger, uint32_t threshold, uint32_t pre, uint32_t post);
+
+/**
+ * @brief Add one full rate sample.
+ * 
+ * @param [in] acc Acceleration X/Y/Z [counts]
+ * @param [in] count_us Timebase counter when the sample was taken [us]
+ * @param [in] tag Tag of a burst triggered by this sample, e.g. its record sequence number
+ */
+void BurstPut(const int16_t *acc, uint64_t count_us, uint32_t tag);
+
+/**
+ * @brief Trigger a burst at the next sample, e.g. on the wake-up interrupt.
+ * 
+ * @param [in] tag Tag of the burst
+ */
+void BurstTrigger(uint32_t tag);
+
+/**
+ * @brief Get the next sample of a burst.
+ * 
+ * @param [out] pSample Sample
+ * @return true if a sample was read out
+ */
+bool BurstGet(BurstSample *pSample);
+
+/**
+ * @brief Check for samples of a burst still to be read out.
+ * 
+ * @return true while a burst is captured or read out
+ */
+bool BurstActive(void);
+
+/**
+ * @brief Get the burst counters.
+ * 
+ * @param [out] pStat Counters since BurstBegin()
+ */
+void BurstGetStat(BurstStat *pStat);
+
+#endif /* _BURST_H_ */
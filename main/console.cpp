@@ -0,0 +1,335 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file console.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Command console on the serial port.
+ */
+
+#ifndef SUBCORE
+#include <ctype.h>
+#include <strings.h>
+#include "console.h"
+
+/**
+ * @brief global APIs
+ */
+extern const char *GetParameterKey(int index);
+extern int GetParameter(const char *pKey, char *pBuff, int size, boolean saved);
+extern int SetParameter(const char *pKey, const char *pData);
+extern void SaveParameter(void);
+extern boolean RequestRenewFile(void);
+extern void ReportPerformance(void);
+extern boolean StartBenchmark(unsigned long sec);
+
+/**
+ * @struct ConsoleCommand
+ * @brief One command of the console
+ */
+typedef struct
+{
+  const char *pName;                          /**< First word of the line */
+  const char *pHelp;                          /**< Arguments and description */
+  void (*pHandler)(int argc, char *argv[]);   /**< argv[0] is the name */
+} ConsoleCommand;
+
+/**
+ * @brief private APIs
+ */
+static void CommandHelp(int argc, char *argv[]);
+static void CommandGet(int argc, char *argv[]);
+static void CommandSet(int argc, char *argv[]);
+static void CommandSave(int argc, char *argv[]);
+static void CommandRotate(int argc, char *argv[]);
+static void CommandStats(int argc, char *argv[]);
+static void CommandBench(int argc, char *argv[]);
+static void ConsoleRun(char *pLine);
+
+/**
+ * @brief private variables
+ */
+static const ConsoleCommand CommandList[] =
+{
+  { "help",   "                List the commands",                        CommandHelp   },
+  { "get",    " [key]          Print one parameter or all of them",       CommandGet    },
+  { "set",    " key value      Change a parameter, save keeps it",        CommandSet    },
+  { "save",   "                Write the parameters to the ini file",     CommandSave   },
+  { "rotate", "                Close the files and open new ones",        CommandRotate },
+  { "stats",  "                Print the performance counters",           CommandStats  },
+  { "bench",  " sec            Print the counters after sec seconds",     CommandBench  },
+};
+
+static char LineBuff[CONSOLE_LINE_MAX];       /**< Line being received */
+static int LineLen = 0;                       /**< Characters in LineBuff */
+static boolean LineOver = false;              /**< Line is longer than LineBuff */
+
+/**
+ * @brief Print the commands.
+ */
+static void CommandHelp(int argc, char *argv[])
+{
+  char String[STRING_BUFFER_SIZE];
+  unsigned int cnt;
+
+  for (cnt = 0; cnt < sizeof(CommandList) / sizeof(CommandList[0]); cnt++)
+  {
+    snprintf(String, sizeof(String), "%s%s", CommandList[cnt].pName, CommandList[cnt].pHelp);
+    Serial.println(String);
+  }
+}
+
+/**
+ * @brief Print a parameter in use, and the saved value if it is not in use yet.
+ */
+static void CommandGet(int argc, char *argv[])
+{
+  char String[STRING_BUFFER_SIZE];
+  char Value[32];
+  char Saved[32];
+  const char *pKey;
+  int index;
+
+  for (index = 0; (pKey = GetParameterKey(index)) != NULL; index++)
+  {
+    if ((argc < 2) || (strcasecmp(argv[1], pKey) == 0))
+    {
+      GetParameter(pKey, Value, sizeof(Value), false);
+      GetParameter(pKey, Saved, sizeof(Saved), true);
+      if (strcmp(Value, Saved) == 0)
+      {
+        snprintf(String, sizeof(String), "%s=%s", pKey, Value);
+      }
+      else
+      {
+        snprintf(String, sizeof(String), "%s=%s (%s after restart)", pKey, Value, Saved);
+      }
+      Serial.println(String);
+      if (argc >= 2)
+      {
+        return;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  if (argc >= 2)
+  {
+    Serial.println("ERROR unknown key");
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Change a parameter.
+ */
+static void CommandSet(int argc, char *argv[])
+{
+  if (argc < 3)
+  {
+    Serial.println("ERROR set key value");
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  switch (SetParameter(argv[1], argv[2]))
+  {
+    case 0:
+      Serial.println("OK");
+      break;
+
+    case 1:
+      Serial.println("OK after save and restart");
+      break;
+
+    default:
+      Serial.println("ERROR unknown key, or value unknown or out of range");
+      break;
+  }
+}
+
+/**
+ * @brief Write the parameters to the ini file.
+ */
+static void CommandSave(int argc, char *argv[])
+{
+  SaveParameter();
+  Serial.println("OK");
+}
+
+/**
+ * @brief Start a new pair of files.
+ */
+static void CommandRotate(int argc, char *argv[])
+{
+  if (RequestRenewFile() == true)
+  {
+    Serial.println("OK");
+  }
+  else
+  {
+    Serial.println("ERROR not recording");
+  }
+}
+
+/**
+ * @brief Print the performance counters.
+ */
+static void CommandStats(int argc, char *argv[])
+{
+  ReportPerformance();
+}
+
+/**
+ * @brief Start a timed benchmark.
+ */
+static void CommandBench(int argc, char *argv[])
+{
+  unsigned long sec = (argc >= 2) ? strtoul(argv[1], NULL, 10) : 0;
+
+  if ((sec == 0) || (sec > 3600))
+  {
+    Serial.println("ERROR bench sec(1-3600)");
+  }
+  else if (StartBenchmark(sec) == true)
+  {
+    Serial.println("OK");
+  }
+  else
+  {
+    Serial.println("ERROR bench is running");
+  }
+}
+
+/**
+ * @brief Split a line into words and run the command.
+ * 
+ * @param [in] pLine Line without the line end, modified in place
+ */
+static void ConsoleRun(char *pLine)
+{
+  char *argv[CONSOLE_ARG_MAX];
+  int argc = 0;
+  unsigned int cnt;
+
+  while ((*pLine != '\0') && (argc < CONSOLE_ARG_MAX))
+  {
+    while (isspace(*pLine))
+    {
+      *pLine++ = '\0';
+    }
+    if (*pLine != '\0')
+    {
+      argv[argc++] = pLine;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    while ((*pLine != '\0') && !isspace(*pLine))
+    {
+      pLine++;
+    }
+  }
+  /* Ignore extra words. */
+  *pLine = '\0';
+  if (argc == 0)
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  for (cnt = 0; cnt < sizeof(CommandList) / sizeof(CommandList[0]); cnt++)
+  {
+    if (strcasecmp(argv[0], CommandList[cnt].pName) == 0)
+    {
+      CommandList[cnt].pHandler(argc, argv);
+      return;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  Serial.println("ERROR unknown command, try help");
+}
+
+void ConsoleBegin(void)
+{
+  LineLen = 0;
+  LineOver = false;
+  Serial.println("Console ready, try help");
+}
+
+void ConsoleProcessing(void)
+{
+  int c;
+
+  while (Serial.available() > 0)
+  {
+    c = Serial.read();
+    if ((c == '\n') || (c == '\r'))
+    {
+      LineBuff[LineLen] = '\0';
+      if (LineOver == true)
+      {
+        Serial.println("ERROR line too long");
+      }
+      else
+      {
+        ConsoleRun(LineBuff);
+      }
+      LineLen = 0;
+      LineOver = false;
+      /* Run one command per loop, the rest waits in the serial buffer. */
+      return;
+    }
+    else if (LineLen < CONSOLE_LINE_MAX - 1)
+    {
+      LineBuff[LineLen++] = (char)c;
+    }
+    else
+    {
+      LineOver = true;
+    }
+  }
+}
+
+#endif /* SUBCORE */
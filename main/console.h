@@ -0,0 +1,63 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef _CONSOLE_H_
+#define _CONSOLE_H_
+
+/**
+ * @file console.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Command console on the serial port.
+ * @details Characters are taken from Serial as they arrive, so the main
+ *          loop never waits for a line. A complete line is run as one
+ *          command:
+ *          - help                  List the commands
+ *          - get [key]             Print one parameter or all of them
+ *          - set key value         Change a parameter, see SetParameter
+ *          - save                  Write the parameters to the ini file
+ *          - rotate                Close the files and open new ones
+ *          - stats                 Print the performance counters
+ *          - bench sec             Print the counters after sec seconds
+ */
+
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define CONSOLE_LINE_MAX       64             /**< Longest command line including NUL */
+#define CONSOLE_ARG_MAX        3              /**< Most words in a command line */
+
+/**
+ * @brief Clear the line being received and print the prompt.
+ */
+void ConsoleBegin(void);
+
+/**
+ * @brief Take the received characters and run a complete line.
+ * 
+ * @details Called from the main loop. Returns at once if nothing arrived.
+ */
+void ConsoleProcessing(void);
+
+#endif /* _CONSOLE_H_ */
@@ -0,0 +1,137 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file gnss_backup.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Keep GNSS hot start data across power cycles.
+ */
+
+#ifndef SUBCORE
+#include "gnss_backup.h"
+
+/**
+ * @brief global variables
+ */
+extern SpGnss Gnss;                           /**< SpGnss object */
+
+/**
+ * @brief private variables
+ */
+static boolean Saved = false;                 /**< Saved once since boot */
+static unsigned long SavedTime = 0;           /**< millis() of the last save */
+
+boolean GnssBackupRestore(void)
+{
+  char Buff[GNSS_BACKUP_SIZE + 1];
+  SpGnssTime Time;
+  RtcTime local;
+  RtcTime now;
+  unsigned long fix_sec = 0;
+  char *pLine;
+  int ReadSize;
+
+  ReadSize = ReadChar(Buff, GNSS_BACKUP_SIZE, GNSS_BACKUP_FILE, FILE_READ);
+  if (ReadSize <= 0)
+  {
+    return false;
+  }
+  else
+  {
+    Buff[ReadSize] = '\0';
+  }
+
+  /* Time=<s since 1970/01/01 UTC> */
+  pLine = strstr(Buff, "Time=");
+  if (pLine != NULL)
+  {
+    fix_sec = strtoul(&pLine[5], NULL, 10);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* After a battery swap the RTC starts at 1970, GNSS then finds the time itself. */
+  RTC.begin();
+  local = RTC.getTime();
+  now = RtcTime(local.unixtime() - MY_TIMEZONE_IN_SECONDS, local.nsec());
+  if ((fix_sec == 0) || (now.year() < 2000) || (now.unixtime() < fix_sec))
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  Time.year   = now.year();
+  Time.month  = now.month();
+  Time.day    = now.day();
+  Time.hour   = now.hour();
+  Time.minute = now.minute();
+  Time.sec    = now.second();
+  Time.usec   = now.nsec() / 1000;
+  if (Gnss.setTime(&Time) != 0)
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* The ephemeris in the saved backup is only good for a few hours. */
+  return (now.unixtime() - fix_sec) < (GNSS_HOT_WINDOW_MS / 1000);
+}
+
+boolean GnssBackupSave(const SpNavData *pNavData)
+{
+  char Buff[GNSS_BACKUP_SIZE];
+  RtcTime utc(pNavData->time.year, pNavData->time.month, pNavData->time.day,
+              pNavData->time.hour, pNavData->time.minute, pNavData->time.sec, 0);
+  int length;
+
+  if ((Saved == true) && ((millis() - SavedTime) < GNSS_BACKUP_INTERVAL))
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  Saved = true;
+  SavedTime = millis();
+
+  /* Ephemeris, almanac and position to flash. */
+  Gnss.saveEphemeris();
+
+  length = snprintf(Buff, sizeof(Buff), "Time=%lu\nLatitude=%.6f\nLongitude=%.6f\nAltitude=%.1f\n",
+                    (unsigned long)utc.unixtime(), pNavData->latitude, pNavData->longitude, pNavData->altitude);
+  Remove(GNSS_BACKUP_FILE);
+
+  return (WriteChar(Buff, GNSS_BACKUP_FILE, FILE_WRITE) == length);
+}
+
+#endif /* SUBCORE */
@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _GNSS_BACKUP_H_
+#define _GNSS_BACKUP_H_
+
+/**
+ * @file gnss_backup.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Keep GNSS hot start data across power cycles.
+ * @details After a good fix the receiver backup (ephemeris, almanac and
+ *          position) is saved to flash with SpGnss::saveEphemeris and the
+ *          fix time and position to GNSS_BACKUP_FILE on the SD card. At boot
+ *          the GNSS time is set from the RTC if it kept running, so the
+ *          first start can be hot.
+ */
+
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define GNSS_BACKUP_FILE       "gnss.ini"     /**< Last fix on the SD card */
+#define GNSS_BACKUP_SIZE       128            /**< Backup file size */
+#define GNSS_BACKUP_INTERVAL   21600000       /**< [ms] Shortest time between flash writes */
+
+/**
+ * @brief Restore the hot start data. Call after SpGnss::begin.
+ * 
+ * @return true if the GNSS time was set and the last fix is recent enough
+ *         for a hot start
+ */
+boolean GnssBackupRestore(void);
+
+/**
+ * @brief Save the hot start data if GNSS_BACKUP_INTERVAL has passed.
+ * 
+ * @details The first call after boot always saves. Call after GNSS was
+ *          stopped, the flash write blocks for a short time.
+ * @param [in] pNavData Last navigation data with a position fix
+ * @return true if saved
+ */
+boolean GnssBackupSave(const SpNavData *pNavData);
+
+#endif /* _GNSS_BACKUP_H_ */
@@ -1,5 +1,5 @@
 /*
- *  gnss_nmea.cpp - NMEA's GGA sentence
+ *  gnss_nmea.cpp - NMEA sentences
  *  Copyright 2017 Sony Semiconductor Solutions Corporation
  *
  *  This library is free software; you can redistribute it and/or
@@ -20,56 +20,193 @@
 /**
  * @file gnss_nmea.cpp
  * @author Sony Semiconductor Solutions Corporation
- * @brief NMEA's GGA sentence
+ * @brief NMEA sentences
  */
 
-#include "main.h"
+#ifndef SUBCORE
+#include <ctype.h>
+#include <math.h>
+#include "gnss_nmea.h"
+#include "sensor_format.h"
 
 #define CORIDNATE_TYPE_LATITUDE   0  /**< Coordinate type latitude */
 #define CORIDNATE_TYPE_LONGITUDE  1  /**< Coordinate type longitude */
 
-#define STRING_BUFFER_SIZE  128      /**< Sentence buffer size */
+#define NMEA_TAIL_SIZE      6        /**< "*hh" CR LF NUL */
+#define NMEA_GSV_PER_LINE   4        /**< Satellites in one GSV sentence */
+#define NMEA_KNOT_PER_MPS   1.943844 /**< [knot] in 1 [m/s] */
 
 /**
- * @brief global APIs
+ * @struct NmeaWriter
+ * @brief Sentence under construction
  */
-extern String getNmeaGga(SpNavData* pNavData);
+typedef struct
+{
+  char          *pHead;    /**< Start of the sentence */
+  char          *p;        /**< Write position */
+  char          *pEnd;     /**< End of the body, the tail is kept free */
+  unsigned char CheckSum;  /**< XOR of the characters after '$' */
+  boolean       Overflow;  /**< The body did not fit */
+} NmeaWriter;
+
+/**
+ * @brief private variables
+ */
+static const struct
+{
+  const char    *pTalker;  /**< Talker ID of the GSV group */
+  unsigned char Mask;      /**< (1 << SpSatelliteType) in the group */
+} NmeaGsvList[] =
+{
+  { "GP", (1 << GPS) | (1 << SBAS) | (1 << QZ_L1CA) | (1 << QZ_L1S) | (1 << IMES) },
+  { "GL", (1 << GLONASS) },
+  { "GA", (1 << GALILEO) },
+  { "GB", (1 << BEIDOU) },
+};
+
+static const struct
+{
+  const char    *pName;    /**< Name in the ini file */
+  unsigned char Sentence;  /**< NMEA_xxx */
+  int (*pBuild)(char *pBuff, int size, SpNavData *pNavData);
+} NmeaList[] =
+{
+  /* Output order. */
+  { "GGA", NMEA_GGA, NmeaBuildGga },
+  { "RMC", NMEA_RMC, NmeaBuildRmc },
+  { "GSA", NMEA_GSA, NmeaBuildGsa },
+  { "GSV", NMEA_GSV, NmeaBuildGsv },
+  { "ZDA", NMEA_ZDA, NmeaBuildZda },
+};
 
 /**
- * @brief Calculate the checksum and add it to the end.
+ * @brief Add a character to the body and the checksum.
  * 
- * @param [in] pStrDest Data to calculate checksum
- * @return checksum
+ * @param [in,out] pWriter Sentence under construction
+ * @param [in] c Character
  */
-static unsigned short CalcCheckSum(const char *pStrDest)
+static void NmeaPutChar(NmeaWriter *pWriter, char c)
 {
-  unsigned short CheckSum = 0;
-  int cnt;
+  if (pWriter->p < pWriter->pEnd)
+  {
+    *pWriter->p++ = c;
+    pWriter->CheckSum ^= (unsigned char)c;
+  }
+  else
+  {
+    pWriter->Overflow = true;
+  }
+}
+
+/**
+ * @brief Add a string to the body.
+ * 
+ * @param [in,out] pWriter Sentence under construction
+ * @param [in] pString String
+ */
+static void NmeaPutString(NmeaWriter *pWriter, const char *pString)
+{
+  while (*pString != '\0')
+  {
+    NmeaPutChar(pWriter, *pString++);
+  }
+}
+
+/**
+ * @brief Add an unsigned number with leading zeros.
+ * 
+ * @param [in,out] pWriter Sentence under construction
+ * @param [in] value Number
+ * @param [in] width Minimum digits
+ */
+static void NmeaPutUint(NmeaWriter *pWriter, unsigned long value, int width)
+{
+  char digit[12];
+  char *pLast = FormatUint(digit, value, width);
+
+  *pLast = '\0';
+  NmeaPutString(pWriter, digit);
+}
+
+/**
+ * @brief Add a number with a fixed count of decimals, like printf("%.*f").
+ * 
+ * @param [in,out] pWriter Sentence under construction
+ * @param [in] value Number
+ * @param [in] decimals Digits after the point (0-3)
+ */
+static void NmeaPutFloat(NmeaWriter *pWriter, double value, int decimals)
+{
+  static const double Scale[] = { 1.0, 10.0, 100.0, 1000.0 };
+  double product = value * Scale[decimals];
+  double rounded = rint(product);
+  double error;
+  char digit[16];
+  char *pLast;
+
+  /* A tie after the multiply is decided by the exact product, as printf does. */
+  if (fabs(product - trunc(product)) == 0.5)
+  {
+    error = fma(value, Scale[decimals], -product);
+    if (error > 0.0)
+    {
+      rounded = ceil(product);
+    }
+    else if (error < 0.0)
+    {
+      rounded = floor(product);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
 
-  /* Calculate checksum as xor of characters. */
-  for (cnt = 1; pStrDest[cnt] != 0x00; cnt++)
+  /* Keep the sign of values that round to zero, like "-0.0". */
+  if ((value < 0.0) && (rounded == 0.0))
   {
-    CheckSum = CheckSum ^ pStrDest[cnt];
+    NmeaPutChar(pWriter, '-');
   }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pLast = FormatFixed(digit, (long)rounded, decimals);
+  *pLast = '\0';
+  NmeaPutString(pWriter, digit);
+}
 
-  return CheckSum;
+/**
+ * @brief Add the UTC time "hhmmss.ss".
+ * 
+ * @param [in,out] pWriter Sentence under construction
+ * @param [in] pTime GNSS time
+ */
+static void NmeaPutTime(NmeaWriter *pWriter, const SpGnssTime *pTime)
+{
+  NmeaPutUint(pWriter, pTime->hour, 2);
+  NmeaPutUint(pWriter, pTime->minute, 2);
+  NmeaPutUint(pWriter, pTime->sec, 2);
+  NmeaPutChar(pWriter, '.');
+  NmeaPutUint(pWriter, pTime->usec / 10000, 2);
 }
 
 /**
- * @brief Convert coordinate values for NMEA.
+ * @brief Add a coordinate "ddmm.mmmm,N" or "dddmm.mmmm,E".
  * 
- * @param [out] pBuffer %Buffer to write converted values
- * @param [in] length Size of pBuffer
+ * @param [in,out] pWriter Sentence under construction
  * @param [in] Coordinate Latitude or longitude
  * @param [in] cordinate_type Coordinate type: CORIDNATE_TYPE_LATITUDE or CORIDNATE_TYPE_LONGITUDE
  */
-static void CoordinateToString(char *pBuffer, int length, double Coordinate,
-                               unsigned int cordinate_type)
+static void NmeaPutCoordinate(NmeaWriter *pWriter, double Coordinate,
+                              unsigned int cordinate_type)
 {
-  double tmp;
-  int Degree;
-  int Minute;
-  int Minute2;
+  unsigned long minute;
   char direction;
   unsigned char fixeddig;
 
@@ -81,122 +218,538 @@ static void CoordinateToString(char *pBuffer, int length, double Coordinate,
      { .fixeddigit = 3, .dir = { 'E', 'W' } },
   };
 
-  if (cordinate_type > CORIDNATE_TYPE_LONGITUDE)
-  {
-    snprintf(pBuffer, length, ",,");
-    return;
-  }
-
   if (Coordinate >= 0.0)
   {
-    tmp = Coordinate;
     direction = CordInfo[cordinate_type].dir[0];
   }
   else
   {
-    tmp = -Coordinate;
+    Coordinate = -Coordinate;
     direction = CordInfo[cordinate_type].dir[1];
   }
   fixeddig = CordInfo[cordinate_type].fixeddigit;
-  Degree = (int) tmp;
-  tmp = (tmp - (double)Degree) * 60;
-  Minute = (int)tmp;
-  tmp = (tmp - (double)Minute) * 10000 + 0.5;
-  Minute2 = (int)tmp;
 
-  snprintf(pBuffer, length, "%0*d%02d.%04d,%c,", fixeddig, Degree, Minute, Minute2, direction);
+  /* Round once in 1/10000 minute, so the minutes never show 60. */
+  minute = (unsigned long)(Coordinate * 600000.0 + 0.5);
+
+  NmeaPutUint(pWriter, minute / 600000, fixeddig);
+  NmeaPutUint(pWriter, (minute / 10000) % 60, 2);
+  NmeaPutChar(pWriter, '.');
+  NmeaPutUint(pWriter, minute % 10000, 4);
+  NmeaPutChar(pWriter, ',');
+  NmeaPutChar(pWriter, direction);
+}
+
+/**
+ * @brief Start a sentence "$ttsss".
+ * 
+ * @param [out] pWriter Sentence under construction
+ * @param [in] pBuff Buffer to write the sentence
+ * @param [in] size Size of pBuff
+ * @param [in] pAddress Talker ID and sentence type
+ */
+static void NmeaBegin(NmeaWriter *pWriter, char *pBuff, int size, const char *pAddress)
+{
+  pWriter->pHead = pBuff;
+  pWriter->p = pBuff;
+  pWriter->pEnd = (size > NMEA_TAIL_SIZE) ? (pBuff + size - NMEA_TAIL_SIZE) : pBuff;
+  pWriter->CheckSum = 0;
+  pWriter->Overflow = false;
+
+  if (pWriter->p < pWriter->pEnd)
+  {
+    /* '$' is not in the checksum. */
+    *pWriter->p++ = '$';
+  }
+  else
+  {
+    pWriter->Overflow = true;
+  }
+  NmeaPutString(pWriter, pAddress);
+}
+
+/**
+ * @brief Finish a sentence with "*hh" CR LF.
+ * 
+ * @param [in,out] pWriter Sentence under construction
+ * @return Length without NUL, 0 if it did not fit
+ */
+static int NmeaEnd(NmeaWriter *pWriter)
+{
+  static const char Hex[] = "0123456789ABCDEF";
+
+  if (pWriter->Overflow == true)
+  {
+    if (pWriter->pEnd > pWriter->pHead)
+    {
+      pWriter->pHead[0] = '\0';
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  *pWriter->p++ = '*';
+  *pWriter->p++ = Hex[pWriter->CheckSum >> 4];
+  *pWriter->p++ = Hex[pWriter->CheckSum & 0x0F];
+  *pWriter->p++ = '\r';
+  *pWriter->p++ = '\n';
+  *pWriter->p = '\0';
 
-  return ;
+  return (int)(pWriter->p - pWriter->pHead);
 }
 
-String getNmeaGga(SpNavData* pNavData)
+int NmeaBuildGga(char *pBuff, int size, SpNavData *pNavData)
 {
-  String Gga;
-  char StringBuffer[STRING_BUFFER_SIZE];
-  int msec;
-  unsigned short CheckSum;
+  NmeaWriter Writer;
 
   /* Set Header. */
-  Gga = "$GPGGA,";
+  NmeaBegin(&Writer, pBuff, size, "GPGGA,");
 
   /* Set time. */
-  msec = pNavData->time.usec / 10000;
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%02d%02d%02d.%02d,", pNavData->time.hour, pNavData->time.minute, pNavData->time.sec, msec);
-  Gga += StringBuffer;
+  NmeaPutTime(&Writer, &pNavData->time);
+  NmeaPutChar(&Writer, ',');
 
   /* Set Coordinate. */
   if (pNavData->posDataExist)
   {
     /* Convert to DMM(Degree,Minute,Minute). */
-    CoordinateToString(StringBuffer, STRING_BUFFER_SIZE, pNavData->latitude, CORIDNATE_TYPE_LATITUDE);
-    Gga += StringBuffer;
-
-    CoordinateToString(StringBuffer, STRING_BUFFER_SIZE, pNavData->longitude, CORIDNATE_TYPE_LONGITUDE);
-    Gga += StringBuffer;
+    NmeaPutCoordinate(&Writer, pNavData->latitude, CORIDNATE_TYPE_LATITUDE);
+    NmeaPutChar(&Writer, ',');
+    NmeaPutCoordinate(&Writer, pNavData->longitude, CORIDNATE_TYPE_LONGITUDE);
+    NmeaPutChar(&Writer, ',');
   }
   else
   {
     /* Position not fixed. */
-    snprintf(StringBuffer, STRING_BUFFER_SIZE, ",,,,");
-    Gga += StringBuffer;
+    NmeaPutString(&Writer, ",,,,");
   }
 
   /* Set Quality indicator. */
   if (pNavData->type != SpPvtTypeGnss)
   {
     /* Fix invalid. */
-    snprintf(StringBuffer, STRING_BUFFER_SIZE, "0,");
+    NmeaPutString(&Writer, "0,");
   }
   else
   {
-    /* Set fixed value. */
     /* GPS SPS mode,fix valid. */
-    snprintf(StringBuffer, STRING_BUFFER_SIZE, "1,");
+    NmeaPutString(&Writer, "1,");
   }
-  Gga += StringBuffer;
 
   /* Set Number of satellites in use. */
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%02d,", pNavData->numSatellitesCalcPos);
-  Gga += StringBuffer;
+  NmeaPutUint(&Writer, pNavData->numSatellitesCalcPos, 2);
+  NmeaPutChar(&Writer, ',');
 
-  /* Set the HDOP to string. */
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, ",");
-  if (pNavData->posDataExist)
+  /* Set the HDOP. */
+  if ((pNavData->posDataExist) && (pNavData->hdop != -1.0))
   {
-    /* Position fixed. */
-    if (pNavData->hdop != -1.0) {
-      snprintf(StringBuffer, STRING_BUFFER_SIZE, "%.1f,", pNavData->hdop);
-    }
+    NmeaPutFloat(&Writer, pNavData->hdop, 1);
+  }
+  else
+  {
+    /* do nothing. */
   }
-  Gga += StringBuffer;
+  NmeaPutChar(&Writer, ',');
 
-  /* Set the MSL altitude. */
-  /* Set the MSL units. */
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, ",,");
+  /* Set the MSL altitude, the Geiod separation is skipped. */
   if (pNavData->posDataExist)
   {
-    /* Position fixed. */
-    snprintf(StringBuffer, STRING_BUFFER_SIZE, "%.1f,M,", pNavData->altitude);
+    NmeaPutFloat(&Writer, pNavData->altitude, 1);
+    NmeaPutString(&Writer, ",M,,M,");
   }
-  Gga += StringBuffer;
+  else
+  {
+    NmeaPutString(&Writer, ",,,,");
+  }
+
+  /* Set the Age of Differential GPS data. Not really applicable. */
+  NmeaPutChar(&Writer, ',');
+
+  return NmeaEnd(&Writer);
+}
 
-  /* Set the Geiod separation. */
-  /* Setthe Geiod separation. */
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, ",,");
+int NmeaBuildRmc(char *pBuff, int size, SpNavData *pNavData)
+{
+  NmeaWriter Writer;
+  SpGnssTime *pTime = &pNavData->time;
+
+  /* Set Header. */
+  NmeaBegin(&Writer, pBuff, size, "GPRMC,");
+
+  /* Set time and status. */
+  NmeaPutTime(&Writer, pTime);
+  NmeaPutString(&Writer, (pNavData->posDataExist) ? ",A," : ",V,");
+
+  /* Set Coordinate, speed [knot] and course [deg]. */
   if (pNavData->posDataExist)
   {
-    /* Skip Geoid */
-    snprintf(StringBuffer, STRING_BUFFER_SIZE, ",M,");
+    NmeaPutCoordinate(&Writer, pNavData->latitude, CORIDNATE_TYPE_LATITUDE);
+    NmeaPutChar(&Writer, ',');
+    NmeaPutCoordinate(&Writer, pNavData->longitude, CORIDNATE_TYPE_LONGITUDE);
+    NmeaPutChar(&Writer, ',');
+    NmeaPutFloat(&Writer, pNavData->velocity * NMEA_KNOT_PER_MPS, 1);
+    NmeaPutChar(&Writer, ',');
+    NmeaPutFloat(&Writer, pNavData->direction, 1);
+    NmeaPutChar(&Writer, ',');
+  }
+  else
+  {
+    NmeaPutString(&Writer, ",,,,,,");
   }
-  Gga += StringBuffer;
 
-  /* Set the Age of Differential GPS data. Not really applicable. */
-  Gga += ",";
+  /* Set date "ddmmyy". */
+  NmeaPutUint(&Writer, pTime->day, 2);
+  NmeaPutUint(&Writer, pTime->month, 2);
+  NmeaPutUint(&Writer, pTime->year % 100, 2);
 
-  /* Set checksum "*hh". */
-  CheckSum = CalcCheckSum(Gga.c_str());
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "*%02X\r\n", CheckSum);
-  Gga += StringBuffer;
+  /* Skip the magnetic variation, set the mode indicator. */
+  NmeaPutString(&Writer, (pNavData->posDataExist) ? ",,,A" : ",,,N");
 
-  return Gga;
+  return NmeaEnd(&Writer);
 }
+
+int NmeaBuildGsa(char *pBuff, int size, SpNavData *pNavData)
+{
+  NmeaWriter Writer;
+  unsigned char mode = pNavData->posFixMode;
+  int cnt;
+
+  /* Set Header and automatic 2D/3D. */
+  NmeaBegin(&Writer, pBuff, size, "GPGSA,A,");
+
+  /* Set fix mode: 1 no fix, 2 2D, 3 3D. */
+  if ((pNavData->posDataExist == 0) || (mode < Fix2D) || (mode > Fix3D))
+  {
+    mode = FixInvalid;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  NmeaPutUint(&Writer, mode, 1);
+  NmeaPutChar(&Writer, ',');
+
+  /* Satellites used for the fix are not reported. */
+  for (cnt = 0; cnt < 12; cnt++)
+  {
+    NmeaPutChar(&Writer, ',');
+  }
+
+  /* Set PDOP, HDOP and VDOP. */
+  if (mode != FixInvalid)
+  {
+    NmeaPutFloat(&Writer, pNavData->pdop, 1);
+    NmeaPutChar(&Writer, ',');
+    NmeaPutFloat(&Writer, pNavData->hdop, 1);
+    NmeaPutChar(&Writer, ',');
+    NmeaPutFloat(&Writer, pNavData->vdop, 1);
+  }
+  else
+  {
+    NmeaPutString(&Writer, ",,");
+  }
+
+  return NmeaEnd(&Writer);
+}
+
+/**
+ * @brief Satellite ID in the NMEA numbering.
+ * 
+ * @param [in] type Satellite system
+ * @param [in] svid Satellite ID from the receiver
+ * @return NMEA satellite ID
+ */
+static unsigned int NmeaSatelliteId(SpSatelliteType type, unsigned int svid)
+{
+  if ((type == SBAS) && (svid >= 120))
+  {
+    /* PRN 120-158 are 33-71. */
+    return svid - 87;
+  }
+  else if ((type == GLONASS) && (svid <= 32))
+  {
+    /* Slot 1-32 is 65-96. */
+    return svid + 64;
+  }
+  else
+  {
+    return svid;
+  }
+}
+
+int NmeaBuildGsv(char *pBuff, int size, SpNavData *pNavData)
+{
+  NmeaWriter Writer;
+  char Address[8] = "ttGSV,";
+  unsigned int num = pNavData->numSatellites;
+  unsigned int group;
+  unsigned int cnt;
+  unsigned int index;
+  unsigned int total;
+  unsigned int line;
+  unsigned int sat;
+  int length = 0;
+  int written;
+  long level;
+
+  if (num > SP_GNSS_MAX_SV_NUM)
+  {
+    num = SP_GNSS_MAX_SV_NUM;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  for (group = 0; group < sizeof(NmeaGsvList) / sizeof(NmeaGsvList[0]); group++)
+  {
+    /* Count the satellites of this group. */
+    total = 0;
+    for (cnt = 0; cnt < num; cnt++)
+    {
+      if (((1 << pNavData->getSatelliteType(cnt)) & NmeaGsvList[group].Mask) != 0)
+      {
+        total++;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    }
+    if (total == 0)
+    {
+      continue;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+
+    Address[0] = NmeaGsvList[group].pTalker[0];
+    Address[1] = NmeaGsvList[group].pTalker[1];
+    index = 0;
+    sat = 0;
+    for (line = 1; sat < total; line++)
+    {
+      /* Set Header, number of sentences, sentence number and satellites in view. */
+      NmeaBegin(&Writer, pBuff + length, size - length, Address);
+      NmeaPutUint(&Writer, (total + NMEA_GSV_PER_LINE - 1) / NMEA_GSV_PER_LINE, 1);
+      NmeaPutChar(&Writer, ',');
+      NmeaPutUint(&Writer, line, 1);
+      NmeaPutChar(&Writer, ',');
+      NmeaPutUint(&Writer, total, 2);
+
+      /* Set ID, elevation, azimuth and SNR of up to 4 satellites. */
+      for (cnt = 0; (cnt < NMEA_GSV_PER_LINE) && (sat < total); index++)
+      {
+        if (((1 << pNavData->getSatelliteType(index)) & NmeaGsvList[group].Mask) == 0)
+        {
+          continue;
+        }
+        else
+        {
+          /* do nothing. */
+        }
+
+        NmeaPutChar(&Writer, ',');
+        NmeaPutUint(&Writer, NmeaSatelliteId(pNavData->getSatelliteType(index), pNavData->getSatelliteId(index)), 2);
+        NmeaPutChar(&Writer, ',');
+        NmeaPutUint(&Writer, pNavData->getSatelliteElevation(index), 2);
+        NmeaPutChar(&Writer, ',');
+        NmeaPutUint(&Writer, pNavData->getSatelliteAzimuth(index), 3);
+        NmeaPutChar(&Writer, ',');
+        level = lround(pNavData->getSatelliteSignalLevel(index));
+        if (level > 0)
+        {
+          /* Not tracked satellites have an empty SNR. */
+          NmeaPutUint(&Writer, level, 2);
+        }
+        else
+        {
+          /* do nothing. */
+        }
+        cnt++;
+        sat++;
+      }
+
+      written = NmeaEnd(&Writer);
+      if (written == 0)
+      {
+        pBuff[0] = '\0';
+        return 0;
+      }
+      else
+      {
+        length += written;
+      }
+    }
+  }
+
+  if ((length == 0) && (size > 0))
+  {
+    pBuff[0] = '\0';
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return length;
+}
+
+int NmeaBuildZda(char *pBuff, int size, SpNavData *pNavData)
+{
+  NmeaWriter Writer;
+  SpGnssTime *pTime = &pNavData->time;
+
+  /* Set Header. */
+  NmeaBegin(&Writer, pBuff, size, "GPZDA,");
+
+  /* Set time, day, month and year, the local zone is UTC. */
+  NmeaPutTime(&Writer, pTime);
+  NmeaPutChar(&Writer, ',');
+  NmeaPutUint(&Writer, pTime->day, 2);
+  NmeaPutChar(&Writer, ',');
+  NmeaPutUint(&Writer, pTime->month, 2);
+  NmeaPutChar(&Writer, ',');
+  NmeaPutUint(&Writer, pTime->year, 4);
+  NmeaPutString(&Writer, ",00,00");
+
+  return NmeaEnd(&Writer);
+}
+
+int NmeaBuild(char *pBuff, int size, SpNavData *pNavData, unsigned char sentences)
+{
+  int length = 0;
+  unsigned int cnt;
+
+  if (size > 0)
+  {
+    pBuff[0] = '\0';
+  }
+  else
+  {
+    return 0;
+  }
+
+  for (cnt = 0; cnt < sizeof(NmeaList) / sizeof(NmeaList[0]); cnt++)
+  {
+    if ((sentences & NmeaList[cnt].Sentence) != 0)
+    {
+      length += NmeaList[cnt].pBuild(pBuff + length, size - length, pNavData);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  return length;
+}
+
+unsigned char NmeaParseSentence(const char *pList)
+{
+  unsigned char sentences = 0;
+  unsigned int cnt;
+  int pos;
+
+  while (*pList != '\0')
+  {
+    for (cnt = 0; cnt < sizeof(NmeaList) / sizeof(NmeaList[0]); cnt++)
+    {
+      /* Compare the name ignoring case, it must end the token. */
+      for (pos = 0; NmeaList[cnt].pName[pos] != '\0'; pos++)
+      {
+        if (toupper(pList[pos]) != NmeaList[cnt].pName[pos])
+        {
+          break;
+        }
+        else
+        {
+          /* do nothing. */
+        }
+      }
+      if ((NmeaList[cnt].pName[pos] == '\0') && (isalnum(pList[pos]) == 0))
+      {
+        sentences |= NmeaList[cnt].Sentence;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    }
+
+    /* Next token. */
+    while ((*pList != '\0') && (*pList != '+'))
+    {
+      pList++;
+    }
+    while (*pList == '+')
+    {
+      pList++;
+    }
+  }
+
+  return sentences;
+}
+
+int NmeaSentenceName(char *pBuff, int size, unsigned char sentences)
+{
+  int length = 0;
+  unsigned int cnt;
+  int pos;
+
+  for (cnt = 0; cnt < sizeof(NmeaList) / sizeof(NmeaList[0]); cnt++)
+  {
+    if ((sentences & NmeaList[cnt].Sentence) == 0)
+    {
+      continue;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+
+    /* "+" and 3 characters must fit with NUL. */
+    if (length + 5 > size)
+    {
+      break;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    if (length > 0)
+    {
+      pBuff[length++] = '+';
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    for (pos = 0; NmeaList[cnt].pName[pos] != '\0'; pos++)
+    {
+      pBuff[length++] = NmeaList[cnt].pName[pos];
+    }
+  }
+
+  if (size > 0)
+  {
+    pBuff[length] = '\0';
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return length;
+}
+
+#endif /* SUBCORE */
@@ -0,0 +1,126 @@
+/*
+ *  gnss_nmea.h - NMEA sentences
+ *  Copyright 2017 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GNSS_NMEA_H_
+#define _GNSS_NMEA_H_
+
+/**
+ * @file gnss_nmea.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief NMEA sentences
+ * @details Sentences are written straight into the caller's buffer without
+ *          heap, the checksum is updated while each character is written.
+ */
+
+#include <GNSS.h>
+
+/**
+ * @brief Macro definitions
+ */
+#define NMEA_GGA               0x01           /**< Fix data */
+#define NMEA_RMC               0x02           /**< Recommended minimum data */
+#define NMEA_GSA               0x04           /**< DOP and fix mode */
+#define NMEA_GSV               0x08           /**< Satellites in view */
+#define NMEA_ZDA               0x10           /**< Date and time */
+
+#define NMEA_SENTENCE_MAX      83             /**< Longest sentence with CR LF and NUL */
+#define NMEA_OUTPUT_MAX        1280           /**< All sentences of one fix */
+
+/**
+ * @brief Build a GGA sentence.
+ * 
+ * @param [out] pBuff Buffer to write the sentence
+ * @param [in] size Size of pBuff
+ * @param [in] pNavData Navigation data
+ * @return Length without NUL, 0 if it did not fit
+ */
+int NmeaBuildGga(char *pBuff, int size, SpNavData *pNavData);
+
+/**
+ * @brief Build an RMC sentence.
+ * 
+ * @param [out] pBuff Buffer to write the sentence
+ * @param [in] size Size of pBuff
+ * @param [in] pNavData Navigation data
+ * @return Length without NUL, 0 if it did not fit
+ */
+int NmeaBuildRmc(char *pBuff, int size, SpNavData *pNavData);
+
+/**
+ * @brief Build a GSA sentence.
+ * 
+ * @details The receiver does not report which satellites were used for the
+ *          fix, so the satellite ID fields are left empty.
+ * @param [out] pBuff Buffer to write the sentence
+ * @param [in] size Size of pBuff
+ * @param [in] pNavData Navigation data
+ * @return Length without NUL, 0 if it did not fit
+ */
+int NmeaBuildGsa(char *pBuff, int size, SpNavData *pNavData);
+
+/**
+ * @brief Build the GSV sentences, one group per satellite system.
+ * 
+ * @param [out] pBuff Buffer to write the sentences
+ * @param [in] size Size of pBuff
+ * @param [in] pNavData Navigation data
+ * @return Length without NUL, 0 if they did not all fit
+ */
+int NmeaBuildGsv(char *pBuff, int size, SpNavData *pNavData);
+
+/**
+ * @brief Build a ZDA sentence.
+ * 
+ * @param [out] pBuff Buffer to write the sentence
+ * @param [in] size Size of pBuff
+ * @param [in] pNavData Navigation data
+ * @return Length without NUL, 0 if it did not fit
+ */
+int NmeaBuildZda(char *pBuff, int size, SpNavData *pNavData);
+
+/**
+ * @brief Build the selected sentences in the order GGA, RMC, GSA, GSV, ZDA.
+ * 
+ * @param [out] pBuff Buffer to write the sentences
+ * @param [in] size Size of pBuff, NMEA_OUTPUT_MAX holds all of them
+ * @param [in] pNavData Navigation data
+ * @param [in] sentences NMEA_GGA | NMEA_RMC | ...
+ * @return Length without NUL, sentences that did not fit are left out
+ */
+int NmeaBuild(char *pBuff, int size, SpNavData *pNavData, unsigned char sentences);
+
+/**
+ * @brief Parse a sentence list such as "GGA+RMC+ZDA".
+ * 
+ * @param [in] pList Sentence names separated by '+'
+ * @return NMEA_GGA | NMEA_RMC | ..., 0 if no name is known
+ */
+unsigned char NmeaParseSentence(const char *pList);
+
+/**
+ * @brief Write a sentence list such as "GGA+RMC+ZDA".
+ * 
+ * @param [out] pBuff Buffer to write the list
+ * @param [in] size Size of pBuff
+ * @param [in] sentences NMEA_GGA | NMEA_RMC | ...
+ * @return Length without NUL
+ */
+int NmeaSentenceName(char *pBuff, int size, unsigned char sentences);
+
+#endif /* _GNSS_NMEA_H_ */
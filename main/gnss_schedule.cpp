@@ -0,0 +1,175 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file gnss_schedule.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Start GNSS only when the predicted timestamp error needs it.
+ */
+
+#ifndef SUBCORE
+#include "gnss_schedule.h"
+
+/**
+ * @brief private variables
+ */
+static unsigned long Bound = 0;               /**< [us] */
+static boolean Active = false;
+static boolean TimedOut = false;              /**< Last session had no fix */
+static uint64_t StartCount = 0;               /**< Counter at GNSS start [us] */
+static uint64_t StopCount = 0;                /**< Counter at GNSS stop [us] */
+static uint64_t FixCount = 0;                 /**< Counter at the last fix [us] */
+static unsigned long StartError = 0;          /**< Predicted error at GNSS start [us] */
+static uint8_t StartType = eGnssStartHot;     /**< SensorGnssStart */
+static unsigned long SessionTtff = 0;         /**< [ms], 0 until the first fix */
+static unsigned long SessionFixes = 0;
+static long SessionResidual = 0;              /**< Residual at the first fix [us] */
+static unsigned long TtffSum = 0;             /**< [ms] */
+static unsigned long TtffNum = 0;
+static GnssScheduleStat Stat = {};
+
+/**
+ * @brief Get the expected time to fix.
+ * 
+ * @return [ms]
+ */
+static unsigned long ExpectedTtff(void)
+{
+  return (TtffNum != 0) ? (TtffSum / TtffNum) : GNSS_TTFF_MS;
+}
+
+void GnssScheduleBegin(unsigned long bound_us)
+{
+  Bound = bound_us;
+  Active = false;
+  TimedOut = false;
+  StartCount = 0;
+  StopCount = 0;
+  FixCount = 0;
+  TtffSum = 0;
+  TtffNum = 0;
+  memset(&Stat, 0, sizeof(Stat));
+}
+
+boolean GnssScheduleDue(uint64_t count_us)
+{
+  uint64_t ttff_us = (uint64_t)ExpectedTtff() * 1000;
+
+  if (Active == true)
+  {
+    return false;
+  }
+  else if (TimedOut == true)
+  {
+    /* No sky, try again later. */
+    return (count_us - StopCount) >= (uint64_t)GNSS_RETRY_MS * 1000;
+  }
+  else if ((count_us - StopCount) < (uint64_t)GNSS_SLEEP_MIN_MS * 1000)
+  {
+    return false;
+  }
+  else if ((GNSS_HOT_WINDOW_MS != 0) && ((count_us - FixCount + ttff_us) >= (uint64_t)GNSS_HOT_WINDOW_MS * 1000))
+  {
+    /* Keep the ephemeris fresh enough for a hot start. */
+    return true;
+  }
+  else
+  {
+    /* The error keeps growing until the fix, look ahead by the time to fix. */
+    return TimebaseError(count_us + ttff_us) >= Bound;
+  }
+}
+
+void GnssScheduleStart(uint64_t count_us, uint8_t start)
+{
+  Active = true;
+  StartCount = count_us;
+  StartType = start;
+  StartError = TimebaseError(count_us);
+  SessionTtff = 0;
+  SessionFixes = 0;
+  SessionResidual = 0;
+  Stat.sessions += 1;
+}
+
+void GnssScheduleFix(uint64_t count_us, long residual_us)
+{
+  if (SessionFixes == 0)
+  {
+    SessionTtff = (unsigned long)((count_us - StartCount) / 1000);
+    SessionResidual = residual_us;
+    TtffSum += SessionTtff;
+    TtffNum += 1;
+    Stat.ttff_ms = TtffSum / TtffNum;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  SessionFixes += 1;
+  FixCount = count_us;
+}
+
+boolean GnssScheduleTimeout(uint64_t count_us)
+{
+  return (Active == true) && (SessionFixes == 0) &&
+         ((count_us - StartCount) >= (uint64_t)GNSS_TIMEOUT_MS * 1000);
+}
+
+void GnssScheduleStop(uint64_t count_us, unsigned long seq, SensorBinGnss *pSession)
+{
+  unsigned long on_ms = (unsigned long)((count_us - StartCount) / 1000);
+
+  Active = false;
+  TimedOut = (SessionFixes == 0);
+  StopCount = count_us;
+
+  Stat.on_ms += on_ms;
+  Stat.energy_mj += on_ms * GNSS_POWER_MW / 1000;
+  if (TimedOut == true)
+  {
+    Stat.timeouts += 1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pSession->seq = seq;
+  pSession->ttff_ms = SessionTtff;
+  pSession->on_ms = on_ms;
+  pSession->fixes = (SessionFixes > 0xFFFF) ? 0xFFFF : SessionFixes;
+  pSession->result = (TimedOut == true) ? eGnssTimeout : eGnssFixed;
+  pSession->start = StartType;
+  pSession->error_us = (StartError > INT32_MAX) ? INT32_MAX : (int32_t)StartError;
+  pSession->residual_us = SessionResidual;
+  pSession->energy_mj = on_ms * GNSS_POWER_MW / 1000;
+}
+
+void GnssScheduleGetStat(GnssScheduleStat *pStat)
+{
+  *pStat = Stat;
+}
+
+#endif /* SUBCORE */
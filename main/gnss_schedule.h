@@ -0,0 +1,120 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _GNSS_SCHEDULE_H_
+#define _GNSS_SCHEDULE_H_
+
+/**
+ * @file gnss_schedule.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Start GNSS only when the predicted timestamp error needs it.
+ * @details The timebase predicts how far the timestamps have drifted since
+ *          the last fix. GNSS is started when that error, at the end of the
+ *          expected time to fix, reaches the configured bound, and at the
+ *          latest before the hot start window closes. Each session is
+ *          measured (time to fix, on time, energy) for the sensor log.
+ */
+
+#include <stdint.h>
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define GNSS_SLEEP_MIN_MS      60000          /**< [ms] Shortest sleep between sessions */
+#define GNSS_HOT_WINDOW_MS     7200000        /**< [ms] Longest sleep that still allows a hot start, 0 for none */
+#define GNSS_TIMEOUT_MS        300000         /**< [ms] Session without a fix gives up */
+#define GNSS_RETRY_MS          600000         /**< [ms] Sleep after a session without a fix */
+#define GNSS_TTFF_MS           3000           /**< [ms] Expected time to fix before one is measured */
+#define GNSS_POWER_MW          30             /**< [mW] Estimated extra power while GNSS runs */
+
+/**
+ * @struct GnssScheduleStat
+ * @brief Counters of all sessions
+ */
+typedef struct
+{
+  unsigned long sessions;     /**< GNSS starts */
+  unsigned long timeouts;     /**< Sessions without a fix */
+  unsigned long on_ms;        /**< Total GNSS on time [ms] */
+  unsigned long energy_mj;    /**< Total estimated GNSS energy [mJ] */
+  unsigned long ttff_ms;      /**< Average time to fix [ms] */
+} GnssScheduleStat;
+
+/**
+ * @brief Start scheduling.
+ * 
+ * @param [in] bound_us Timestamp error that wakes GNSS [us]
+ */
+void GnssScheduleBegin(unsigned long bound_us);
+
+/**
+ * @brief Check whether GNSS should be started.
+ * 
+ * @param [in] count_us Timebase counter [us]
+ * @return true if GNSS should be started now
+ */
+boolean GnssScheduleDue(uint64_t count_us);
+
+/**
+ * @brief Record a GNSS start.
+ * 
+ * @param [in] count_us Timebase counter [us]
+ * @param [in] start SensorGnssStart
+ */
+void GnssScheduleStart(uint64_t count_us, uint8_t start);
+
+/**
+ * @brief Record a GNSS fix of the running session.
+ * 
+ * @param [in] count_us Timebase counter [us]
+ * @param [in] residual_us Timestamp minus GNSS time before the fix [us]
+ */
+void GnssScheduleFix(uint64_t count_us, long residual_us);
+
+/**
+ * @brief Check whether the running session should give up.
+ * 
+ * @param [in] count_us Timebase counter [us]
+ * @return true if the session has run GNSS_TIMEOUT_MS without a fix
+ */
+boolean GnssScheduleTimeout(uint64_t count_us);
+
+/**
+ * @brief Record a GNSS stop.
+ * 
+ * @param [in] count_us Timebase counter [us]
+ * @param [in] seq Sequence number of the next sample
+ * @param [out] pSession The finished session
+ */
+void GnssScheduleStop(uint64_t count_us, unsigned long seq, SensorBinGnss *pSession);
+
+/**
+ * @brief Get the counters of all sessions.
+ * 
+ * @param [out] pStat Counters
+ */
+void GnssScheduleGetStat(GnssScheduleStat *pStat);
+
+#endif /* _GNSS_SCHEDULE_H_ */
@@ -35,18 +35,34 @@ SOFTWARE.
 /**
  * @brief Includes <System Includes> , "Project Includes"
  */
+#include <Arduino.h>
+#include "sensor_format.h"
+#include "sensor_binary.h"
+#include "sensor_codec.h"
+#include "sensor_ring.h"
+#include "sensor_offload.h"
+#ifndef SUBCORE
 #include <GNSS.h>
 #include <GNSSPositionData.h>
 #include <Wire.h>
-#include <Arduino.h>
 #include <RTC.h>
 #include <LowPower.h>
 #include <Watchdog.h>
 #include <SDHCI.h>
-#include <GNSS.h>
 #include "SDHC_file.h"
 #include "KX122.h"
 #include "BM1383AGLV.h"
+#include "sensor_queue.h"
+#include "timebase.h"
+#include "gnss_schedule.h"
+#include "gnss_backup.h"
+#include "gnss_nmea.h"
+#include "console.h"
+#include "tick.h"
+#include "power.h"
+#include "activity.h"
+#include "burst.h"
+#endif /* SUBCORE */
 
 /**
  * @brief Macro definitions
@@ -54,8 +70,11 @@ SOFTWARE.
 /* Output settings */
 #define NMEA_OUT_UART          0              /** true 1, false 0 */
 #define NMEA_OUT_FILE          0              /** true 1, false 0 */
+#define NMEA_OUT_SENTENCE      NMEA_GGA       /** NMEA_GGA | NMEA_RMC | NMEA_GSA | NMEA_GSV | NMEA_ZDA */
 #define SENSOR_OUT_UART        0              /** true 1, false 0 */
 #define SENSOR_OUT_FILE        1              /** true 1, false 0 */
+#define SENSOR_OUT_JITTER      1              /** true 1, false 0, interrupt sampling only */
+#define SENSOR_OUT_FORMAT      eFormatCsv     /** SensorFormat */
 
 #define UART_DEBUG_MESSAGE     PrintNone
 #define CONFIG_FILE_NAME       "tracker.ini"  /**< Config file name */
@@ -69,18 +88,70 @@ SOFTWARE.
 #define SENSOR_BUFFER_SIZE     128            /**< SENSOR buffer size */
 #define OUTPUT_FILENAME_LEN    20             /**< Output file name length. */
 
+/* Record settings */
+#define DEVICE_ID              0x0001         /**< Device number in each record, DeviceId in the ini file. */
+
 /* Communication settings */
 #define SERIAL_BAUDRATE        115200         /**< Serial baud rate. */
 #define SEPARATOR              0x0A           /**< Separator */
 
+/* Acceleration settings */
+#define SENSOR_ACC_RATE        KX122_ODCNTL_OSA_50HZ /**< Output data rate, sets the sensor interval. */
+#define SENSOR_ACC_RANGE       KX122_CNTL1_GSEL_4G   /**< Acceleration range. */
+
+/* Sampling trigger settings */
+#define SENSOR_TRIGGER         eTriggerPoll   /** SensorTrigger */
+#define SENSOR_DRDY_PIN        PIN_D02        /**< Pin wired to KX122 INT1. */
+#define SENSOR_USE_BUFFER      (SENSOR_FIFO_MODE || (SENSOR_TRIGGER == eTriggerDrdy))
+
+/* Pressure settings */
+#define SENSOR_PRESS_INTERVAL  1000           /**< [ms] */
+#define SENSOR_PRESS_AVERAGE   BM1383AGLV_MODE_CONTROL_AVE_NUM64 /**< Averaging in the barometer. */
+
 /* Interval settings */
-#define SENSOR_INTERVAL        20             /**< [ms] */
-#define STORE_RECORDS_NUM      1              /**< Allocation size of SD should be larger than CSV size. */
-                                              /**< Confirmed to operate at 50 Hz with class 10 SD. */
-                                              /**< Different speed in your environment.*/
-#define FILE_INTERVAL          1800000        /**< [ms] */
+#define STORE_RECORDS_NUM      1              /**< Records collected before they are passed to the SD writer, StoreRecords in the ini file. */
+#define STORE_RECORDS_MAX      16             /**< Largest StoreRecords, sets the size of the record buffer. */
+#define FILE_INTERVAL          1800000        /**< [ms] New file interval, FileInterval [min] in the ini file. */
+#define SENSOR_FILE_PREALLOCATE 1             /** true 1, false 0 : reserve the sensor file when it is opened */
+#define SENSOR_FILE_CSV_SIZE   84             /**< [byte] Expected CSV record, for preallocation */
+#define SENSOR_FILE_BIN_SIZE   14             /**< [byte] Expected binary sample, for preallocation */
+#define SENSOR_OFFLOAD         1              /** true 1, false 0 : encode the sensor file outside of the loop */
+#define SENSOR_OFFLOAD_CORE    1              /**< SubCore that runs the encoder, 0 for a thread on the main core */
+#define SENSOR_RING_POLICY     eRingDropNewest /** SensorRingPolicy : sample dropped when the encoder falls behind */
 #define GPS_INTERVAL           1000           /**< [ms] */
-#define SENSORBUFF             STORE_RECORDS_NUM * STRING_BUFFER_SIZE + STRING_BUFFER_SIZE
+#define ALIVE_INTERVAL         1000           /**< [ms] LED0 blink interval. */
+#define CONSOLE_INTERVAL       50             /**< [ms] Console input check interval. */
+#define TICK_IDLE              1              /** true 1, false 0 : sleep until the next task while recording */
+
+/* Time correction settings */
+#define GNSS_CONTINUOUS        1              /** true 1, false 0 : keep sampling while GNSS corrects the time */
+#define GNSS_TOLERANCE_US      2000           /**< [us] Smaller residuals of the time fit end the correction. */
+#define GNSS_ERROR_BOUND       10             /**< [ms] Predicted timestamp error that starts GNSS, GNSS_CONTINUOUS only */
+
+/* Position track settings */
+#define TRACK_INTERVAL         10             /**< [min] Position fix record interval, 0 off */
+#define TRACK_WAIT_MS          60000          /**< [ms] Longest GNSS session kept on for a position fix */
+
+/* Activity summary settings */
+#define ACTIVITY_WINDOW        0              /**< [s] Activity summary window, ActivityWindow in the ini file, 0 off */
+
+/* Burst capture settings */
+#define BURST_TRIGGER          eBurstOff      /** BurstSource : BurstTrigger in the ini file */
+#define BURST_RATE             KX122_ODCNTL_OSA_400HZ /**< Burst output data rate, BurstRate in the ini file */
+#define BURST_THRESHOLD        1000           /**< [mG] Dynamic acceleration that starts a burst, BurstThreshold in the ini file */
+#define BURST_PRE              500            /**< [ms] Samples kept before the trigger, BurstPre in the ini file */
+#define BURST_POST             2000           /**< [ms] Samples kept after the trigger, BurstPost in the ini file */
+#define BURST_INTERVAL         100            /**< [ms] Burst read out and wake-up check interval. */
+#define BURST_OUT_MAX          512            /**< Max burst samples read out per interval. */
+#define BURST_WUF_COUNT        1              /**< [10 ms] Wake-up engine debounce */
+
+#define SENSORBUFF             STORE_RECORDS_MAX * STRING_BUFFER_SIZE + SENSOR_CODEC_BLOCK_MAX
+
+/* KX122 buffer settings */
+#define SENSOR_FIFO_MODE       0              /** true 1, false 0 */
+#define SENSOR_FIFO_INTERVAL   250            /**< [ms] Buffer drain interval. */
+#define SENSOR_FIFO_NUM        128            /**< Max samples per drain. */
+#define SENSOR_FIFO_THRESHOLD  32             /**< Buffer watermark [samples]. */
 
 
 /* GNSS CONFIG */
@@ -122,6 +193,29 @@ enum ParamSat
   eSatGpsQz1cQz1S,    /**< GPS+QZSS_L1CA+QZSS_L1S */
 };
 
+/**
+ * @enum SensorFormat
+ * @brief Sensor file format
+ */
+enum SensorFormat
+{
+  eFormatCsv,         /**< CSV text, SENSOR%08d.CSV */
+  eFormatBinary,      /**< Binary raw counts, SENSOR%08d.BIN */
+  eFormatCompressed,  /**< Binary delta coded counts, SENSOR%08d.BIN */
+};
+
+/**
+ * @enum SensorTrigger
+ * @brief Acceleration sampling trigger
+ */
+enum SensorTrigger
+{
+  eTriggerPoll,       /**< Poll millis() in loop() */
+  eTriggerDrdy,       /**< KX122 data ready interrupt, samples from the KX122 buffer */
+  eTriggerTimer,      /**< Timer interrupt at the output data rate */
+};
+
+#ifndef SUBCORE
 /**
  * @struct ConfigParam
  * @brief Configuration parameters
@@ -131,13 +225,30 @@ typedef struct
   ParamSat      SatelliteSystem;  /**< Satellite system(GPS/GLONASS/ALL). */
   boolean       NmeaOutUart;      /**< Output NMEA message to UART(TRUE/FALSE). */
   boolean       NmeaOutFile;      /**< Output NMEA message to file(TRUE/FALSE). */
+  unsigned char NmeaSentence;     /**< NMEA sentences to output(GGA+RMC+GSA+GSV+ZDA). */
   boolean       SensorOutUart;    /**< Output Sensor message to UART(TRUE/FALSE). */
   boolean       SensorOutFile;    /**< Output Sensor message to file(TRUE/FALSE). */
+  SensorFormat  SensorOutFormat;  /**< Sensor file format(CSV/BINARY/COMPRESSED). */
   boolean       PramOutUart;      /**< Output Param message to UART(TRUE/FALSE). */
   boolean       PramOutFile;      /**< Output Param message to file(TRUE/FALSE). */
   unsigned int  IntervalSec;      /**< Positioning interval sec(1-300). */
+  unsigned char AccRate;          /**< Acceleration output data rate(KX122_ODCNTL_OSA_xxx). */
+  unsigned char AccRange;         /**< Acceleration range(KX122_CNTL1_GSEL_xxx). */
+  unsigned long PressInterval;    /**< Pressure interval ms(100-60000). */
+  unsigned long TimeErrorBound;   /**< Timestamp error that starts GNSS ms(1-1000). */
+  unsigned long TrackInterval;    /**< Position fix record interval min(0-1440), 0 off. */
+  unsigned long ActivityWindow;   /**< Activity summary window sec(0-600), 0 off. */
+  BurstSource   BurstTrigger;     /**< Burst trigger(OFF/DBA/WAKEUP). */
+  unsigned char BurstRate;        /**< Burst output data rate(KX122_ODCNTL_OSA_xxx). */
+  unsigned long BurstThreshold;   /**< Burst trigger threshold mG(50-8000). */
+  unsigned long BurstPre;         /**< Burst samples before the trigger ms(0-5000). */
+  unsigned long BurstPost;        /**< Burst samples after the trigger ms(10-10000). */
+  unsigned long FileInterval;     /**< New file interval min(1-1440). */
+  unsigned char StoreRecords;     /**< Records collected before they are written(1-STORE_RECORDS_MAX). */
+  unsigned short DeviceId;        /**< Device number in each record(0x0000-0xFFFF). */
   SpPrintLevel  UartDebugMessage; /**< Uart debug message(NONE/ERROR/WARNING/INFO). */
 } ConfigParam;
+#endif /* SUBCORE */
 
 /**
  * @brief Exported global variables
@@ -34,6 +34,20 @@ SOFTWARE.
  */
 #include "main.h"
 
+#ifdef SUBCORE
+/**
+ * @brief The same sketch built for SubCore SENSOR_OFFLOAD_CORE runs the encoder.
+ */
+void setup(void)
+{
+  SensorOffloadSubCore();
+}
+
+void loop(void)
+{
+}
+#else
+
 /**
  * @brief gloval variables
  */
@@ -48,45 +62,143 @@ unsigned long write_size = 0;
 volatile static char rc = 0;/* flag */
 volatile static char IndexData[INDEX_FILE_SIZE] = {};
 volatile static char FileNmeaTxt[OUTPUT_FILENAME_LEN] = {};   /**< Output file name */
+volatile static boolean NmeaFileOpen = false;                  /**< NMEA file of this interval is open */
+volatile static unsigned long NmeaOpenErrors = 0;              /**< Failed opens of the NMEA file */
 volatile static char FileSensorTxt[OUTPUT_FILENAME_LEN] = {}; /**< Output file name */
+volatile static char FileSummaryTxt[OUTPUT_FILENAME_LEN] = {}; /**< Output file name */
+volatile static boolean SummaryFileOpen = false;               /**< Activity summary file of this interval is open */
+static ActivityWindow Activity;                               /**< activity window under construction */
+volatile static char FileBurstTxt[OUTPUT_FILENAME_LEN] = {};   /**< Output file name */
+volatile static boolean BurstFileOpen = false;                 /**< Burst file of this interval is open */
+static char FileSensorOpen[OUTPUT_FILENAME_LEN] = {};         /**< Sensor file the SD writer has open */
+volatile static uint32_t SensorFileQueued = 0;                /**< SensorOffloadStart number of the file being encoded */
+volatile static uint32_t SensorFileWritten = 0;               /**< SensorOffloadStart number of the file the SD writer has open */
+static SensorBinBurst BurstRecord;                            /**< burst record under construction */
 volatile static word led = 0;
 volatile static word TimefixFlag = 0;
+volatile static bool TimeValid = false;                        /**< RTC was set from GNSS once */
+volatile static bool GnssActive = false;                       /**< GNSS runs while sensors are sampled */
+volatile static unsigned char GnssStart = eGnssStartBoot;      /**< SensorGnssStart of the next blocking GNSS start */
 volatile static word state_last = eStateIdle;
-volatile static int diff = 0;
 volatile static int FileCount = 0;
 volatile static int ReadSize = 0;
 volatile static unsigned long seq = 0;                        /**< sequence no    */
 volatile static unsigned long time_current = 0;               /**< to get current */
-volatile static unsigned long time_past_alive = 0;
-volatile static unsigned long time_past_file = 0;
 volatile static unsigned long time_past_gps = 0;              /**< to update gps  */
 volatile static unsigned long time_past_sensor = 0;           /**< to update buff */
-volatile static unsigned long time_interval_alive = 0;
-volatile static unsigned long time_interval_file = 0;
 volatile static unsigned long time_interval_gps = 0;          /**< to update gps  */
 volatile static unsigned long time_interval_sensor = 0;       /**< to update buff */
-volatile static unsigned long BuffSize = 0;
+volatile static unsigned long press_latest = 0;               /**< most recent pressure [counts] */
+volatile static unsigned long time_last_sample_us = 0;        /**< previous interrupt sample time [us] */
+volatile static unsigned long sensor_period_us = 0;           /**< sample period of the accelerometer [us] */
+volatile static unsigned long record_period_us = 0;           /**< record period of the sensor file [us] */
+volatile static unsigned long SampleDecimate = 1;             /**< accelerometer samples per record */
+volatile static unsigned long DecimateNum = 0;                /**< samples averaged into the next record */
+volatile static long DecimateSum[3] = {};                     /**< sum of the averaged samples [counts] */
+volatile static unsigned long DecimateInterval_us = 0;        /**< sum of the averaged sample intervals [us] */
+volatile static unsigned long long DecimateFirst_us = 0;      /**< counter of the first averaged sample */
 volatile static SpNavData NavData = {};
+volatile static unsigned long long GnssBegin_us = 0;          /**< counter when background GNSS started */
+volatile static unsigned long long TrackLast_us = 0;          /**< counter of the last position fix record */
+volatile static boolean TrackValid = false;                   /**< a position fix was recorded since boot */
 volatile static char SensorBuff[SENSORBUFF] = {};
+volatile static int SensorBuffLen = 0;
+static SensorBinBlock SensorBlock;                            /**< binary block under construction */
+static SensorCodecBlock SensorDelta;                          /**< delta block under construction */
 volatile static int records_num = 0;
+volatile static unsigned long SampleTotal = 0;                /**< records made since boot */
+volatile static unsigned long LoopLast_us = 0;                /**< micros() at the last loop */
+volatile static unsigned long LoopNum = 0;                    /**< loops measured since the last report */
+volatile static unsigned long long LoopSum_us = 0;            /**< time of the measured loops [us] */
+volatile static unsigned long LoopMin_us = 0;                 /**< shortest measured loop [us] */
+volatile static unsigned long LoopMax_us = 0;                 /**< longest measured loop [us] */
+volatile static boolean BenchRunning = false;                 /**< a benchmark started by the console runs */
+volatile static unsigned long BenchBegin_ms = 0;              /**< millis() when the benchmark started */
+volatile static unsigned long BenchTime_ms = 0;               /**< length of the benchmark [ms] */
+volatile static unsigned long BenchSamples = 0;               /**< SampleTotal when the benchmark started */
+volatile static unsigned long BenchQueueDropped = 0;          /**< SensorQueueDropped when the benchmark started */
+volatile static unsigned long BenchRingDropped = 0;           /**< Samples dropped by the sensor ring when the benchmark started */
+volatile static unsigned long SensorTickMissed = 0;           /**< timer ticks queued behind a newer one, no sample read */
+static SdStreamStat BenchSd;                                  /**< SD counters when the benchmark started */
+static int TaskAlive = -1;                                    /**< tick task blinking LED0 */
+static int TaskFile = -1;                                     /**< tick task starting a new file */
+static int TaskConsole = -1;                                  /**< tick task reading the console */
+static int TaskPress = -1;                                    /**< tick task reading the barometer */
+static int TaskSensor = -1;                                   /**< tick task making sensor records */
+static int TaskBurst = -1;                                    /**< tick task writing burst samples */
 
 /**
  * @brief global APIs
  */
-String getNmeaGga(SpNavData* pNavData);
 void SetupPositioning(void);
 void Led_isState(void);
+boolean RequestRenewFile(void);
+void ReportPerformance(void);
+boolean StartBenchmark(unsigned long sec);
 
 /**
  * @brief private APIs
  */
 static void Led_isAlive(void);
-static void Led_AliveBlink(void);
 static void UpdateFileNumber(void);
-static String getSensor(void);
+static void NextFileNumber(void);
+static void MakeFileNames(void);
+static void WriteFileNumber(void);
+static void getSensor(SensorRecord *pRecord, const signed short *acc, unsigned long interval_us, unsigned long long count_us);
+static void AcceptSample(const signed short *acc, unsigned long interval_us, unsigned long long count_us);
+static void OutputSensor(const SensorRecord *pRecord);
+static void OutputJitter(const SensorBinJitter *pJitter);
+static void OutputActivity(const ActivityRecord *pActivity);
+static void StoreSensor(const char *pRecord, int length);
+static void WriteSensorBuff(void);
+static void WriteOffload(boolean wait);
+static unsigned long SensorFileReserve(void);
+static void StartSensorFile(void);
+static void FlushSensorFile(void);
+static void FinishSensorFile(void);
+static void ReportSensorFile(boolean closed);
+static void ReportOffloadFile(const char *pName, unsigned long bytes, uint32_t crc);
+static void SwitchSensorFile(void);
+static void RotateFiles(void);
+static void ReportNmeaFile(void);
+static void ReportTimebase(void);
 static void GpsProcessing(void);
+static void OutputNmea(void);
+static bool CorrectTime(const SpGnssTime *pTime, unsigned long long count_us, SensorBinTime *pEvent);
+static void OutputTime(const SensorBinTime *pTime);
+static void OutputGnss(const SensorBinGnss *pGnss);
+static bool TrackDue(unsigned long long count_us);
+static void OutputTrack(const SpNavData *pNavData, unsigned long long count_us);
+static void OpenSensorFile(void);
+static void OpenSummaryFile(void);
+static void FinishSummaryFile(void);
+static void CloseSummaryFile(void);
+static void ReportSummaryFile(void);
+static void OpenBurstFile(void);
+static void FinishBurstFile(void);
+static void CloseBurstFile(void);
+static void ReportBurstFile(void);
+static void BurstProcessing(void);
+static void OutputBurst(void);
+static void GnssBackgroundBegin(void);
+static void GnssBackgroundEnd(void);
+static void GnssBackgroundProcessing(void);
 static void SensorProcessing(void);
+static void PressureProcessing(void);
+static void SensorQueueProcessing(void);
+static void SensorDrdyHandler(void);
+static unsigned int SensorTimerHandler(void);
+static void SensorTriggerBegin(void);
+static void SensorTriggerEnd(void);
 static void CheckFileRenew(void);
+static void CommandProcessing(void);
+static void UpdateTickPeriod(void);
+static void ReportTick(void);
+static void ReportPower(void);
+static void TickIdle(void);
+static void MeasureLoop(void);
+static void ReportLoop(void);
+static void CheckBenchmark(void);
 static KX122 kx122(KX122_DEVICE_ADDRESS_1F); /**< acceleration */
 static BM1383AGLV bm1383aglv;                /**< barometor */
 
@@ -119,28 +231,49 @@ static void Led_isAlive(void)
   }
 }
 
-static void Led_AliveBlink(void)
+/**
+ * @brief Start a new file, run every FileInterval.
+ */
+static void CheckFileRenew(void)
 {
-  time_interval_alive = time_current - time_past_alive;
-  if(time_interval_alive >= 1000)
-  {
-    time_past_alive = time_current;
-    Led_isAlive();
-  }
-  else
-  {
-    /* do nothing. */
-  }
+  /* RENEW FILE */
+  state = eStateRenewFile;
 }
 
-static void CheckFileRenew(void)
+/**
+ * @brief Run the console commands, run every CONSOLE_INTERVAL.
+ */
+static void CommandProcessing(void)
 {
-  /* RENEW FILE */
-  time_interval_file = time_current - time_past_file;
-  if(time_interval_file >= FILE_INTERVAL)
+  ConsoleProcessing();
+  CheckBenchmark();
+}
+
+/**
+ * @brief Follow the intervals changed from the console.
+ */
+static void UpdateTickPeriod(void)
+{
+  TickSetPeriod(TaskFile, Parameter.FileInterval * 60000000ULL);
+  TickSetPeriod(TaskPress, Parameter.PressInterval * 1000ULL);
+}
+
+/**
+ * @brief Sleep until the next tick task is due.
+ * 
+ * @details Only while recording without GNSS. GNSS fixes are polled at
+ *          each pass, so the counter is read as soon as a fix arrives.
+ */
+static void TickIdle(void)
+{
+  uint64_t next_us = TickNext();
+  uint64_t count_us = TimebaseNow();
+
+  if ((TICK_IDLE) && (state == eStateSensor) && (GnssActive == false) &&
+      (next_us != TICK_NONE) && (next_us >= count_us + 1000))
   {
-    time_past_file = time_current;
-    state = eStateRenewFile;
+    /* Wake up early by less than 1 ms and wait for the deadline by polling. */
+    PowerIdle((unsigned long)((next_us - count_us) / 1000));
   }
   else
   {
@@ -159,7 +292,11 @@ static void UpdateFileNumber(void)
   ReadSize = 0;
   IndexData[INDEX_FILE_SIZE] = {};
   FileNmeaTxt[0] = 0;
+  NmeaFileOpen = false;
+  NmeaOpenErrors = 0;
   FileSensorTxt[0] = 0;
+  FileSummaryTxt[0] = 0;
+  FileBurstTxt[0] = 0;
   seq = 0;
 
   /* Open index file. */
@@ -179,9 +316,39 @@ static void UpdateFileNumber(void)
   }
 
   /* Update index.txt */
-  snprintf(IndexData, sizeof(IndexData), "%08d", FileCount);
-  write_size = WriteChar(IndexData, INDEX_FILE_NAME, FILE_WRITE);
-  if (write_size != strlen(IndexData))
+  snprintf((char*)IndexData, sizeof(IndexData), "%08d", FileCount);
+  WriteFileNumber();
+  MakeFileNames();
+}
+
+/**
+ * @brief Move to the next file number while sampling.
+ * 
+ * @details The card is not touched, the sensor file writer rewrites the
+ *          index file when it switches files, see SwitchSensorFile.
+ */
+static void NextFileNumber(void)
+{
+  FileNmeaTxt[0] = 0;
+  NmeaFileOpen = false;
+  NmeaOpenErrors = 0;
+  FileSensorTxt[0] = 0;
+  FileSummaryTxt[0] = 0;
+  FileBurstTxt[0] = 0;
+  seq = 0;
+
+  FileCount++;
+  snprintf((char*)IndexData, sizeof(IndexData), "%08d", FileCount);
+  MakeFileNames();
+}
+
+/**
+ * @brief Write the file number to the index file.
+ */
+static void WriteFileNumber(void)
+{
+  write_size = WriteChar((const char*)IndexData, INDEX_FILE_NAME, FILE_WRITE);
+  if (write_size != strlen((const char*)IndexData))
   {
     state = eStateWriteError;
   }
@@ -189,7 +356,13 @@ static void UpdateFileNumber(void)
   {
     /* do nothing. */
   }
+}
 
+/**
+ * @brief Make the output file names of FileCount.
+ */
+static void MakeFileNames(void)
+{
   if (Parameter.NmeaOutFile == true)
   {
     /* Create a file name to store NMEA data. */
@@ -203,7 +376,29 @@ static void UpdateFileNumber(void)
   if (Parameter.SensorOutFile == true)
   {
     /* Create a file name to store SENSOR data. */
-    snprintf(FileSensorTxt, sizeof(FileSensorTxt), "SENSOR%08d.CSV", FileCount);
+    snprintf(FileSensorTxt, sizeof(FileSensorTxt), "SENSOR%08d.%s", FileCount,
+             (Parameter.SensorOutFormat == eFormatCsv) ? "CSV" : "BIN");
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.ActivityWindow != 0)
+  {
+    /* Create a file name to store the activity summary. */
+    snprintf(FileSummaryTxt, sizeof(FileSummaryTxt), "SUMMARY%08d.CSV", FileCount);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.BurstTrigger != eBurstOff)
+  {
+    /* Create a file name to store the bursts, in the sensor file format. */
+    snprintf(FileBurstTxt, sizeof(FileBurstTxt), "BURST%08d.%s", FileCount,
+             (Parameter.SensorOutFormat == eFormatCsv) ? "CSV" : "BIN");
   }
   else
   {
@@ -213,9 +408,8 @@ static void UpdateFileNumber(void)
 
 static void GpsProcessing(void)
 {
-  diff = 0;
-  static char *pNmeaBuff     = NULL;
-  String NmeaString = "";
+  SensorBinTime Event;
+  unsigned long long count_us;
 
   /* GPS PROCESSING. */
   time_interval_gps = time_current - time_past_gps;
@@ -223,124 +417,29 @@ static void GpsProcessing(void)
   {
     time_past_gps = time_current; /*timer set.*/
     
-    /* Get NavData. */
-    Gnss.getNavData(&NavData);
-    SpGnssTime *time = &NavData.time;
-  
     /* check if time update */
-    if(Gnss.waitUpdate() && (NavData.posFixMode >= 1) && (time->year >= 2000))
+    if(Gnss.waitUpdate())
     {
-      /* If device can get the value of gps correctlv. */
-      /* Check if the acquired UTC time is accurate. */
-      /* get and evacuation RTC time to "now" */
-      RtcTime now = RTC.getTime();
-    
-      /* Convert SpGnssTime to RtcTime */
-      RtcTime gps(time->year, time->month, time->day, time->hour, time->minute, time->sec, time->usec * 1000);
-  
-      gps += MY_TIMEZONE_IN_SECONDS;
-  
-      /* Set the time difference */
-      diff = now - gps;
-      if (abs(diff) >= 1)
-      {
-        /* set GPS time to RTC. */
-        RTC.setTime(gps);
-      }
-      else
-      {
-        /* Judged that time was corrected. */
-        TimefixFlag = 1;
-      }
-  
-      /* Get Nmea Data. */
-      NmeaString = getNmeaGga(&NavData);
-  
-      if (strlen(NmeaString.c_str()) == 0)
-      {
-        state = eStateError;
-        Led_isState();
-      }
-      else
-      {
-        /* Output Nmea Data. */
-        if (Parameter.NmeaOutUart == true)
-        {
-          /* To Uart. */
-          Serial.print(NmeaString.c_str());
-        }
-        else
-        {
-          /* do nothing. */
-        }
-      }
-  
-      if (Parameter.NmeaOutFile == true)
+      /* Counter at the fix, before anything else delays it. */
+      count_us = TimebaseNow();
+
+      /* Get NavData. */
+      Gnss.getNavData(&NavData);
+      if ((NavData.posFixMode >= 1) && (NavData.time.year >= 2000))
       {
-        /* To SDCard. */
-        BuffSize = NMEA_BUFFER_SIZE * 4;
-  
-        if (pNmeaBuff == NULL)
-        {
-          /* Alloc buffer. */
-          pNmeaBuff = (char*)malloc(BuffSize);
-          if (pNmeaBuff != NULL)
-          {
-            /* Clear Buffer */
-            pNmeaBuff[0] = 0x00;
-          }
-          else
-          {
-            /* do nothing. */
-          }
-        }
-        else
-        {
-          /* do nothing. */
-        }
-  
-        if (pNmeaBuff != NULL)
-        {
-          /* Store Nmea Data to buffer. */
-          strncat(pNmeaBuff, NmeaString.c_str(), BuffSize);
-        }
-        else
-        {
-          /* do nothing. */
-        }
-  
-        /* Check Sensor buffer. */
-        if(strlen(pNmeaBuff) > (BuffSize - NMEA_BUFFER_SIZE))
-        {
-          state = eStateError;
-          Led_isState();
-        }
-        else
-        {
-          /* do nothing. */
-        }
-      
-        if (pNmeaBuff != NULL)
+        /* No sensor file is open, the first fix is in its header. */
+        if (CorrectTime(&NavData.time, count_us, &Event) == true)
         {
-          /* Write Nmea Data. */
-          write_size = WriteChar(pNmeaBuff, FileNmeaTxt, (FILE_WRITE | O_APPEND));
-          /* Check result. */
-          if (write_size != strlen(pNmeaBuff))
-          {
-            while(1);
-          }
-          else
-          {
-            /* do nothing. */
-          }
-      
-          /* Clear Buffer */
-          pNmeaBuff[0] = 0x00;
+          /* Judged that time was corrected. */
+          TimefixFlag = 1;
         }
         else
         {
           /* do nothing. */
         }
+        GnssScheduleFix(count_us, Event.offset_us);
+
+        OutputNmea();
       }
       else
       {
@@ -358,264 +457,2284 @@ static void GpsProcessing(void)
   }
 }
 
-static void SensorProcessing(void)
+/**
+ * @brief Output the selected NMEA sentences of the latest navigation data.
+ */
+static void OutputNmea(void)
 {
-  String SensorString = "";
-  static int records_num = 0;
+  static char NmeaString[NMEA_OUTPUT_MAX];
+  int length;
 
-  time_interval_sensor = time_current - time_past_sensor;
-  if(time_interval_sensor >= SENSOR_INTERVAL)
+  /* Get Nmea Data. */
+  length = NmeaBuild(NmeaString, sizeof(NmeaString), (SpNavData*)&NavData, Parameter.NmeaSentence);
+  if (length == 0)
+  {
+    state = eStateError;
+    Led_isState();
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Output Nmea Data. */
+  if (Parameter.NmeaOutUart == true)
+  {
+    /* To Uart. */
+    Serial.print(NmeaString);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.NmeaOutFile == true)
   {
-    time_past_sensor = time_current;
-    /* Buffer Clear */
-    if(state_last == eStateGnssNonFix)
+    /* To SDCard, the file of this interval is opened on its first sentence, by the writer if it runs. */
+    if (NmeaFileOpen == false)
     {
-      SensorBuff[0] = '\0';
+      NmeaFileOpen = (RotateNmea((const char*)FileNmeaTxt, (FILE_WRITE | O_APPEND)) == true) ||
+                     (OpenNmea((const char*)FileNmeaTxt, (FILE_WRITE | O_APPEND)) == true);
+      if (NmeaFileOpen == false)
+      {
+        NmeaOpenErrors++;
+      }
+      else
+      {
+        /* do nothing. */
+      }
     }
     else
     {
-      /* Do nothing. */
+      /* do nothing. */
     }
-  
-    /* Get senser data here. */
-    SensorString = getSensor();
-  
-    if (strlen(SensorString.c_str()) == 0)
+
+    /* The writer counts errors and drops, NMEA never stops the sensors. */
+    if (NmeaFileOpen == true)
     {
-      state = eStateError;
-      Led_isState();
+      WriteNmea(NmeaString, length);
     }
     else
     {
-      /* Output Sensor Data. */
-      if (Parameter.SensorOutUart == true)
-      {
-        /* To Uart. */
-        Serial.print(SensorString.c_str());
-      }
-      else
-      {
-        /* do nothing. */
-      }
-  
-      if (Parameter.SensorOutFile == true)
-      {
-        records_num += 1;
-        strncat(SensorBuff, SensorString.c_str(), strlen(SensorString.c_str()));
-
-        /* Counter Check to Write. */
-        if(records_num >= STORE_RECORDS_NUM)
-        {
-          if (SensorBuff[0] != '\0')
-          {
-            write_size = WriteSD(SensorBuff, strlen(SensorBuff));
-            /* Check result. */
-            if (write_size == strlen(SensorBuff))
-            {
-              records_num = 0;
-              SensorBuff[0] = '\0'; 
-            }
-            else
-            {
-              state = eStateWriteError;
-              Led_isState();
-            }
-          }
-          else
-          {
-            /* do nothing. */
-          }
-        }
-        else
-        {
-          /* do nothing. */
-        }
-      }
-      else
-      {
-        /* do nothing. */
-      }
+      /* do nothing. */
     }
   }
   else
   {
-    /* Do nothing. */
+    /* do nothing. */
   }
 }
 
-static String getSensor(void)
+/**
+ * @brief Start GNSS while the sensors keep sampling.
+ */
+static void GnssBackgroundBegin(void)
 {
-  rc = 0;/* flag */
-  String Sensor = "";
-  char StringBuffer[STRING_BUFFER_SIZE] = {};
-  float acc[3];/* acceleration */
-  float barom = 0, temp = 0;
-
-  /* acceleration */
-  rc = kx122.get_val(acc);
-  if (rc != 0)
+  if (GnssActive == false)
   {
-    Serial.println("KX122 failed.");
+    TimefixFlag = 0;
+    Gnss.start(HOT_START);
+    GnssBegin_us = TimebaseNow();
+    GnssScheduleStart(GnssBegin_us, eGnssStartHot);
+    GnssActive = true;
   }
-
-  /* barometer & no temperature */
-  rc = bm1383aglv.get_val(&barom, &temp);
-  if (rc != 0)
+  else
   {
-    Serial.println("BM1383AGLV failed.");
+    /* do nothing. */
   }
-
-  /* Set Header. */
-  Sensor = "$V00300,";/* sign name */
-  Sensor += "0x0001,";/* device no */
-
-  RtcTime now = RTC.getTime();
-
-  /* Time when rtc was modified by gps. */
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%04d/%02d/%02d %02d:%02d:%02d.%03d,", now.year(), now.month(), now.day(), now.hour(), now.minute(), now.second(), now.nsec() / 1000000);
-  Sensor += StringBuffer;
-
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%d,", seq++);/* sequence no */
-  Sensor += StringBuffer;
-
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%d,", time_interval_sensor);/* elapsed time */
-  Sensor += StringBuffer;
-
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%5.3f,", acc[0]);/* acceleration (X) */
-  Sensor += StringBuffer;
-
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%5.3f,", acc[1]);/* acceleration (Y) */
-  Sensor += StringBuffer;
-
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%5.3f,", acc[2]);/* acceleration (Z) */
-  Sensor += StringBuffer;
-
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%4.4f",barom);/* barometer */
-  Sensor += StringBuffer;
-
-  Sensor += "\n";
-
-  return Sensor;
 }
 
 /**
-\ * @brief Activate GNSS device and Sensor modules.
+ * @brief Stop GNSS and record the session.
  */
-void setup(void)
+static void GnssBackgroundEnd(void)
 {
-  Watchdog.begin();
-  Watchdog.start(20000);
-
-  Led_isState();
-
-  /* Set serial baudeate. */
-  Serial.begin(SERIAL_BAUDRATE);
-  while (!Serial);
-
-  LowPower.begin();
-  LowPower.clockMode(CLOCK_MODE_156MHz);                  
-
-  /* Initialize gps */
-  SetupPositioning();
-
-  /* Initialize acceleration */
-  Wire.begin();
-  rc = kx122.init();
-  if (rc != 0)
-  {
-    state = eStateError;
-    Led_isState();
-  }
-  else
-  {
-   /* do nothing. */
-  }
+  SensorBinGnss Session;
 
-  /* barometer & temperature */
-  rc = bm1383aglv.init();
-  if (rc != 0)
+  Gnss.stop();
+  GnssActive = false;
+  GnssScheduleStop(TimebaseNow(), seq, &Session);
+  OutputGnss(&Session);
+  FlushNmea();
+  if (Session.result == eGnssFixed)
   {
-    state = eStateError;
-    Led_isState();
+    GnssBackupSave(&NavData);
   }
   else
   {
     /* do nothing. */
   }
-
-  state = eStateRenewFile;
-  Led_isState();
 }
 
 /**
- * @brief Main loop
+ * @brief Correct the time from GNSS without stopping the sensors.
+ * 
+ * @details Never waits for GNSS. GNSS stops once the timestamps are within
+ *          GNSS_TOLERANCE_US of the GNSS time, or after GNSS_TIMEOUT_MS
+ *          without a fix.
  */
-void loop(void)
+static void GnssBackgroundProcessing(void)
 {
-  Watchdog.kick();
-  time_current = millis();
-  Led_AliveBlink();
-  Led_isState();
-  CheckFileRenew();
+  SensorBinTime Event;
+  unsigned long long count_us;
 
-  switch(state)
+  if (Gnss.waitUpdate(0))
   {
-    case  eStateSensor:  /**< Loop is not activated */
-      if(state != state_last)
+    count_us = TimebaseNow();
+    Gnss.getNavData(&NavData);
+    if ((NavData.posFixMode >= 1) && (NavData.time.year >= 2000))
+    {
+      if (CorrectTime(&NavData.time, count_us, &Event) == true)
       {
-        Gnss.stop();
-        Wire.begin();
-        OpenSD(FileSensorTxt, (FILE_WRITE | O_APPEND));
+        /* Judged that time was corrected. */
+        TimefixFlag = 1;
       }
       else
       {
         /* do nothing. */
       }
-      SensorProcessing();
-      /* Task  */
-      state_last = eStateSensor;
-      break;
-
-    case  eStateRenewFile:
-      if(state != state_last)
+      GnssScheduleFix(count_us, Event.offset_us);
+      OutputTime(&Event);
+      if ((NavData.posDataExist) && (TrackDue(count_us) == true))
       {
-        CloseSD();
-        TimefixFlag = 0;
-        RTC.end();
-        Gnss.stop();
-        Wire.end();
+        OutputTrack((const SpNavData*)&NavData, count_us);
       }
       else
       {
         /* do nothing. */
       }
-      UpdateFileNumber();
-      state_last = eStateRenewFile;
-      state = eStateGnssNonFix;
-      break;
 
-    case  eStateGnssNonFix:
-      if(state != state_last)
+      /* Before the session ends, so its flush covers the last fix. */
+      time_interval_gps = time_current - time_past_gps;
+      if (time_interval_gps >= GPS_INTERVAL)
       {
-        Wire.end();
-        Gnss.start(HOT_START);
-        RTC.begin();
+        time_past_gps = time_current;
+        OutputNmea();
       }
       else
       {
         /* do nothing. */
       }
-      GpsProcessing();
-      state_last = eStateGnssNonFix;
-      if(TimefixFlag == 1)
+
+      /* A due position fix keeps GNSS on a little after the time is corrected. */
+      if ((TimefixFlag == 1) &&
+          ((TrackDue(count_us) == false) || ((count_us - GnssBegin_us) >= (unsigned long long)TRACK_WAIT_MS * 1000)))
       {
-        state = eStateSensor;
+        GnssBackgroundEnd();
       }
-      break;
+      else
+      {
+        /* do nothing. */
+      }
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if ((GnssActive == true) && (GnssScheduleTimeout(TimebaseNow()) == true))
+  {
+    /* No sky view, e.g. in the barn. */
+    GnssBackgroundEnd();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Add a GNSS fix to the timebase.
+ * 
+ * @param [in] pTime GNSS time (UTC)
+ * @param [in] count_us Counter when the fix was received
+ * @param [out] pEvent Time correction to be recorded
+ * @return true if the timestamps are already within GNSS_TOLERANCE_US
+ */
+static bool CorrectTime(const SpGnssTime *pTime, unsigned long long count_us, SensorBinTime *pEvent)
+{
+  RtcTime now = RTC.getTime();
+  RtcTime gps(pTime->year, pTime->month, pTime->day, pTime->hour, pTime->minute, pTime->sec, pTime->usec * 1000);
+  uint32_t sec;
+  uint32_t usec;
+  long residual_us;
+  bool fitted;
+
+  /* Timestamp of the fix before the fix is added. */
+  if (TimebaseToUtc(count_us, &sec, &usec) == false)
+  {
+    sec = gps.unixtime();
+    usec = pTime->usec;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  fitted = TimebaseFix(count_us, pTime, &residual_us);
+
+  /* Keep the RTC, the wall clock of the board, within a second. */
+  gps += MY_TIMEZONE_IN_SECONDS;
+  if (abs(now - gps) >= 1)
+  {
+    RTC.setTime(gps);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pEvent->type = fitted ? eTimeFit : eTimeStep;
+  pEvent->seq = seq;
+  pEvent->sec = sec + MY_TIMEZONE_IN_SECONDS;
+  pEvent->msec = usec / 1000;
+  pEvent->offset_us = residual_us;
+  pEvent->adjust_us = fitted ? TimebaseDrift() : residual_us;
+
+  return (fitted == true) && (labs(residual_us) < GNSS_TOLERANCE_US);
+}
+
+static void SensorProcessing(void)
+{
+  signed short acc[3];/* acceleration */
+  static signed short AccBuff[SENSOR_FIFO_NUM * 3];
+  unsigned short AccNum = 0;
+  unsigned short cnt;
+  unsigned long long count_us;
+
+  /* Run by TaskSensor at the output data rate or the drain interval. */
+  time_interval_sensor = time_current - time_past_sensor;
+  time_past_sensor = time_current;
+  count_us = TimebaseNow();
+
+  if (SENSOR_FIFO_MODE)
+  {
+    /* Drain all samples stored in the KX122 buffer. */
+    rc = kx122.get_buf_cnt(AccBuff, SENSOR_FIFO_NUM, &AccNum);
+    if (rc != 0)
+    {
+      Serial.println("KX122 failed.");
+    }
+
+    for (cnt = 0; cnt < AccNum; cnt++)
+    {
+      /* The newest sample was taken now, older ones one period apart. */
+      AcceptSample(&AccBuff[cnt * 3], sensor_period_us,
+                   count_us - (unsigned long long)(AccNum - 1 - cnt) * sensor_period_us);
+    }
+  }
+  else
+  {
+    /* acceleration */
+    rc = kx122.get_cnt(acc);
+    if (rc != 0)
+    {
+      Serial.println("KX122 failed.");
+    }
+
+    /* Get senser data here. */
+    AcceptSample(acc, time_interval_sensor * 1000UL, count_us);
+  }
+}
+
+/**
+ * @brief KX122 data ready interrupt handler.
+ */
+static void SensorDrdyHandler(void)
+{
+  SensorQueuePush(micros());
+}
+
+/**
+ * @brief Timer interrupt handler.
+ * 
+ * @return Next interval [us]
+ */
+static unsigned int SensorTimerHandler(void)
+{
+  SensorQueuePush(micros());
+  return sensor_period_us;
+}
+
+/**
+ * @brief Start interrupt driven sampling.
+ */
+static void SensorTriggerBegin(void)
+{
+  SensorQueueClear();
+  time_last_sample_us = 0;
+
+  switch (SENSOR_TRIGGER)
+  {
+    case eTriggerDrdy:
+      attachInterrupt(digitalPinToInterrupt(SENSOR_DRDY_PIN), SensorDrdyHandler, RISING);
+      break;
+
+    case eTriggerTimer:
+      attachTimerInterrupt(SensorTimerHandler, sensor_period_us);
+      break;
+
+    case eTriggerPoll:
+    default:
+      /* do nothing. */
+      break;
+  }
+}
+
+/**
+ * @brief Stop interrupt driven sampling.
+ */
+static void SensorTriggerEnd(void)
+{
+  switch (SENSOR_TRIGGER)
+  {
+    case eTriggerDrdy:
+      detachInterrupt(digitalPinToInterrupt(SENSOR_DRDY_PIN));
+      break;
+
+    case eTriggerTimer:
+      detachTimerInterrupt();
+      break;
+
+    case eTriggerPoll:
+    default:
+      /* do nothing. */
+      break;
+  }
+}
+
+/**
+ * @brief Make records for the samples queued by the interrupt handler.
+ * 
+ * @details Sample times come from the interrupt, so record spacing does not
+ *          depend on when loop() runs. The spread of the measured intervals
+ *          is recorded once per block.
+ */
+static void SensorQueueProcessing(void)
+{
+  SensorBinJitter Jitter;
+  static signed short AccBuff[SENSOR_FIFO_NUM * 3];
+  unsigned short AccNum = 0;
+  unsigned short cnt;
+  unsigned long time_us;
+  unsigned long interval_us;
+  unsigned long interval_min = 0xFFFFFFFF;
+  unsigned long interval_max = 0;
+  unsigned long seq_first = seq;
+  int QueueNum;
+
+  /* Run by TaskSensor every drain interval, or every sample period for the timer. */
+  QueueNum = SensorQueueCount();
+  if (QueueNum > 0)
+  {
+    if (SENSOR_TRIGGER == eTriggerDrdy)
+    {
+      /* One buffered sample per data ready interrupt. */
+      rc = kx122.get_buf_cnt(AccBuff, min(QueueNum, SENSOR_FIFO_NUM), &AccNum);
+    }
+    else
+    {
+      /* Only the latest sample can be read, so drain the ticks queued behind it. */
+      for (; QueueNum > 1; QueueNum--)
+      {
+        SensorQueuePop(&time_us);
+        SensorTickMissed++;
+      }
+      rc = kx122.get_cnt(AccBuff);
+      AccNum = 1;
+    }
+    if (rc != 0)
+    {
+      Serial.println("KX122 failed.");
+    }
+
+    for (cnt = 0; cnt < AccNum; cnt++)
+    {
+      if (SensorQueuePop(&time_us) != true)
+      {
+        break;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+
+      if (time_last_sample_us != 0)
+      {
+        interval_us = time_us - time_last_sample_us;
+        interval_min = min(interval_min, interval_us);
+        interval_max = max(interval_max, interval_us);
+      }
+      else
+      {
+        interval_us = sensor_period_us;
+      }
+      time_last_sample_us = time_us;
+
+      AcceptSample(&AccBuff[cnt * 3], interval_us, TimebaseExtend(time_us));
+    }
+
+    if ((SENSOR_OUT_JITTER) && (interval_max != 0))
+    {
+      /* Interval jitter of this block [us]. */
+      Jitter.seq = seq_first;
+      Jitter.num = cnt;
+      Jitter.min_us = interval_min;
+      Jitter.max_us = interval_max;
+      Jitter.dropped = SensorQueueDropped() + SensorTickMissed;
+      OutputJitter(&Jitter);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* Do nothing. */
+  }
+}
+
+/**
+ * @brief Take one accelerometer sample.
+ * 
+ * @details With bursts on, the KX122 runs at BurstRate. Every sample goes
+ *          to the burst ring and SampleDecimate samples are averaged into
+ *          one record at AccRate, timed at the middle of the samples.
+ * @param [in] acc Acceleration X/Y/Z [counts]
+ * @param [in] interval_us Time since the previous sample [us]
+ * @param [in] count_us Counter when the sample was taken [us]
+ */
+static void AcceptSample(const signed short *acc, unsigned long interval_us, unsigned long long count_us)
+{
+  SensorRecord Record;
+  signed short mean[3];
+  long sum;
+  int axis;
+
+  if (Parameter.BurstTrigger != eBurstOff)
+  {
+    /* Tagged with the record this sample goes into. */
+    BurstPut(acc, count_us, seq);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (SampleDecimate <= 1)
+  {
+    getSensor(&Record, acc, interval_us, count_us);
+    OutputSensor(&Record);
+  }
+  else
+  {
+    if (DecimateNum == 0)
+    {
+      DecimateFirst_us = count_us;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    for (axis = 0; axis < 3; axis++)
+    {
+      DecimateSum[axis] += acc[axis];
+    }
+    DecimateInterval_us += interval_us;
+    DecimateNum++;
+
+    if (DecimateNum >= SampleDecimate)
+    {
+      for (axis = 0; axis < 3; axis++)
+      {
+        sum = DecimateSum[axis];
+        mean[axis] = (sum >= 0) ? ((sum + (long)DecimateNum / 2) / (long)DecimateNum) :
+                                 -((-sum + (long)DecimateNum / 2) / (long)DecimateNum);
+        DecimateSum[axis] = 0;
+      }
+      getSensor(&Record, mean, DecimateInterval_us, DecimateFirst_us + (count_us - DecimateFirst_us) / 2);
+      OutputSensor(&Record);
+      DecimateNum = 0;
+      DecimateInterval_us = 0;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+}
+
+/**
+ * @brief Check the trigger and write the burst samples, run every BURST_INTERVAL.
+ */
+static void BurstProcessing(void)
+{
+  BurstSample Sample;
+  bool motion = false;
+  uint32_t sec;
+  uint32_t usec;
+  int cnt;
+
+  if (Parameter.BurstTrigger == eBurstWakeup)
+  {
+    /* The wake-up status stays latched until it is read. */
+    rc = kx122.get_wuf(&motion);
+    if (rc != 0)
+    {
+      Serial.println("KX122 failed.");
+    }
+    else if (motion == true)
+    {
+      BurstTrigger(seq);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  for (cnt = 0; (cnt < BURST_OUT_MAX) && (BurstGet(&Sample) == true); cnt++)
+  {
+    if ((BurstRecord.num != 0) &&
+        ((Sample.trigger != BurstRecord.trigger) || (Sample.index != BurstRecord.index + BurstRecord.num)))
+    {
+      /* A new burst, or samples were dropped. */
+      OutputBurst();
+    }
+    else
+    {
+      /* do nothing. */
+    }
+
+    if (BurstRecord.num == 0)
+    {
+      TimebaseToUtc(Sample.count_us, &sec, &usec);
+      BurstRecord.trigger = Sample.trigger;
+      BurstRecord.index = Sample.index;
+      BurstRecord.sec = sec + MY_TIMEZONE_IN_SECONDS;
+      BurstRecord.usec = usec;
+      BurstRecord.period_us = sensor_period_us;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    BurstRecord.acc[BurstRecord.num][0] = Sample.acc[0];
+    BurstRecord.acc[BurstRecord.num][1] = Sample.acc[1];
+    BurstRecord.acc[BurstRecord.num][2] = Sample.acc[2];
+    BurstRecord.num++;
+
+    if (BurstRecord.num >= SENSOR_BIN_BURST_NUM)
+    {
+      OutputBurst();
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  if ((BurstRecord.num != 0) && (BurstActive() == false))
+  {
+    /* End of the burst. */
+    OutputBurst();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Update the most recent pressure, run every PressInterval.
+ * 
+ * @details The barometer averages internally, so it is read much less
+ *          often than the accelerometer. Records carry the latest value.
+ */
+static void PressureProcessing(void)
+{
+  unsigned long barom = 0;
+
+  /* barometer & no temperature */
+  rc = bm1383aglv.get_rawpress(&barom);
+  if (rc != 0)
+  {
+    Serial.println("BM1383AGLV failed.");
+  }
+  else
+  {
+    press_latest = barom;
+  }
+}
+
+/**
+ * @brief Output one sensor record to UART and SD card.
+ * 
+ * @details UART always gets CSV. The file gets CSV or binary blocks.
+ * @param [in] pRecord Sensor record
+ */
+static void OutputSensor(const SensorRecord *pRecord)
+{
+  char SensorString[SENSOR_RECORD_MAX];
+  uint8_t BinBuff[SENSOR_CODEC_BLOCK_MAX];
+  ActivityRecord Summary;
+  int length = 0;
+
+  if (ActivityPut(&Activity, pRecord, &Summary) == true)
+  {
+    OutputActivity(&Summary);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if ((Parameter.SensorOutUart == true) ||
+      ((Parameter.SensorOutFile == true) && (Parameter.SensorOutFormat == eFormatCsv) &&
+       (SensorOffloadRunning() == false)))
+  {
+    length = FormatSensorRecord(SensorString, sizeof(SensorString), pRecord);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.SensorOutUart == true)
+  {
+    /* To Uart. */
+    Serial.write(SensorString, length);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.SensorOutFile == true)
+  {
+    if (SensorOffloadRunning() == true)
+    {
+      /* Encoded by the encoder thread in the file format. */
+      SensorOffloadPut(pRecord);
+    }
+    else if (Parameter.SensorOutFormat == eFormatCsv)
+    {
+      StoreSensor(SensorString, length);
+    }
+    else
+    {
+      /* Store the block closed by this sample, if any. */
+      if (Parameter.SensorOutFormat == eFormatCompressed)
+      {
+        length = SensorCodecPut(&SensorDelta, pRecord, BinBuff);
+      }
+      else
+      {
+        length = SensorBinPut(&SensorBlock, pRecord, BinBuff);
+      }
+      if (length != 0)
+      {
+        StoreSensor((const char*)BinBuff, length);
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Output the interval jitter of one block to UART and SD card.
+ * 
+ * @param [in] pJitter Jitter of one block
+ */
+static void OutputJitter(const SensorBinJitter *pJitter)
+{
+  char SensorString[STRING_BUFFER_SIZE];
+  uint8_t BinBuff[SENSOR_BIN_JITTER_SIZE];
+  int length;
+
+  length = snprintf(SensorString, sizeof(SensorString), "$J00300,0x%04X,%lu,%lu,%lu,%lu,%lu\n",
+                    Parameter.DeviceId, (unsigned long)pJitter->seq, (unsigned long)pJitter->num, (unsigned long)pJitter->min_us,
+                    (unsigned long)pJitter->max_us, (unsigned long)pJitter->dropped);
+
+  if (Parameter.SensorOutUart == true)
+  {
+    /* To Uart. */
+    Serial.write(SensorString, length);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.SensorOutFile == true)
+  {
+    if (Parameter.SensorOutFormat == eFormatCsv)
+    {
+      StoreSensor(SensorString, length);
+    }
+    else
+    {
+      length = SensorBinWriteJitter(BinBuff, pJitter);
+      StoreSensor((const char*)BinBuff, length);
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Output a time correction record.
+ * 
+ * @param [in] pTime Time correction
+ */
+static void OutputTime(const SensorBinTime *pTime)
+{
+  char SensorString[STRING_BUFFER_SIZE];
+  uint8_t BinBuff[SENSOR_BIN_TIME_SIZE];
+  char *p;
+  int length;
+
+  p = SensorString + snprintf(SensorString, sizeof(SensorString), "$T00300,0x%04X,", Parameter.DeviceId);
+  p = FormatSensorTime(p, pTime->sec, pTime->msec);
+  length = (p - SensorString);
+  length += snprintf(p, sizeof(SensorString) - length, ",%lu,%s,%ld,%ld\n",
+                     (unsigned long)pTime->seq, SensorBinTimeName(pTime->type),
+                     (long)pTime->offset_us, (long)pTime->adjust_us);
+
+  if (Parameter.SensorOutUart == true)
+  {
+    /* To Uart. */
+    Serial.write(SensorString, length);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.SensorOutFile == true)
+  {
+    if (Parameter.SensorOutFormat == eFormatCsv)
+    {
+      StoreSensor(SensorString, length);
+    }
+    else
+    {
+      /* Keep the file in time order, samples before the correction first. */
+      FlushSensorFile();
+      length = SensorBinWriteTime(BinBuff, pTime);
+      StoreSensor((const char*)BinBuff, length);
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Output a GNSS session record.
+ * 
+ * @param [in] pGnss GNSS session
+ */
+static void OutputGnss(const SensorBinGnss *pGnss)
+{
+  char SensorString[STRING_BUFFER_SIZE];
+  uint8_t BinBuff[SENSOR_BIN_GNSS_SIZE];
+  int length;
+
+  length = snprintf(SensorString, sizeof(SensorString), "$G00300,0x%04X,%lu,%s,%s,%lu,%lu,%u,%ld,%ld,%lu\n",
+                    Parameter.DeviceId, (unsigned long)pGnss->seq, SensorBinGnssStartName(pGnss->start),
+                    (pGnss->result == eGnssFixed) ? "FIX" : "TIMEOUT",
+                    (unsigned long)pGnss->ttff_ms, (unsigned long)pGnss->on_ms, (unsigned)pGnss->fixes,
+                    (long)pGnss->error_us, (long)pGnss->residual_us, (unsigned long)pGnss->energy_mj);
+
+  if (Parameter.SensorOutUart == true)
+  {
+    /* To Uart. */
+    Serial.write(SensorString, length);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.SensorOutFile == true)
+  {
+    if (Parameter.SensorOutFormat == eFormatCsv)
+    {
+      StoreSensor(SensorString, length);
+    }
+    else
+    {
+      length = SensorBinWriteGnss(BinBuff, pGnss);
+      StoreSensor((const char*)BinBuff, length);
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Check whether the next position fix should be recorded.
+ * 
+ * @param [in] count_us Timebase counter [us]
+ * @return true if TrackInterval has passed since the last position fix record
+ */
+static bool TrackDue(unsigned long long count_us)
+{
+  if (Parameter.TrackInterval == 0)
+  {
+    return false;
+  }
+  else if (TrackValid == false)
+  {
+    return true;
+  }
+  else
+  {
+    return (count_us - TrackLast_us) >= (unsigned long long)Parameter.TrackInterval * 60000000ULL;
+  }
+}
+
+/**
+ * @brief Output a position fix record.
+ * 
+ * @param [in] pNavData Navigation data with a position
+ * @param [in] count_us Timebase counter at the fix [us]
+ */
+static void OutputTrack(const SpNavData *pNavData, unsigned long long count_us)
+{
+  SensorBinTrack Track;
+  char SensorString[SENSOR_TRACK_MAX];
+  uint8_t BinBuff[SENSOR_BIN_TRACK_SIZE];
+  int length;
+  RtcTime fix(pNavData->time.year, pNavData->time.month, pNavData->time.day,
+              pNavData->time.hour, pNavData->time.minute, pNavData->time.sec);
+
+  Track.seq = seq;
+  Track.sec = fix.unixtime() + MY_TIMEZONE_IN_SECONDS;
+  Track.msec = pNavData->time.usec / 1000;
+  Track.mode = (pNavData->posFixMode == Fix3D) ? 3 : 2;
+  Track.sats = pNavData->numSatellitesCalcPos;
+  Track.lat = lround(pNavData->latitude * 1e7);
+  Track.lon = lround(pNavData->longitude * 1e7);
+  Track.alt_cm = lround(pNavData->altitude * 100);
+  Track.hdop = (pNavData->hdop < 655.35) ? (uint16_t)lround(pNavData->hdop * 100) : 0xFFFF;
+  Track.speed_cms = (pNavData->velocity < 655.35) ? (uint16_t)lround(pNavData->velocity * 100) : 0xFFFF;
+
+  TrackLast_us = count_us;
+  TrackValid = true;
+
+  length = SensorBinFormatTrack(SensorString, sizeof(SensorString), Parameter.DeviceId, &Track);
+
+  if (Parameter.SensorOutUart == true)
+  {
+    /* To Uart. */
+    Serial.write(SensorString, length);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (Parameter.SensorOutFile == true)
+  {
+    if (Parameter.SensorOutFormat == eFormatCsv)
+    {
+      StoreSensor(SensorString, length);
+    }
+    else
+    {
+      /* Keep the file in time order, samples before the fix first. */
+      FlushSensorFile();
+      length = SensorBinWriteTrack(BinBuff, &Track);
+      StoreSensor((const char*)BinBuff, length);
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Output the features of one activity window to UART and the summary file.
+ * 
+ * @param [in] pActivity Activity record
+ */
+static void OutputActivity(const ActivityRecord *pActivity)
+{
+  char SummaryString[ACTIVITY_RECORD_MAX];
+  int length;
+
+  length = FormatActivityRecord(SummaryString, sizeof(SummaryString), pActivity);
+
+  if (Parameter.SensorOutUart == true)
+  {
+    /* To Uart. */
+    Serial.write(SummaryString, length);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (SummaryFileOpen == true)
+  {
+    /* The writer drops and counts records it has no room for. */
+    WriteSummary(SummaryString, length);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Open the activity summary file of this interval.
+ * 
+ * @details While sampling, the writer of the previous file switches to it.
+ */
+static void OpenSummaryFile(void)
+{
+  if (Parameter.ActivityWindow != 0)
+  {
+    SummaryFileOpen = (RotateSummary((const char*)FileSummaryTxt, (FILE_WRITE | O_APPEND)) == true) ||
+                      (OpenSummary((const char*)FileSummaryTxt, (FILE_WRITE | O_APPEND)) == true);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Write the partial activity window to the summary file.
+ */
+static void FinishSummaryFile(void)
+{
+  ActivityRecord Summary;
+
+  if (ActivityFlush(&Activity, &Summary) == true)
+  {
+    OutputActivity(&Summary);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Write the partial activity window and close the summary file.
+ */
+static void CloseSummaryFile(void)
+{
+  FinishSummaryFile();
+
+  if (SummaryFileOpen == true)
+  {
+    CloseSummary();
+    ReportSummaryFile();
+    SummaryFileOpen = false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Write the burst record under construction to the burst file.
+ * 
+ * @details Bursts are not sent to UART, they run at the full output data rate.
+ */
+static void OutputBurst(void)
+{
+  char BurstString[SENSOR_BURST_MAX];
+  uint8_t BinBuff[SENSOR_BIN_BURST_MAX];
+  int length;
+  int cnt;
+
+  if (BurstFileOpen == true)
+  {
+    /* The writer drops and counts records it has no room for. */
+    if (Parameter.SensorOutFormat == eFormatCsv)
+    {
+      for (cnt = 0; cnt < BurstRecord.num; cnt++)
+      {
+        length = SensorBinFormatBurst(BurstString, sizeof(BurstString), Parameter.DeviceId,
+                                      kx122.get_sens(), &BurstRecord, cnt);
+        WriteBurst(BurstString, length);
+      }
+    }
+    else
+    {
+      length = SensorBinWriteBurst(BinBuff, &BurstRecord);
+      WriteBurst((const char*)BinBuff, length);
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  BurstRecord.num = 0;
+}
+
+/**
+ * @brief Open the burst file of this interval and write its header.
+ */
+static void OpenBurstFile(void)
+{
+  SensorBinHead Head;
+  uint8_t BinBuff[SENSOR_BIN_HEADER_SIZE];
+  uint32_t sec;
+  uint32_t usec;
+
+  BurstRecord.num = 0;
+  if (Parameter.BurstTrigger != eBurstOff)
+  {
+    /* While sampling, the writer of the previous file switches to it. */
+    BurstFileOpen = (RotateBurst((const char*)FileBurstTxt, (FILE_WRITE | O_APPEND)) == true) ||
+                    (OpenBurst((const char*)FileBurstTxt, (FILE_WRITE | O_APPEND)) == true);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if ((BurstFileOpen == true) && (Parameter.SensorOutFormat != eFormatCsv))
+  {
+    /* The same header as the sensor file, at the burst rate. */
+    Head.version = SENSOR_BIN_VERSION;
+    Head.device = Parameter.DeviceId;
+    Head.odr = Parameter.BurstRate;
+    Head.range = Parameter.AccRange;
+    Head.sens = kx122.get_sens();
+    Head.press_per_hpa = HPA_PER_COUNT;
+    Head.period_us = sensor_period_us;
+    TimebaseToUtc(TimebaseNow(), &sec, &usec);
+    Head.start_sec = sec + MY_TIMEZONE_IN_SECONDS;
+    Head.start_msec = usec / 1000;
+    WriteBurst((const char*)BinBuff, SensorBinWriteHead(BinBuff, &Head));
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Write the samples of the burst read out so far to the burst file.
+ * 
+ * @details A burst still being captured continues in the next file under the same trigger.
+ */
+static void FinishBurstFile(void)
+{
+  if (Parameter.BurstTrigger != eBurstOff)
+  {
+    BurstProcessing();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if ((BurstFileOpen == true) && (BurstRecord.num != 0))
+  {
+    OutputBurst();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Write the samples of the burst read out so far and close the burst file.
+ */
+static void CloseBurstFile(void)
+{
+  FinishBurstFile();
+
+  if (BurstFileOpen == true)
+  {
+    CloseBurst();
+    ReportBurstFile();
+    BurstFileOpen = false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Open the sensor file and write its header. Called before sampling starts.
+ */
+static void OpenSensorFile(void)
+{
+  if ((OpenSD((const char*)FileSensorTxt, (FILE_WRITE | O_APPEND), SensorFileReserve()) == false) &&
+      (Parameter.SensorOutFile == true))
+  {
+    state = eStateWriteError;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  snprintf(FileSensorOpen, sizeof(FileSensorOpen), "%s", (const char*)FileSensorTxt);
+  StartSensorFile();
+  SensorFileWritten = SensorFileQueued;
+  OpenSummaryFile();
+  OpenBurstFile();
+}
+
+/**
+ * @brief Switch the SD writer to the sensor file of this interval while sampling.
+ * 
+ * @details The writer closes and trims the old file, rewrites the index
+ *          file and preallocates the new file behind the queued data.
+ */
+static void SwitchSensorFile(void)
+{
+  if ((Parameter.SensorOutFile == true) &&
+      (RotateSD((const char*)FileSensorTxt, (FILE_WRITE | O_APPEND), SensorFileReserve(),
+                INDEX_FILE_NAME, (const char*)IndexData) == true))
+  {
+    /* do nothing. */
+  }
+  else
+  {
+    /* No sensor file writer, a short write in the loop. */
+    Remove(INDEX_FILE_NAME);
+    WriteFileNumber();
+  }
+  snprintf(FileSensorOpen, sizeof(FileSensorOpen), "%s", (const char*)FileSensorTxt);
+}
+
+/**
+ * @brief Start the files of the next interval without stopping the sensors.
+ * 
+ * @details Data of the old files is queued to the writers first, each
+ *          writer thread then closes its file and opens the next one, so
+ *          the loop never waits for the card here. With the encoder the
+ *          sensor file is switched by WriteOffload in front of the first
+ *          block of the new file.
+ */
+static void RotateFiles(void)
+{
+  FinishSensorFile();
+  WriteSensorBuff();
+  if (NmeaFileOpen == true)
+  {
+    RotateNmea(NULL, 0);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  FinishSummaryFile();
+  FinishBurstFile();
+  ReportSensorFile(false);
+  ReportNmeaFile();
+  ReportSummaryFile();
+  ReportBurstFile();
+  ReportTimebase();
+
+  NextFileNumber();
+  if (SensorOffloadRunning() == false)
+  {
+    SwitchSensorFile();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  StartSensorFile();
+  OpenSummaryFile();
+  OpenBurstFile();
+}
+
+/**
+ * @brief Start a new sensor file.
+ * 
+ * @details Binary files start with a header describing the samples.
+ */
+static void StartSensorFile(void)
+{
+  SensorBinHead Head;
+  uint8_t BinBuff[SENSOR_BIN_HEADER_SIZE];
+  uint32_t sec;
+  uint32_t usec;
+
+  SensorBuffLen = 0;
+  records_num = 0;
+  SensorBinReset(&SensorBlock);
+  SensorCodecReset(&SensorDelta);
+  if (SensorOffloadRunning() == true)
+  {
+    SensorFileQueued = SensorOffloadStart(Parameter.SensorOutFormat);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if ((Parameter.SensorOutFile == true) && (Parameter.SensorOutFormat != eFormatCsv))
+  {
+    Head.version = SENSOR_BIN_VERSION;
+    Head.device = Parameter.DeviceId;
+    Head.odr = Parameter.AccRate;
+    Head.range = Parameter.AccRange;
+    Head.sens = kx122.get_sens();
+    Head.press_per_hpa = HPA_PER_COUNT;
+    Head.period_us = record_period_us;
+    TimebaseToUtc(TimebaseNow(), &sec, &usec);
+    Head.start_sec = sec + MY_TIMEZONE_IN_SECONDS;
+    Head.start_msec = usec / 1000;
+    StoreSensor((const char*)BinBuff, SensorBinWriteHead(BinBuff, &Head));
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Estimate the sensor file size for one file interval.
+ * 
+ * @return Bytes to preallocate, 0 to grow the file on demand
+ */
+static unsigned long SensorFileReserve(void)
+{
+  unsigned long long reserve = 0;
+  unsigned long record;
+
+  if (SENSOR_FILE_PREALLOCATE && (Parameter.SensorOutFile == true) && (record_period_us != 0))
+  {
+    record = (Parameter.SensorOutFormat == eFormatCsv) ? SENSOR_FILE_CSV_SIZE : SENSOR_FILE_BIN_SIZE;
+    reserve = (unsigned long long)Parameter.FileInterval * 60000000ULL / record_period_us * record;
+    if (reserve > SD_RESERVE_MAX)
+    {
+      reserve = SD_RESERVE_MAX;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return (unsigned long)reserve;
+}
+
+/**
+ * @brief Write the open binary block before the file is closed.
+ */
+static void FlushSensorFile(void)
+{
+  uint8_t BinBuff[SENSOR_CODEC_BLOCK_MAX];
+  int length;
+
+  if (SensorOffloadRunning() == true)
+  {
+    /* The encoder closes the block after the samples handed to it. */
+    SensorOffloadFlush();
+  }
+  else if ((Parameter.SensorOutFile == true) && (Parameter.SensorOutFormat != eFormatCsv))
+  {
+    if (Parameter.SensorOutFormat == eFormatCompressed)
+    {
+      length = SensorCodecFlush(&SensorDelta, BinBuff);
+    }
+    else
+    {
+      length = SensorBinFlush(&SensorBlock, BinBuff);
+    }
+    if (length != 0)
+    {
+      StoreSensor((const char*)BinBuff, length);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief End the sensor file after the samples handed over so far.
+ */
+static void FinishSensorFile(void)
+{
+  if (SensorOffloadRunning() == true)
+  {
+    /* The encoder adds the size and CRC-32 of the file as its last record. */
+    SensorOffloadClose(Parameter.DeviceId);
+  }
+  else
+  {
+    FlushSensorFile();
+  }
+}
+
+/**
+ * @brief Store sensor data to SD card.
+ * 
+ * @param [in] pRecord Sensor data
+ * @param [in] length Length of pRecord
+ */
+static void StoreSensor(const char *pRecord, int length)
+{
+  if (length <= 0)
+  {
+    state = eStateError;
+    Led_isState();
+  }
+  else if (SensorOffloadRunning() == true)
+  {
+    /* Behind the samples handed to the encoder, in file order. */
+    SensorOffloadBytes(pRecord, length);
+  }
+  else
+  {
+    if (Parameter.SensorOutFile == true)
+    {
+      /* Binary blocks are larger than text lines, write out early if needed. */
+      if (SensorBuffLen + length > SENSORBUFF)
+      {
+        WriteSensorBuff();
+      }
+      else
+      {
+        /* do nothing. */
+      }
+
+      if (SensorBuffLen + length <= SENSORBUFF)
+      {
+        records_num += 1;
+        memcpy(&SensorBuff[SensorBuffLen], pRecord, length);
+        SensorBuffLen += length;
+      }
+      else
+      {
+        state = eStateWriteError;
+        Led_isState();
+      }
+
+      /* Counter Check to Write. */
+      if(records_num >= Parameter.StoreRecords)
+      {
+        WriteSensorBuff();
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+}
+
+/**
+ * @brief Write the buffered sensor records to the SD card.
+ */
+static void WriteSensorBuff(void)
+{
+  if (SensorBuffLen != 0)
+  {
+    /* The writer drops and counts records it has no room for or fails to write. */
+    write_size = WriteSD(SensorBuff, SensorBuffLen);
+    records_num = 0;
+    SensorBuffLen = 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Pass the blocks encoded by the encoder thread to the SD writer.
+ * 
+ * @param [in] wait true to wait for every block handed to the encoder, before the file is closed
+ */
+static void WriteOffload(boolean wait)
+{
+  const SensorOffloadBlock *pBlock;
+  SensorOffloadStat Offload;
+  boolean done;
+
+  if (SensorOffloadRunning() == true)
+  {
+    do
+    {
+      /* Blocks handed back before the commands were done are taken in this pass. */
+      done = (wait == false) || (SensorOffloadDone() == true);
+      while ((pBlock = SensorOffloadGet()) != NULL)
+      {
+        if (pBlock->file != SensorFileWritten)
+        {
+          /* First block of the next file, every block of the old file is queued. */
+          SensorOffloadGetStat(&Offload);
+          ReportOffloadFile(FileSensorOpen, Offload.last_bytes, Offload.last_crc);
+          SensorFileWritten = pBlock->file;
+          SwitchSensorFile();
+        }
+        else
+        {
+          /* do nothing. */
+        }
+
+        if (pBlock->length != 0)
+        {
+          /* The writer drops and counts records it has no room for. */
+          write_size = WriteSD((const char*)pBlock->out, pBlock->length);
+        }
+        else
+        {
+          /* do nothing. */
+        }
+        SensorOffloadRelease();
+      }
+      if (done == false)
+      {
+        /* The encoder may wait for a free block, it gets one from the pass above. */
+        delay(1);
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    } while (done == false);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Print the SD writer counters of the sensor file.
+ * 
+ * @param [in] closed true if the stream was closed, false if it switched files
+ */
+static void ReportSensorFile(boolean closed)
+{
+  SdStreamStat Stat;
+  SensorOffloadStat Offload;
+  char StatString[STRING_BUFFER_SIZE];
+
+  if (Parameter.SensorOutFile == true)
+  {
+    GetSDStat(&Stat);
+    snprintf(StatString, sizeof(StatString), "SD writes %lu, errors %lu, dropped %lu, queued max %lu/%d, stall max %lu us",
+             Stat.writes, Stat.errors, Stat.dropped, Stat.pending_max, SD_WRITE_BUFFER_NUM, Stat.stall_max_us);
+    Serial.println(StatString);
+    if ((closed == true) && (SensorOffloadRunning() == true))
+    {
+      /* Every block was written before the close. */
+      SensorOffloadGetStat(&Offload);
+      ReportOffloadFile(FileSensorOpen, Offload.bytes, Offload.crc);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    if ((closed == true) && (BenchRunning == true))
+    {
+      /* The next file counts from 0, keep the difference to the start. */
+      BenchSd.writes -= Stat.writes;
+      BenchSd.errors -= Stat.errors;
+      BenchSd.dropped -= Stat.dropped;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Print the size and CRC-32 of a sensor file written through the encoder.
+ * 
+ * @param [in] pName File name
+ * @param [in] bytes Bytes encoded for the file
+ * @param [in] crc CRC-32 of the bytes
+ */
+static void ReportOffloadFile(const char *pName, unsigned long bytes, uint32_t crc)
+{
+  char StatString[STRING_BUFFER_SIZE];
+
+  if (Parameter.SensorOutFile == true)
+  {
+    /* Compare with the file on the card, e.g. crc32 SENSOR*.BIN. */
+    snprintf(StatString, sizeof(StatString), "File %s bytes %lu, crc32 %08lx", pName, bytes, (unsigned long)crc);
+    Serial.println(StatString);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Print the SD writer counters of the closed NMEA file.
+ */
+static void ReportNmeaFile(void)
+{
+  SdStreamStat Stat;
+  char StatString[STRING_BUFFER_SIZE];
+
+  if ((NmeaFileOpen == true) || (NmeaOpenErrors != 0))
+  {
+    GetNmeaStat(&Stat);
+    snprintf(StatString, sizeof(StatString), "NMEA writes %lu, errors %lu, dropped %lu, open errors %lu",
+             Stat.writes, Stat.errors, Stat.dropped, NmeaOpenErrors);
+    Serial.println(StatString);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Print the SD writer counters of the activity summary file.
+ */
+static void ReportSummaryFile(void)
+{
+  SdStreamStat Stat;
+  char StatString[STRING_BUFFER_SIZE];
+
+  if (Parameter.ActivityWindow != 0)
+  {
+    GetSummaryStat(&Stat);
+    snprintf(StatString, sizeof(StatString), "Summary writes %lu, errors %lu, dropped %lu",
+             Stat.writes, Stat.errors, Stat.dropped);
+    Serial.println(StatString);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Print the burst counters and the SD writer counters of the burst file.
+ */
+static void ReportBurstFile(void)
+{
+  SdStreamStat Stat;
+  BurstStat Burst;
+  char StatString[STRING_BUFFER_SIZE];
+
+  if (Parameter.BurstTrigger != eBurstOff)
+  {
+    BurstGetStat(&Burst);
+    GetBurstStat(&Stat);
+    snprintf(StatString, sizeof(StatString), "Burst triggers %lu, extended %lu, missed %lu, samples %lu, dropped %lu",
+             (unsigned long)Burst.triggers, (unsigned long)Burst.extended, (unsigned long)Burst.missed,
+             (unsigned long)Burst.written, (unsigned long)Burst.dropped);
+    Serial.println(StatString);
+    snprintf(StatString, sizeof(StatString), "Burst writes %lu, errors %lu, dropped %lu",
+             Stat.writes, Stat.errors, Stat.dropped);
+    Serial.println(StatString);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Print the state of the timebase fit and the GNSS sessions.
+ */
+static void ReportTimebase(void)
+{
+  TimebaseStat Stat;
+  char StatString[STRING_BUFFER_SIZE];
+
+  GnssScheduleStat Gnss;
+
+  TimebaseGetStat(&Stat);
+  snprintf(StatString, sizeof(StatString), "Timebase fixes %lu, bins %d over %lu s, drift %ld +/- %ld ppb, residual %ld us, resets %lu",
+           Stat.fixes, Stat.bins, (unsigned long)(Stat.span_us / 1000000), Stat.rate_ppb, Stat.uncert_ppb,
+           Stat.residual_us, Stat.resets);
+  Serial.println(StatString);
+
+  GnssScheduleGetStat(&Gnss);
+  snprintf(StatString, sizeof(StatString), "GNSS sessions %lu, timeouts %lu, on %lu s, ttff %lu ms, energy %lu mJ",
+           Gnss.sessions, Gnss.timeouts, Gnss.on_ms / 1000, Gnss.ttff_ms, Gnss.energy_mj);
+  Serial.println(StatString);
+}
+
+/**
+ * @brief Measure the time from the last loop.
+ */
+static void MeasureLoop(void)
+{
+  unsigned long now_us = micros();
+  unsigned long loop_us = now_us - LoopLast_us;
+
+  if (LoopLast_us != 0)
+  {
+    if ((LoopNum == 0) || (loop_us < LoopMin_us))
+    {
+      LoopMin_us = loop_us;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    if (loop_us > LoopMax_us)
+    {
+      LoopMax_us = loop_us;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    LoopSum_us += loop_us;
+    LoopNum++;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  LoopLast_us = now_us;
+}
+
+/**
+ * @brief Print the loop time since the last report and start again.
+ */
+static void ReportLoop(void)
+{
+  char StatString[STRING_BUFFER_SIZE];
+
+  snprintf(StatString, sizeof(StatString), "Loop %lu times, min %lu us, avg %lu us, max %lu us",
+           LoopNum, LoopMin_us, (LoopNum != 0) ? (unsigned long)(LoopSum_us / LoopNum) : 0UL, LoopMax_us);
+  Serial.println(StatString);
+  LoopNum = 0;
+  LoopSum_us = 0;
+  LoopMin_us = 0;
+  LoopMax_us = 0;
+}
+
+/**
+ * @brief Print the counters of the tick tasks and start again.
+ */
+static void ReportTick(void)
+{
+  TickStat Stat;
+  char StatString[STRING_BUFFER_SIZE];
+  const char *pName;
+  int task;
+
+  for (task = 0; (pName = TickName(task)) != NULL; task++)
+  {
+    TickGetStat(task, &Stat);
+    snprintf(StatString, sizeof(StatString), "Task %s runs %lu, overruns %lu, late %lu/%lu us, exec %lu/%lu/%lu us",
+             pName, Stat.runs, Stat.overruns, Stat.late_avg_us, Stat.late_max_us,
+             Stat.exec_min_us, Stat.exec_avg_us, Stat.exec_max_us);
+    Serial.println(StatString);
+  }
+  TickClearStat();
+}
+
+/**
+ * @brief Print the time spent in each clock mode since boot.
+ */
+static void ReportPower(void)
+{
+  PowerStat Stat;
+  char StatString[STRING_BUFFER_SIZE];
+  unsigned char mode;
+
+  PowerGetStat(&Stat);
+  snprintf(StatString, sizeof(StatString), "Clock %u MHz, load %u %%, switches %lu, backlogs %lu",
+           PowerClockMHz(Stat.mode), Stat.load, Stat.switches, Stat.backlogs);
+  Serial.println(StatString);
+  for (mode = 0; mode < POWER_MODE_NUM; mode++)
+  {
+    snprintf(StatString, sizeof(StatString), "Clock %u MHz run %lu s, idle %lu s",
+             PowerClockMHz(mode), Stat.run_ms[mode] / 1000, Stat.idle_ms[mode] / 1000);
+    Serial.println(StatString);
+  }
+}
+
+/**
+ * @brief Print the performance counters. Called by the console.
+ */
+void ReportPerformance(void)
+{
+  SdStreamStat Stat;
+  SensorOffloadStat Offload;
+  SensorRingStat Ring;
+  char StatString[STRING_BUFFER_SIZE];
+
+  snprintf(StatString, sizeof(StatString), "State %d, file %d, records %lu, total %lu",
+           state, FileCount, seq, SampleTotal);
+  Serial.println(StatString);
+  ReportLoop();
+  ReportTick();
+  ReportPower();
+  GetSDStat(&Stat);
+  snprintf(StatString, sizeof(StatString), "SD writes %lu, errors %lu, dropped %lu, queued max %lu/%d, stall max %lu us",
+           Stat.writes, Stat.errors, Stat.dropped, Stat.pending_max, SD_WRITE_BUFFER_NUM, Stat.stall_max_us);
+  Serial.println(StatString);
+  snprintf(StatString, sizeof(StatString), "Samples queued max %d/%d, dropped %lu, timer ticks missed %lu",
+           SensorQueueMax(), SENSOR_QUEUE_SIZE, SensorQueueDropped(), SensorTickMissed);
+  Serial.println(StatString);
+  if (SensorOffloadRunning() == true)
+  {
+    SensorOffloadGetStat(&Offload);
+    snprintf(StatString, sizeof(StatString), "Encoder core %d, blocks %lu, dropped %lu, wakeups %lu, pending max %lu/%d, encode max %lu us",
+             SensorOffloadCore(), Offload.blocks, Offload.dropped, Offload.wakeups, Offload.pending_max, SENSOR_OFFLOAD_BLOCKS, Offload.encode_max_us);
+    Serial.println(StatString);
+    SensorRingGetStat(&Ring);
+    snprintf(StatString, sizeof(StatString), "Ring queued max %lu/%d, dropped %lu of %lu",
+             Ring.high_water, SENSOR_RING_SIZE, Ring.dropped, Ring.pushed);
+    Serial.println(StatString);
+    SensorRingClearStat();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  ReportNmeaFile();
+  ReportSummaryFile();
+  ReportBurstFile();
+}
+
+/**
+ * @brief Start a new file at the next loop. Called by the console.
+ * 
+ * @return true if accepted, false if the files are not being written
+ */
+boolean RequestRenewFile(void)
+{
+  if (state != eStateSensor)
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* The next interval starts at the requested file. */
+  TickStart(TaskFile, TimebaseNow() + Parameter.FileInterval * 60000000ULL);
+  state = eStateRenewFile;
+
+  return true;
+}
+
+/**
+ * @brief Start counting for a benchmark. Called by the console.
+ * 
+ * @param [in] sec Length of the benchmark [s]
+ * @return true if started, false if a benchmark runs
+ */
+boolean StartBenchmark(unsigned long sec)
+{
+  SensorRingStat Ring;
+
+  if (BenchRunning == true)
+  {
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  GetSDStat(&BenchSd);
+  BenchSamples = SampleTotal;
+  BenchQueueDropped = SensorQueueDropped();
+  SensorRingGetStat(&Ring);
+  BenchRingDropped = Ring.dropped;
+  BenchBegin_ms = millis();
+  BenchTime_ms = sec * 1000;
+  BenchRunning = true;
+  /* Loop time and maxima from the start of the benchmark. */
+  LoopNum = 0;
+  LoopSum_us = 0;
+  LoopMin_us = 0;
+  LoopMax_us = 0;
+  TickClearStat();
+  SensorQueueMax();
+  SensorRingClearStat();
+
+  return true;
+}
+
+/**
+ * @brief Print the counters of a benchmark that has ended.
+ */
+static void CheckBenchmark(void)
+{
+  SdStreamStat Stat;
+  SensorRingStat Ring;
+  char StatString[STRING_BUFFER_SIZE];
+  unsigned long elapsed_ms = millis() - BenchBegin_ms;
+  unsigned long samples;
+
+  if ((BenchRunning == false) || (elapsed_ms < BenchTime_ms))
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  BenchRunning = false;
+  samples = SampleTotal - BenchSamples;
+  GetSDStat(&Stat);
+  snprintf(StatString, sizeof(StatString), "Bench %lu ms, samples %lu, %lu.%02lu /s",
+           elapsed_ms, samples, (unsigned long)((unsigned long long)samples * 1000 / elapsed_ms),
+           (unsigned long)((unsigned long long)samples * 100000 / elapsed_ms % 100));
+  Serial.println(StatString);
+  ReportLoop();
+  ReportTick();
+  snprintf(StatString, sizeof(StatString), "SD writes %lu, errors %lu, dropped %lu, stall max %lu us",
+           Stat.writes - BenchSd.writes, Stat.errors - BenchSd.errors, Stat.dropped - BenchSd.dropped, Stat.stall_max_us);
+  Serial.println(StatString);
+  snprintf(StatString, sizeof(StatString), "Samples queued max %d/%d, dropped %lu",
+           SensorQueueMax(), SENSOR_QUEUE_SIZE, SensorQueueDropped() - BenchQueueDropped);
+  Serial.println(StatString);
+  if (SensorOffloadRunning() == true)
+  {
+    SensorRingGetStat(&Ring);
+    snprintf(StatString, sizeof(StatString), "Ring queued max %lu/%d, dropped %lu",
+             Ring.high_water, SENSOR_RING_SIZE, Ring.dropped - BenchRingDropped);
+    Serial.println(StatString);
+    SensorRingClearStat();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Make one sensor record.
+ * 
+ * @param [out] pRecord Sensor record
+ * @param [in] acc Acceleration X/Y/Z [counts]
+ * @param [in] interval_us Time interval [us]
+ * @param [in] count_us Counter when the sample was taken [us]
+ */
+static void getSensor(SensorRecord *pRecord, const signed short *acc, unsigned long interval_us, unsigned long long count_us)
+{
+  uint32_t sec;
+  uint32_t usec;
+
+  /* Counter converted with the fit to GNSS time, the RTC is not read. */
+  TimebaseToUtc(count_us, &sec, &usec);
+
+  pRecord->sec = sec + MY_TIMEZONE_IN_SECONDS;
+  pRecord->msec = usec / 1000;
+  pRecord->device = Parameter.DeviceId;
+  pRecord->seq = seq++;
+  SampleTotal++;
+  pRecord->interval_us = interval_us;
+  pRecord->acc[0] = acc[0];
+  pRecord->acc[1] = acc[1];
+  pRecord->acc[2] = acc[2];
+  pRecord->sens = kx122.get_sens();
+  pRecord->press = press_latest;
+}
+
+/**
+\ * @brief Activate GNSS device and Sensor modules.
+ */
+void setup(void)
+{
+  KX122_CONFIG AccConfig;
+
+  Watchdog.begin();
+  Watchdog.start(20000);
+
+  Led_isState();
+
+  /* Set serial baudeate. */
+  Serial.begin(SERIAL_BAUDRATE);
+  while (!Serial);
+
+  LowPower.begin();
+
+  /* Start the sample counter, it is fitted to the first GNSS fix. */
+  TimebaseBegin();
+  TimebaseNow();
+  PowerBegin();
+
+  /* Initialize gps */
+  SetupPositioning();
+  GnssScheduleBegin(Parameter.TimeErrorBound * 1000);
+  if (GnssBackupRestore() == true)
+  {
+    /* Ephemeris and time are known, the first fix is a hot start. */
+    GnssStart = eGnssStartRestored;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Initialize acceleration */
+  Wire.begin();
+  AccConfig.odr = Parameter.AccRate;
+  AccConfig.range = Parameter.AccRange;
+  if ((Parameter.BurstTrigger != eBurstOff) &&
+      (KX122::period_us(Parameter.BurstRate) < KX122::period_us(Parameter.AccRate)))
+  {
+    /* Sample at the burst rate, records are averaged down to AccRate. */
+    AccConfig.odr = Parameter.BurstRate;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  rc = kx122.init(&AccConfig);
+  if (rc != 0)
+  {
+    state = eStateError;
+    Led_isState();
+  }
+  else
+  {
+   /* do nothing. */
+  }
+
+  /* Poll the sensors at the output data rate. */
+  sensor_period_us = kx122.get_period_us();
+  SampleDecimate = KX122::period_us(Parameter.AccRate) / sensor_period_us;
+  if (SampleDecimate == 0)
+  {
+    SampleDecimate = 1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  record_period_us = sensor_period_us * SampleDecimate;
+
+  if (Parameter.BurstTrigger == eBurstWakeup)
+  {
+    /* Motion above the threshold on any axis, in 1/16 G steps. */
+    rc = kx122.init_wuf((unsigned char)min(max((Parameter.BurstThreshold * 16 + 500) / 1000, 1UL), 255UL),
+                        BURST_WUF_COUNT);
+    if (rc != 0)
+    {
+      state = eStateError;
+      Led_isState();
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (SENSOR_TRIGGER == eTriggerDrdy)
+  {
+    /* Timestamp each sample on the KX122 data ready pin. */
+    pinMode(SENSOR_DRDY_PIN, INPUT);
+    rc = kx122.init_drdy();
+    if (rc != 0)
+    {
+      state = eStateError;
+      Led_isState();
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (SENSOR_USE_BUFFER)
+  {
+    /* Store samples in the KX122 buffer between drains. */
+    rc = kx122.init_buf(SENSOR_FIFO_THRESHOLD);
+    if (rc != 0)
+    {
+      state = eStateError;
+      Led_isState();
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* barometer & temperature */
+  rc = bm1383aglv.init(SENSOR_PRESS_AVERAGE);
+  if (rc != 0)
+  {
+    state = eStateError;
+    Led_isState();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if ((SENSOR_OFFLOAD) && (Parameter.SensorOutFile == true))
+  {
+    /* Records are stored inline if the encoder does not start. */
+    SensorOffloadBegin();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Periodic tasks of the main loop, the sensor tasks start with a file. */
+  TaskAlive = TickAdd("alive", Led_isAlive, ALIVE_INTERVAL * 1000UL);
+  TaskFile = TickAdd("file", CheckFileRenew, Parameter.FileInterval * 60000000ULL);
+  TaskConsole = TickAdd("console", CommandProcessing, CONSOLE_INTERVAL * 1000UL);
+  TaskPress = TickAdd("press", PressureProcessing, Parameter.PressInterval * 1000UL);
+  if (SENSOR_TRIGGER == eTriggerPoll)
+  {
+    TaskSensor = TickAdd("sensor", SensorProcessing, SENSOR_FIFO_MODE ? SENSOR_FIFO_INTERVAL * 1000UL : sensor_period_us);
+  }
+  else if (SENSOR_TRIGGER == eTriggerDrdy)
+  {
+    TaskSensor = TickAdd("sensor", SensorQueueProcessing, SENSOR_FIFO_INTERVAL * 1000UL);
+  }
+  else
+  {
+    /* Twice per timer period, so the loop idles and a tick is read before the next one is queued. */
+    TaskSensor = TickAdd("sensor", SensorQueueProcessing, max(sensor_period_us / 2, 1UL));
+  }
+  TaskBurst = TickAdd("burst", BurstProcessing, BURST_INTERVAL * 1000UL);
+  TickStart(TaskAlive, TimebaseNow());
+  TickStart(TaskFile, TimebaseNow() + Parameter.FileInterval * 60000000ULL);
+  TickStart(TaskConsole, TimebaseNow());
+
+  ConsoleBegin();
+  state = eStateRenewFile;
+  Led_isState();
+}
+
+/**
+ * @brief Main loop
+ */
+void loop(void)
+{
+  SensorBinGnss Session;
+
+  Watchdog.kick();
+  MeasureLoop();
+  time_current = millis();
+  Led_isState();
+  UpdateTickPeriod();
+  /* Also keeps the counter extended while no samples are taken. */
+  TickRun(TimebaseNow());
+  /* Full clock for the file rotation and GNSS, and while the writers fall behind. */
+  PowerUpdate((state != eStateSensor) || (GnssActive == true),
+              (PendingSD() >= POWER_BACKLOG_SD) || (SensorRingCount() >= POWER_BACKLOG_RING));
+
+  switch(state)
+  {
+    case  eStateSensor:  /**< Loop is not activated */
+      if(state != state_last)
+      {
+        Gnss.stop();
+        Wire.begin();
+        OpenSensorFile();
+        GnssScheduleStop(TimebaseNow(), seq, &Session);
+        OutputGnss(&Session);
+        FlushNmea();
+        if ((NavData.posDataExist) && (TrackDue(TimebaseNow()) == true))
+        {
+          /* Position of the fix that corrected the time before the file was opened. */
+          OutputTrack((const SpNavData*)&NavData, TimebaseNow());
+        }
+        else
+        {
+          /* do nothing. */
+        }
+        GnssBackupSave(&NavData);
+        /* Read the pressure before the first record. */
+        TickStart(TaskPress, TimebaseNow());
+        if (SENSOR_USE_BUFFER)
+        {
+          /* Discard samples taken during GNSS time correction. */
+          kx122.clear_buf();
+        }
+        else
+        {
+          /* do nothing. */
+        }
+        /* Gravity is estimated again after a gap in the samples. */
+        ActivityBegin(&Activity, (record_period_us != 0) ? (Parameter.ActivityWindow * 1000000UL / record_period_us) : 0);
+        DecimateNum = 0;
+        DecimateInterval_us = 0;
+        DecimateSum[0] = DecimateSum[1] = DecimateSum[2] = 0;
+        if ((Parameter.BurstTrigger != eBurstOff) && (sensor_period_us != 0))
+        {
+          BurstBegin(Parameter.BurstTrigger, Parameter.BurstThreshold * kx122.get_sens() / 1000,
+                     Parameter.BurstPre * 1000UL / sensor_period_us, Parameter.BurstPost * 1000UL / sensor_period_us);
+          TickStart(TaskBurst, TimebaseNow());
+        }
+        else
+        {
+          /* do nothing. */
+        }
+        SensorTriggerBegin();
+        time_past_sensor = time_current;
+        TickStart(TaskSensor, TimebaseNow());
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      if (GnssActive == true)
+      {
+        GnssBackgroundProcessing();
+      }
+      else if ((GNSS_CONTINUOUS) && (GnssScheduleDue(TimebaseNow()) == true))
+      {
+        /* The predicted timestamp error reaches the bound. */
+        GnssBackgroundBegin();
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      WriteOffload(false);
+      if (SensorOffloadPending() == true)
+      {
+        /* Let the encoder run before the loop sleeps. */
+        sched_yield();
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      /* Task  */
+      state_last = eStateSensor;
+      break;
+
+    case  eStateRenewFile:
+      if ((GNSS_CONTINUOUS) && (TimeValid == true) && (state_last == eStateSensor))
+      {
+        /* Rotate the file without stopping the sensors, GNSS runs on its own schedule. */
+        RotateFiles();
+        state = eStateSensor;
+      }
+      else
+      {
+        if(state != state_last)
+        {
+          SensorTriggerEnd();
+          TickStop(TaskPress);
+          TickStop(TaskSensor);
+          TickStop(TaskBurst);
+          FinishSensorFile();
+          WriteOffload(true);
+          CloseSD();
+          ReportSensorFile(true);
+          CloseNmea();
+          ReportNmeaFile();
+          CloseSummaryFile();
+          CloseBurstFile();
+          ReportTimebase();
+          TimefixFlag = 0;
+          GnssActive = false;
+          RTC.end();
+          Gnss.stop();
+          Wire.end();
+        }
+        else
+        {
+          /* do nothing. */
+        }
+        UpdateFileNumber();
+        state_last = eStateRenewFile;
+        state = eStateGnssNonFix;
+      }
+      break;
+
+    case  eStateGnssNonFix:
+      if(state != state_last)
+      {
+        Wire.end();
+        Gnss.start(HOT_START);
+        GnssScheduleStart(TimebaseNow(), GnssStart);
+        GnssStart = eGnssStartHot;
+        RTC.begin();
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      GpsProcessing();
+      state_last = eStateGnssNonFix;
+      if(TimefixFlag == 1)
+      {
+        TimeValid = true;
+        state = eStateSensor;
+      }
+      break;
 
     default:
       state = eStateError;
       Led_isState();
       break;
   }
+
+  TickIdle();
 }
+
+#endif /* SUBCORE */
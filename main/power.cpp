@@ -0,0 +1,216 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file power.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Idle time and clock mode of the main core.
+ */
+
+#ifndef SUBCORE
+#include "power.h"
+
+/**
+ * @struct PowerMode
+ * @brief One clock mode
+ */
+typedef struct
+{
+  clockmode_e   clock;        /**< LowPower clock mode */
+  unsigned int  mhz;          /**< Frequency [MHz] */
+} PowerMode;
+
+/**
+ * @brief private variables
+ */
+static const PowerMode ModeList[POWER_MODE_NUM] =
+{
+  { CLOCK_MODE_156MHz, 156 },
+  { CLOCK_MODE_32MHz,  32  },
+  { CLOCK_MODE_8MHz,   8   },
+};
+
+static unsigned char Mode = 0;                /**< Current mode, index of ModeList */
+static unsigned char ModeMin = 0;             /**< Slowest mode used, index of ModeList */
+static uint64_t ModeBegin_us = 0;             /**< Counter when the mode was set [us] */
+static uint64_t WindowBegin_us = 0;           /**< Counter when the window started [us] */
+static uint64_t WindowIdle_us = 0;            /**< Time slept in the window [us] */
+static boolean WindowBacklog = false;         /**< Backlog seen in the window */
+static uint64_t Run_us[POWER_MODE_NUM];       /**< Time in each finished mode [us] */
+static uint64_t Idle_us[POWER_MODE_NUM];      /**< Time slept in each mode [us] */
+static unsigned long Switches = 0;
+static unsigned long Backlogs = 0;
+static unsigned char Load = 100;              /**< Load of the last window [%] */
+
+/**
+ * @brief Change the clock mode.
+ * 
+ * @param [in] mode Mode, index of ModeList
+ * @param [in] count_us Timebase counter [us]
+ */
+static void PowerSetMode(unsigned char mode, uint64_t count_us)
+{
+  Run_us[Mode] += count_us - ModeBegin_us;
+  ModeBegin_us = count_us;
+  Mode = mode;
+  LowPower.clockMode(ModeList[mode].clock);
+  Switches++;
+
+  /* Measure the new clock from now on. */
+  WindowBegin_us = count_us;
+  WindowIdle_us = 0;
+  WindowBacklog = false;
+}
+
+void PowerBegin(void)
+{
+  unsigned char mode;
+
+  ModeMin = 0;
+  for (mode = 0; mode < POWER_MODE_NUM; mode++)
+  {
+    Run_us[mode] = 0;
+    Idle_us[mode] = 0;
+    if (ModeList[mode].clock == POWER_CLOCK_MIN)
+    {
+      ModeMin = mode;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  Mode = 0;
+  LowPower.clockMode(ModeList[0].clock);
+  ModeBegin_us = TimebaseNow();
+  WindowBegin_us = ModeBegin_us;
+  WindowIdle_us = 0;
+  WindowBacklog = false;
+  Switches = 0;
+  Backlogs = 0;
+  Load = 100;
+}
+
+void PowerIdle(unsigned long ms)
+{
+  uint64_t begin_us = TimebaseNow();
+  uint64_t idle_us;
+
+  delay(ms);
+  idle_us = TimebaseNow() - begin_us;
+  WindowIdle_us += idle_us;
+  Idle_us[Mode] += idle_us;
+}
+
+void PowerUpdate(boolean boost, boolean backlog)
+{
+  uint64_t count_us = TimebaseNow();
+  uint64_t elapsed_us = count_us - WindowBegin_us;
+  unsigned long expected;
+
+  if ((backlog == true) && (Mode != 0))
+  {
+    /* The writer and the encoder run while the loop sleeps, the load does not show them. */
+    Backlogs++;
+    PowerSetMode(0, count_us);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  WindowBacklog = (WindowBacklog == true) || (backlog == true);
+
+  if (boost == true)
+  {
+    if (Mode != 0)
+    {
+      PowerSetMode(0, count_us);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    return;
+  }
+  else if (elapsed_us < (uint64_t)POWER_WINDOW_MS * 1000)
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  Load = (unsigned char)((elapsed_us - min(WindowIdle_us, elapsed_us)) * 100 / elapsed_us);
+  WindowBegin_us = count_us;
+  WindowIdle_us = 0;
+
+  if ((Load > POWER_LOAD_UP) && (Mode > 0))
+  {
+    PowerSetMode(Mode - 1, count_us);
+  }
+  else if ((WindowBacklog == false) && (Mode < ModeMin))
+  {
+    /* The busy time grows with the clock period. */
+    expected = (unsigned long)Load * ModeList[Mode].mhz / ModeList[Mode + 1].mhz;
+    if (expected < POWER_LOAD_DOWN)
+    {
+      PowerSetMode(Mode + 1, count_us);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  WindowBacklog = false;
+}
+
+unsigned int PowerClockMHz(unsigned char mode)
+{
+  return (mode < POWER_MODE_NUM) ? ModeList[mode].mhz : 0;
+}
+
+void PowerGetStat(PowerStat *pStat)
+{
+  uint64_t count_us = TimebaseNow();
+  unsigned char mode;
+
+  for (mode = 0; mode < POWER_MODE_NUM; mode++)
+  {
+    pStat->run_ms[mode] = (unsigned long)(Run_us[mode] / 1000);
+    pStat->idle_ms[mode] = (unsigned long)(Idle_us[mode] / 1000);
+  }
+  pStat->run_ms[Mode] += (unsigned long)((count_us - ModeBegin_us) / 1000);
+  pStat->switches = Switches;
+  pStat->backlogs = Backlogs;
+  pStat->load = Load;
+  pStat->mode = Mode;
+}
+
+#endif /* SUBCORE */
@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef _POWER_H_
+#define _POWER_H_
+
+/**
+ * @file power.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Idle time and clock mode of the main core.
+ * @details The main loop sleeps through PowerIdle until its next task is
+ *          due. The share of each POWER_WINDOW_MS that was not slept is the
+ *          load. The clock steps down when the load, scaled to the lower
+ *          clock, stays below POWER_LOAD_DOWN, and steps up when the load
+ *          exceeds POWER_LOAD_UP. A backlog of the SD writer or the encoder
+ *          returns to the fastest clock and keeps the clock for the window,
+ *          their time is not seen by PowerIdle. While boosted (file
+ *          rotation, GNSS) the fastest clock is used. Called from the main
+ *          loop only.
+ */
+
+#include <stdint.h>
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define POWER_WINDOW_MS        1000           /**< [ms] Load measured over this time before the clock changes */
+#define POWER_LOAD_UP          70             /**< [%] Higher load steps the clock up */
+#define POWER_LOAD_DOWN        40             /**< [%] Load expected at the lower clock must be lower to step down */
+#define POWER_CLOCK_MIN        CLOCK_MODE_8MHz /**< Slowest clock used, CLOCK_MODE_156MHz keeps the clock */
+#define POWER_MODE_NUM         3              /**< 156 MHz, 32 MHz, 8 MHz */
+#define POWER_BACKLOG_SD       2              /**< SD buffers queued to the writer that count as a backlog */
+#define POWER_BACKLOG_RING     (SENSOR_RING_SIZE / 4) /**< Samples queued to the encoder that count as a backlog */
+
+/**
+ * @struct PowerStat
+ * @brief Time spent in each clock mode
+ */
+typedef struct
+{
+  unsigned long run_ms[POWER_MODE_NUM];   /**< Time in each mode, fastest first [ms] */
+  unsigned long idle_ms[POWER_MODE_NUM];  /**< Part of run_ms slept in PowerIdle [ms] */
+  unsigned long switches;                 /**< Clock changes */
+  unsigned long backlogs;                 /**< Clock raised for a backlog of the SD writer or the encoder */
+  unsigned char load;                     /**< Load of the last window [%] */
+  unsigned char mode;                     /**< Current mode, 0 is the fastest */
+} PowerStat;
+
+/**
+ * @brief Start at the fastest clock and clear the counters.
+ */
+void PowerBegin(void);
+
+/**
+ * @brief Sleep the main loop.
+ * 
+ * @param [in] ms Time to sleep [ms]
+ */
+void PowerIdle(unsigned long ms);
+
+/**
+ * @brief Measure the load and change the clock at the end of a window.
+ * 
+ * @param [in] boost true to use the fastest clock now
+ * @param [in] backlog true if the SD writer or the encoder falls behind
+ */
+void PowerUpdate(boolean boost, boolean backlog);
+
+/**
+ * @brief Get the clock frequency of a mode.
+ * 
+ * @param [in] mode Mode, 0 is the fastest
+ * @return Frequency [MHz]
+ */
+unsigned int PowerClockMHz(unsigned char mode);
+
+/**
+ * @brief Get the time spent in each clock mode.
+ * 
+ * @param [out] pStat Counters
+ */
+void PowerGetStat(PowerStat *pStat);
+
+#endif /* _POWER_H_ */
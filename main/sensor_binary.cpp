@@ -0,0 +1,664 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sensor_binary.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Compact binary sensor log format.
+ * @details Block record:
+ *          tag(type, num, length) seq(4) sec(4) msec(2) reserved(2) press(4)
+ *          then num samples of toff_ms(2) interval_us(4) x(2) y(2) z(2).
+ *          Version 1 files have interval_ms(2) instead of interval_us(4).
+ *          toff_ms is the time from the first sample of the block.
+ */
+
+#include <string.h>
+#include "sensor_binary.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define SENSOR_BIN_TOFF_MAX    0xFFFF         /**< Max time offset in a block [ms] */
+
+/**
+ * @brief Little endian field access.
+ */
+static uint8_t *PutU16(uint8_t *p, uint16_t value)
+{
+  *p++ = (uint8_t)value;
+  *p++ = (uint8_t)(value >> 8);
+  return p;
+}
+
+static uint8_t *PutU32(uint8_t *p, uint32_t value)
+{
+  p = PutU16(p, (uint16_t)value);
+  return PutU16(p, (uint16_t)(value >> 16));
+}
+
+static uint16_t GetU16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t GetU32(const uint8_t *p)
+{
+  return (uint32_t)GetU16(p) | ((uint32_t)GetU16(p + 2) << 16);
+}
+
+/**
+ * @brief Write a record tag.
+ * 
+ * @param [out] p %Buffer
+ * @param [in] type Record type
+ * @param [in] num Count field
+ * @param [in] length Bytes following the tag
+ * @return Pointer past the tag
+ */
+static uint8_t *PutTag(uint8_t *p, uint8_t type, uint8_t num, uint16_t length)
+{
+  *p++ = type;
+  *p++ = num;
+  return PutU16(p, length);
+}
+
+int SensorBinWriteHead(uint8_t *pBuff, const SensorBinHead *pHead)
+{
+  uint8_t *p = pBuff;
+
+  memcpy(p, SENSOR_BIN_MAGIC, 4);
+  p += 4;
+  p = PutU16(p, pHead->version);
+  p = PutU16(p, SENSOR_BIN_HEADER_SIZE);
+  p = PutU16(p, pHead->device);
+  *p++ = pHead->odr;
+  *p++ = pHead->range;
+  p = PutU16(p, pHead->sens);
+  p = PutU16(p, pHead->press_per_hpa);
+  p = PutU32(p, pHead->period_us);
+  p = PutU32(p, pHead->start_sec);
+  p = PutU16(p, pHead->start_msec);
+  p = PutU16(p, 0);
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinReadHead(const uint8_t *pBuff, SensorBinHead *pHead)
+{
+  if ((memcmp(pBuff, SENSOR_BIN_MAGIC, 4) != 0) || (GetU16(&pBuff[6]) < SENSOR_BIN_HEADER_SIZE))
+  {
+    return -1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pHead->version       = GetU16(&pBuff[4]);
+  pHead->device        = GetU16(&pBuff[8]);
+  pHead->odr           = pBuff[10];
+  pHead->range         = pBuff[11];
+  pHead->sens          = GetU16(&pBuff[12]);
+  pHead->press_per_hpa = GetU16(&pBuff[14]);
+  pHead->period_us     = GetU32(&pBuff[16]);
+  pHead->start_sec     = GetU32(&pBuff[20]);
+  pHead->start_msec    = GetU16(&pBuff[24]);
+
+  return 0;
+}
+
+uint8_t *SensorBinWriteBlockHead(uint8_t *pBuff, uint8_t type, int num, int length,
+                                 uint32_t seq, uint32_t sec, uint16_t msec, uint32_t press)
+{
+  uint8_t *p;
+
+  p = PutTag(pBuff, type, (uint8_t)num, (uint16_t)length);
+  p = PutU32(p, seq);
+  p = PutU32(p, sec);
+  p = PutU16(p, msec);
+  p = PutU16(p, 0);
+  p = PutU32(p, press);
+
+  return p;
+}
+
+void SensorBinReadBlockHead(const uint8_t *pBuff, const SensorBinHead *pHead, SensorRecord *pRecord)
+{
+  pRecord->sec      = GetU32(&pBuff[8]);
+  pRecord->msec     = GetU16(&pBuff[12]);
+  pRecord->device   = pHead->device;
+  pRecord->seq      = GetU32(&pBuff[4]);
+  pRecord->sens     = pHead->sens;
+  pRecord->press    = GetU32(&pBuff[16]);
+}
+
+void SensorBinReset(SensorBinBlock *pBlock)
+{
+  pBlock->num = 0;
+}
+
+/**
+ * @brief Time from the first sample of the block.
+ * 
+ * @param [in] pBlock Block
+ * @param [in] pRecord Sample
+ * @return Time offset [ms], SENSOR_BIN_TOFF_MAX + 1 if out of range
+ */
+static uint32_t BlockOffset(const SensorBinBlock *pBlock, const SensorRecord *pRecord)
+{
+  int32_t diff = ((int32_t)(pRecord->sec - pBlock->sec)) * 1000 + ((int32_t)pRecord->msec - pBlock->msec);
+
+  if ((diff < 0) || (diff > SENSOR_BIN_TOFF_MAX))
+  {
+    return SENSOR_BIN_TOFF_MAX + 1;
+  }
+  else
+  {
+    return (uint32_t)diff;
+  }
+}
+
+int SensorBinFlush(SensorBinBlock *pBlock, uint8_t *pBuff)
+{
+  int length;
+
+  if (pBlock->num == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  length = SENSOR_BIN_BLOCK_HEAD + pBlock->num * SENSOR_BIN_SAMPLE_SIZE;
+  SensorBinWriteBlockHead(pBlock->buff, eBinBlock, pBlock->num, length,
+                          pBlock->seq - pBlock->num, pBlock->sec, pBlock->msec, pBlock->press);
+
+  length += SENSOR_BIN_TAG_SIZE;
+  memcpy(pBuff, pBlock->buff, length);
+  pBlock->num = 0;
+
+  return length;
+}
+
+int SensorBinPut(SensorBinBlock *pBlock, const SensorRecord *pRecord, uint8_t *pBuff)
+{
+  uint8_t *p;
+  uint32_t toff = 0;
+  int length = 0;
+
+  if (pBlock->num != 0)
+  {
+    toff = BlockOffset(pBlock, pRecord);
+    if ((pBlock->num >= SENSOR_BIN_BLOCK_NUM) || (pBlock->press != pRecord->press) ||
+        (pBlock->seq != pRecord->seq) || (toff > SENSOR_BIN_TOFF_MAX))
+    {
+      length = SensorBinFlush(pBlock, pBuff);
+      toff = 0;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (pBlock->num == 0)
+  {
+    pBlock->sec = pRecord->sec;
+    pBlock->msec = pRecord->msec;
+    pBlock->press = pRecord->press;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  p = &pBlock->buff[SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD + pBlock->num * SENSOR_BIN_SAMPLE_SIZE];
+  p = PutU16(p, (uint16_t)toff);
+  p = PutU32(p, pRecord->interval_us);
+  p = PutU16(p, (uint16_t)pRecord->acc[0]);
+  p = PutU16(p, (uint16_t)pRecord->acc[1]);
+  p = PutU16(p, (uint16_t)pRecord->acc[2]);
+  pBlock->num++;
+  pBlock->seq = pRecord->seq + 1;
+
+  return length;
+}
+
+int SensorBinWriteJitter(uint8_t *pBuff, const SensorBinJitter *pJitter)
+{
+  uint8_t *p;
+
+  p = PutTag(pBuff, eBinJitter, 0, SENSOR_BIN_JITTER_SIZE - SENSOR_BIN_TAG_SIZE);
+  p = PutU32(p, pJitter->seq);
+  p = PutU32(p, pJitter->num);
+  p = PutU32(p, pJitter->min_us);
+  p = PutU32(p, pJitter->max_us);
+  p = PutU32(p, pJitter->dropped);
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinWriteTime(uint8_t *pBuff, const SensorBinTime *pTime)
+{
+  uint8_t *p;
+
+  p = PutTag(pBuff, eBinTime, 0, SENSOR_BIN_TIME_SIZE - SENSOR_BIN_TAG_SIZE);
+  p = PutU32(p, pTime->seq);
+  p = PutU32(p, pTime->sec);
+  p = PutU16(p, pTime->msec);
+  *p++ = pTime->type;
+  *p++ = 0;
+  p = PutU32(p, (uint32_t)pTime->offset_us);
+  p = PutU32(p, (uint32_t)pTime->adjust_us);
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinWriteGnss(uint8_t *pBuff, const SensorBinGnss *pGnss)
+{
+  uint8_t *p;
+
+  p = PutTag(pBuff, eBinGnss, 0, SENSOR_BIN_GNSS_SIZE - SENSOR_BIN_TAG_SIZE);
+  p = PutU32(p, pGnss->seq);
+  p = PutU32(p, pGnss->ttff_ms);
+  p = PutU32(p, pGnss->on_ms);
+  p = PutU16(p, pGnss->fixes);
+  *p++ = pGnss->result;
+  *p++ = pGnss->start;
+  p = PutU32(p, (uint32_t)pGnss->error_us);
+  p = PutU32(p, (uint32_t)pGnss->residual_us);
+  p = PutU32(p, pGnss->energy_mj);
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinWriteTrack(uint8_t *pBuff, const SensorBinTrack *pTrack)
+{
+  uint8_t *p;
+
+  p = PutTag(pBuff, eBinTrack, 0, SENSOR_BIN_TRACK_SIZE - SENSOR_BIN_TAG_SIZE);
+  p = PutU32(p, pTrack->seq);
+  p = PutU32(p, pTrack->sec);
+  p = PutU16(p, pTrack->msec);
+  *p++ = pTrack->mode;
+  *p++ = pTrack->sats;
+  p = PutU32(p, (uint32_t)pTrack->lat);
+  p = PutU32(p, (uint32_t)pTrack->lon);
+  p = PutU32(p, (uint32_t)pTrack->alt_cm);
+  p = PutU16(p, pTrack->hdop);
+  p = PutU16(p, pTrack->speed_cms);
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinWriteBurst(uint8_t *pBuff, const SensorBinBurst *pBurst)
+{
+  uint8_t *p;
+  int cnt;
+
+  p = PutTag(pBuff, eBinBurst, pBurst->num, SENSOR_BIN_BURST_HEAD + pBurst->num * 6);
+  p = PutU32(p, pBurst->trigger);
+  p = PutU32(p, (uint32_t)pBurst->index);
+  p = PutU32(p, pBurst->sec);
+  p = PutU32(p, pBurst->usec);
+  p = PutU32(p, pBurst->period_us);
+  for (cnt = 0; cnt < pBurst->num; cnt++)
+  {
+    p = PutU16(p, (uint16_t)pBurst->acc[cnt][0]);
+    p = PutU16(p, (uint16_t)pBurst->acc[cnt][1]);
+    p = PutU16(p, (uint16_t)pBurst->acc[cnt][2]);
+  }
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinWriteClose(uint8_t *pBuff, const SensorBinClose *pClose)
+{
+  uint8_t *p;
+
+  p = PutTag(pBuff, eBinClose, 0, SENSOR_BIN_CLOSE_SIZE - SENSOR_BIN_TAG_SIZE);
+  p = PutU32(p, pClose->bytes);
+  p = PutU32(p, pClose->crc);
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinReadTag(const uint8_t *pBuff, uint8_t *type, uint8_t *num)
+{
+  *type = pBuff[0];
+  *num = pBuff[1];
+  return SENSOR_BIN_TAG_SIZE + GetU16(&pBuff[2]);
+}
+
+void SensorBinReadSample(const uint8_t *pBuff, int index, const SensorBinHead *pHead, SensorRecord *pRecord)
+{
+  const uint8_t *p;
+  uint32_t msec;
+
+  SensorBinReadBlockHead(pBuff, pHead, pRecord);
+  if (pHead->version < 2)
+  {
+    p = &pBuff[SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD + index * SENSOR_BIN_SAMPLE_SIZE_V1];
+    pRecord->interval_us = (uint32_t)GetU16(&p[2]) * 1000;
+  }
+  else
+  {
+    p = &pBuff[SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD + index * SENSOR_BIN_SAMPLE_SIZE];
+    pRecord->interval_us = GetU32(&p[2]);
+  }
+  msec = pRecord->msec + GetU16(&p[0]);
+  p += (pHead->version < 2) ? 4 : 6;
+
+  pRecord->sec     += msec / 1000;
+  pRecord->msec     = msec % 1000;
+  pRecord->seq     += index;
+  pRecord->acc[0]   = (int16_t)GetU16(&p[0]);
+  pRecord->acc[1]   = (int16_t)GetU16(&p[2]);
+  pRecord->acc[2]   = (int16_t)GetU16(&p[4]);
+}
+
+void SensorBinReadJitter(const uint8_t *pBuff, SensorBinJitter *pJitter)
+{
+  pJitter->seq     = GetU32(&pBuff[4]);
+  pJitter->num     = GetU32(&pBuff[8]);
+  pJitter->min_us  = GetU32(&pBuff[12]);
+  pJitter->max_us  = GetU32(&pBuff[16]);
+  pJitter->dropped = GetU32(&pBuff[20]);
+}
+
+void SensorBinReadTime(const uint8_t *pBuff, SensorBinTime *pTime)
+{
+  pTime->seq       = GetU32(&pBuff[4]);
+  pTime->sec       = GetU32(&pBuff[8]);
+  pTime->msec      = GetU16(&pBuff[12]);
+  pTime->type      = pBuff[14];
+  pTime->offset_us = (int32_t)GetU32(&pBuff[16]);
+  pTime->adjust_us = (int32_t)GetU32(&pBuff[20]);
+}
+
+void SensorBinReadGnss(const uint8_t *pBuff, SensorBinGnss *pGnss)
+{
+  pGnss->seq         = GetU32(&pBuff[4]);
+  pGnss->ttff_ms     = GetU32(&pBuff[8]);
+  pGnss->on_ms       = GetU32(&pBuff[12]);
+  pGnss->fixes       = GetU16(&pBuff[16]);
+  pGnss->result      = pBuff[18];
+  pGnss->start       = pBuff[19];
+  pGnss->error_us    = (int32_t)GetU32(&pBuff[20]);
+  pGnss->residual_us = (int32_t)GetU32(&pBuff[24]);
+  pGnss->energy_mj   = GetU32(&pBuff[28]);
+}
+
+void SensorBinReadBurst(const uint8_t *pBuff, SensorBinBurst *pBurst)
+{
+  const uint8_t *p = &pBuff[SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BURST_HEAD];
+  int cnt;
+
+  pBurst->num       = (pBuff[1] > SENSOR_BIN_BURST_NUM) ? SENSOR_BIN_BURST_NUM : pBuff[1];
+  pBurst->trigger   = GetU32(&pBuff[4]);
+  pBurst->index     = (int32_t)GetU32(&pBuff[8]);
+  pBurst->sec       = GetU32(&pBuff[12]);
+  pBurst->usec      = GetU32(&pBuff[16]);
+  pBurst->period_us = GetU32(&pBuff[20]);
+  for (cnt = 0; cnt < pBurst->num; cnt++)
+  {
+    pBurst->acc[cnt][0] = (int16_t)GetU16(&p[0]);
+    pBurst->acc[cnt][1] = (int16_t)GetU16(&p[2]);
+    pBurst->acc[cnt][2] = (int16_t)GetU16(&p[4]);
+    p += 6;
+  }
+}
+
+void SensorBinReadClose(const uint8_t *pBuff, SensorBinClose *pClose)
+{
+  pClose->bytes = GetU32(&pBuff[4]);
+  pClose->crc   = GetU32(&pBuff[8]);
+}
+
+void SensorBinReadTrack(const uint8_t *pBuff, SensorBinTrack *pTrack)
+{
+  pTrack->seq       = GetU32(&pBuff[4]);
+  pTrack->sec       = GetU32(&pBuff[8]);
+  pTrack->msec      = GetU16(&pBuff[12]);
+  pTrack->mode      = pBuff[14];
+  pTrack->sats      = pBuff[15];
+  pTrack->lat       = (int32_t)GetU32(&pBuff[16]);
+  pTrack->lon       = (int32_t)GetU32(&pBuff[20]);
+  pTrack->alt_cm    = (int32_t)GetU32(&pBuff[24]);
+  pTrack->hdop      = GetU16(&pBuff[28]);
+  pTrack->speed_cms = GetU16(&pBuff[30]);
+}
+
+int SensorBinFormatTrack(char *pBuff, int size, uint16_t device, const SensorBinTrack *pTrack)
+{
+  static const char Sign[] = SENSOR_TRACK_SIGN ",0x";
+  static const char Hex[] = "0123456789ABCDEF";
+  char *p = pBuff;
+  int cnt;
+
+  if (size < SENSOR_TRACK_MAX)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Set Header. */
+  for (cnt = 0; Sign[cnt] != '\0'; cnt++)
+  {
+    *p++ = Sign[cnt];
+  }
+  for (cnt = 12; cnt >= 0; cnt -= 4)
+  {
+    *p++ = Hex[(device >> cnt) & 0x0F];
+  }
+  *p++ = ',';
+
+  p = FormatSensorTime(p, pTrack->sec, pTrack->msec);
+  *p++ = ',';
+
+  p = FormatUint(p, pTrack->seq, 1);
+  *p++ = ',';
+
+  *p++ = (pTrack->mode == 3) ? '3' : '2';
+  *p++ = 'D';
+  *p++ = ',';
+
+  p = FormatFixed(p, pTrack->lat, 7);
+  *p++ = ',';
+  p = FormatFixed(p, pTrack->lon, 7);
+  *p++ = ',';
+  p = FormatFixed(p, pTrack->alt_cm, 2);
+  *p++ = ',';
+  p = FormatFixed(p, pTrack->hdop, 2);
+  *p++ = ',';
+  p = FormatUint(p, pTrack->sats, 1);
+  *p++ = ',';
+  p = FormatFixed(p, pTrack->speed_cms, 2);
+
+  *p++ = '\n';
+  *p = '\0';
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinFormatBurst(char *pBuff, int size, uint16_t device, uint16_t sens, const SensorBinBurst *pBurst, int index)
+{
+  static const char Sign[] = SENSOR_BURST_SIGN ",0x";
+  static const char Hex[] = "0123456789ABCDEF";
+  char *p = pBuff;
+  uint64_t usec;
+  long acc;
+  int cnt;
+
+  if (size < SENSOR_BURST_MAX)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Set Header. */
+  for (cnt = 0; Sign[cnt] != '\0'; cnt++)
+  {
+    *p++ = Sign[cnt];
+  }
+  for (cnt = 12; cnt >= 0; cnt -= 4)
+  {
+    *p++ = Hex[(device >> cnt) & 0x0F];
+  }
+  *p++ = ',';
+
+  usec = pBurst->usec + (uint64_t)pBurst->period_us * index;
+  p = FormatSensorTime(p, pBurst->sec + (uint32_t)(usec / 1000000), (uint16_t)(usec % 1000000 / 1000));
+  *p++ = ',';
+
+  p = FormatUint(p, pBurst->trigger, 1);
+  *p++ = ',';
+  p = FormatFixed(p, pBurst->index + index, 0);
+
+  /* Acceleration [G] with 1 [mG] resolution, the same as the sensor records. */
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    *p++ = ',';
+    acc = pBurst->acc[index][cnt];
+    if (acc < 0)
+    {
+      *p++ = '-';
+      acc = -acc;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    p = FormatFixed(p, (sens != 0) ? DivRound(acc * 1000, sens) : 0, 3);
+  }
+
+  *p++ = '\n';
+  *p = '\0';
+
+  return (int)(p - pBuff);
+}
+
+int SensorBinFormatClose(char *pBuff, int size, uint16_t device, const SensorBinClose *pClose)
+{
+  static const char Sign[] = SENSOR_CLOSE_SIGN ",0x";
+  static const char Hex[] = "0123456789ABCDEF";
+  char *p = pBuff;
+  int cnt;
+
+  if (size < SENSOR_CLOSE_MAX)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Set Header. */
+  for (cnt = 0; Sign[cnt] != '\0'; cnt++)
+  {
+    *p++ = Sign[cnt];
+  }
+  for (cnt = 12; cnt >= 0; cnt -= 4)
+  {
+    *p++ = Hex[(device >> cnt) & 0x0F];
+  }
+  *p++ = ',';
+
+  p = FormatUint(p, pClose->bytes, 1);
+  *p++ = ',';
+  for (cnt = 28; cnt >= 0; cnt -= 4)
+  {
+    *p++ = Hex[(pClose->crc >> cnt) & 0x0F];
+  }
+
+  *p++ = '\n';
+  *p = '\0';
+
+  return (int)(p - pBuff);
+}
+
+uint32_t SensorBinCrc32(uint32_t crc, const uint8_t *pBuff, uint32_t length)
+{
+  static const uint32_t Table[16] =
+  {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+  };
+  uint32_t cnt;
+
+  crc = ~crc;
+  for (cnt = 0; cnt < length; cnt++)
+  {
+    crc ^= pBuff[cnt];
+    crc = (crc >> 4) ^ Table[crc & 0x0F];
+    crc = (crc >> 4) ^ Table[crc & 0x0F];
+  }
+
+  return ~crc;
+}
+
+const char *SensorBinTimeName(uint8_t type)
+{
+  switch (type)
+  {
+    case eTimeStep:
+      return "STEP";
+
+    case eTimeSlew:
+      return "SLEW";
+
+    case eTimeFit:
+    default:
+      return "FIT";
+  }
+}
+
+const char *SensorBinGnssStartName(uint8_t start)
+{
+  switch (start)
+  {
+    case eGnssStartBoot:
+      return "BOOT";
+
+    case eGnssStartRestored:
+      return "RESTORED";
+
+    case eGnssStartHot:
+    default:
+      return "HOT";
+  }
+}
@@ -0,0 +1,500 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _SENSOR_BINARY_H_
+#define _SENSOR_BINARY_H_
+
+/**
+ * @file sensor_binary.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Compact binary sensor log format.
+ * @details A file starts with a versioned header followed by tagged records.
+ *          Each record starts with a 4 byte tag (type, count, length), so
+ *          readers can skip types they do not know. All values are little
+ *          endian. This file is shared with the host side converter.
+ */
+
+#include <stdint.h>
+#include "sensor_format.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define SENSOR_BIN_MAGIC       "SNSR"         /**< File magic */
+#define SENSOR_BIN_VERSION     2              /**< Format version, 1 stored the interval in [ms] */
+#define SENSOR_BIN_HEADER_SIZE 28             /**< File header size */
+#define SENSOR_BIN_TAG_SIZE    4              /**< Record tag size */
+#define SENSOR_BIN_BLOCK_HEAD  16             /**< Block header size after the tag */
+#define SENSOR_BIN_SAMPLE_SIZE 12             /**< Sample size in a block */
+#define SENSOR_BIN_SAMPLE_SIZE_V1 10          /**< Sample size in a block of version 1 */
+#define SENSOR_BIN_BLOCK_NUM   20             /**< Max samples per block */
+#define SENSOR_BIN_BLOCK_MAX   (SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD + SENSOR_BIN_BLOCK_NUM * SENSOR_BIN_SAMPLE_SIZE)
+#define SENSOR_BIN_JITTER_SIZE (SENSOR_BIN_TAG_SIZE + 20) /**< Jitter record size */
+#define SENSOR_BIN_TIME_SIZE   (SENSOR_BIN_TAG_SIZE + 20) /**< Time correction record size */
+#define SENSOR_BIN_GNSS_SIZE   (SENSOR_BIN_TAG_SIZE + 28) /**< GNSS session record size */
+#define SENSOR_BIN_TRACK_SIZE  (SENSOR_BIN_TAG_SIZE + 28) /**< Position fix record size */
+#define SENSOR_TRACK_SIGN      "$P00300"      /**< Position fix line sign name */
+#define SENSOR_TRACK_MAX       112            /**< Longest possible position fix line */
+#define SENSOR_BIN_BURST_HEAD  20             /**< Burst header size after the tag */
+#define SENSOR_BIN_BURST_NUM   80             /**< Max samples per burst record */
+#define SENSOR_BIN_BURST_MAX   (SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BURST_HEAD + SENSOR_BIN_BURST_NUM * 6)
+#define SENSOR_BURST_SIGN      "$B00300"      /**< Burst sample line sign name */
+#define SENSOR_BURST_MAX       96             /**< Longest possible burst sample line */
+#define SENSOR_BIN_CLOSE_SIZE  (SENSOR_BIN_TAG_SIZE + 8) /**< File close record size */
+#define SENSOR_CLOSE_SIGN      "$C00300"      /**< File close line sign name */
+#define SENSOR_CLOSE_MAX       40             /**< Longest possible file close line */
+
+/**
+ * @enum SensorBinType
+ * @brief Record types
+ */
+enum SensorBinType
+{
+  eBinBlock  = 0x01,  /**< Acceleration samples sharing one pressure value */
+  eBinJitter = 0x02,  /**< Interval jitter of an interrupt block */
+  eBinDelta  = 0x03,  /**< Delta coded samples, see sensor_codec.h */
+  eBinTime   = 0x04,  /**< Time correction from GNSS */
+  eBinGnss   = 0x05,  /**< GNSS session */
+  eBinTrack  = 0x06,  /**< Position fix */
+  eBinBurst  = 0x07,  /**< Full rate samples around a trigger */
+  eBinClose  = 0x08,  /**< Size and CRC-32 of the file before the record */
+};
+
+/**
+ * @enum SensorTimeType
+ * @brief Time correction types
+ */
+enum SensorTimeType
+{
+  eTimeStep = 0,      /**< Time set to the GNSS time */
+  eTimeSlew = 1,      /**< RTC moved by a limited amount */
+  eTimeFit  = 2,      /**< GNSS fix added to the timebase fit */
+};
+
+/**
+ * @enum SensorGnssResult
+ * @brief GNSS session results
+ */
+enum SensorGnssResult
+{
+  eGnssFixed   = 0,   /**< Time corrected */
+  eGnssTimeout = 1,   /**< No fix before the timeout */
+};
+
+/**
+ * @enum SensorGnssStart
+ * @brief How a GNSS session was started
+ */
+enum SensorGnssStart
+{
+  eGnssStartHot      = 0, /**< While logging, with the receiver state in memory */
+  eGnssStartBoot     = 1, /**< First start after power on without a usable backup */
+  eGnssStartRestored = 2, /**< First start after power on with the backup restored */
+};
+
+/**
+ * @struct SensorBinHead
+ * @brief File header
+ */
+typedef struct
+{
+  uint16_t version;       /**< Format version */
+  uint16_t device;        /**< Device number */
+  uint8_t  odr;           /**< KX122_ODCNTL_OSA_xxx */
+  uint8_t  range;         /**< KX122_CNTL1_GSEL_xxx */
+  uint16_t sens;          /**< Acceleration counts per G */
+  uint16_t press_per_hpa; /**< Pressure counts per hPa */
+  uint32_t period_us;     /**< Sample period [us] */
+  uint32_t start_sec;     /**< File start time [s since 1970/01/01] */
+  uint16_t start_msec;    /**< File start time [ms] */
+} SensorBinHead;
+
+/**
+ * @struct SensorBinJitter
+ * @brief Interval jitter of one interrupt block
+ */
+typedef struct
+{
+  uint32_t seq;           /**< Sequence number of the first sample */
+  uint32_t num;           /**< Samples in the block */
+  uint32_t min_us;        /**< Shortest interval [us] */
+  uint32_t max_us;        /**< Longest interval [us] */
+  uint32_t dropped;       /**< Timestamps dropped so far */
+} SensorBinJitter;
+
+/**
+ * @struct SensorBinTime
+ * @brief One time correction
+ * @details eTimeFit records carry the fitted drift in adjust_us [ppb].
+ */
+typedef struct
+{
+  uint32_t seq;           /**< Sequence number of the next sample */
+  uint32_t sec;           /**< Time before the correction [s since 1970/01/01] */
+  uint16_t msec;          /**< Time before the correction [ms] */
+  uint8_t  type;          /**< SensorTimeType */
+  int32_t  offset_us;     /**< Time minus GNSS time [us] */
+  int32_t  adjust_us;     /**< Amount taken off the time [us] */
+} SensorBinTime;
+
+/**
+ * @struct SensorBinGnss
+ * @brief One GNSS session
+ */
+typedef struct
+{
+  uint32_t seq;           /**< Sequence number of the next sample after GNSS stopped */
+  uint32_t ttff_ms;       /**< Time to the first fix, 0 without a fix [ms] */
+  uint32_t on_ms;         /**< GNSS on time [ms] */
+  uint16_t fixes;         /**< Fixes in the session */
+  uint8_t  result;        /**< SensorGnssResult */
+  uint8_t  start;         /**< SensorGnssStart */
+  int32_t  error_us;      /**< Predicted timestamp error when GNSS started [us] */
+  int32_t  residual_us;   /**< Timestamp minus GNSS time at the first fix [us] */
+  uint32_t energy_mj;     /**< Estimated GNSS energy [mJ] */
+} SensorBinGnss;
+
+/**
+ * @struct SensorBinTrack
+ * @brief One position fix
+ * @details sec/msec is the fix time in the time zone of the samples, seq
+ *          places it between the samples.
+ */
+typedef struct
+{
+  uint32_t seq;           /**< Sequence number of the next sample */
+  uint32_t sec;           /**< Fix time [s since 1970/01/01] */
+  uint16_t msec;          /**< Fix time [ms] */
+  uint8_t  mode;          /**< 2 for 2D fix, 3 for 3D fix */
+  uint8_t  sats;          /**< Satellites used for the fix */
+  int32_t  lat;           /**< Latitude [1e-7 deg], north positive */
+  int32_t  lon;           /**< Longitude [1e-7 deg], east positive */
+  int32_t  alt_cm;        /**< Altitude [cm] */
+  uint16_t hdop;          /**< HDOP [0.01] */
+  uint16_t speed_cms;     /**< Ground speed [cm/s] */
+} SensorBinTrack;
+
+/**
+ * @struct SensorBinBurst
+ * @brief Consecutive full rate samples of one burst
+ * @details Samples are period_us apart. index counts samples from the
+ *          trigger, so a burst starts with negative indices.
+ */
+typedef struct
+{
+  uint32_t trigger;       /**< Sequence number of the next sample at the trigger */
+  int32_t  index;         /**< Index of the first sample from the trigger */
+  uint32_t sec;           /**< Time of the first sample [s since 1970/01/01] */
+  uint32_t usec;          /**< Time of the first sample [us] */
+  uint32_t period_us;     /**< Sample period [us] */
+  uint8_t  num;           /**< Samples */
+  int16_t  acc[SENSOR_BIN_BURST_NUM][3]; /**< Acceleration X/Y/Z [counts] */
+} SensorBinBurst;
+
+/**
+ * @struct SensorBinClose
+ * @brief Last record of a closed file
+ * @details Covers every byte of the file before the record, header
+ *          included, so a reader can check the file without the log.
+ */
+typedef struct
+{
+  uint32_t bytes;         /**< Bytes before the record */
+  uint32_t crc;           /**< CRC-32 of the bytes before the record */
+} SensorBinClose;
+
+/**
+ * @struct SensorBinBlock
+ * @brief Block under construction
+ */
+typedef struct
+{
+  uint8_t  buff[SENSOR_BIN_BLOCK_MAX]; /**< Encoded block */
+  int      num;           /**< Samples in the block */
+  uint32_t seq;           /**< Sequence number of the next sample */
+  uint32_t sec;           /**< Time of the first sample [s] */
+  uint16_t msec;          /**< Time of the first sample [ms] */
+  uint32_t press;         /**< Pressure of the block [counts] */
+} SensorBinBlock;
+
+/**
+ * @brief Write the file header.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_HEADER_SIZE
+ * @param [in] pHead File header
+ * @return Bytes written
+ */
+int SensorBinWriteHead(uint8_t *pBuff, const SensorBinHead *pHead);
+
+/**
+ * @brief Read the file header.
+ * 
+ * @param [in] pBuff SENSOR_BIN_HEADER_SIZE bytes from the start of a file
+ * @param [out] pHead File header
+ * @return 0 if success, -1 if not a sensor binary file
+ */
+int SensorBinReadHead(const uint8_t *pBuff, SensorBinHead *pHead);
+
+/**
+ * @brief Write the tag and header of a block record.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD
+ * @param [in] type Record type
+ * @param [in] num Samples in the block
+ * @param [in] length Bytes following the tag
+ * @param [in] seq Sequence number of the first sample
+ * @param [in] sec Time of the first sample [s]
+ * @param [in] msec Time of the first sample [ms]
+ * @param [in] press Pressure of the block [counts]
+ * @return Pointer past the header
+ */
+uint8_t *SensorBinWriteBlockHead(uint8_t *pBuff, uint8_t type, int num, int length,
+                                 uint32_t seq, uint32_t sec, uint16_t msec, uint32_t press);
+
+/**
+ * @brief Decode the header of a block record into a sample.
+ * 
+ * @param [in] pBuff Block record including the tag
+ * @param [in] pHead File header
+ * @param [out] pRecord Sample with sequence number, time and pressure of the first sample
+ */
+void SensorBinReadBlockHead(const uint8_t *pBuff, const SensorBinHead *pHead, SensorRecord *pRecord);
+
+/**
+ * @brief Start an empty block.
+ * 
+ * @param [out] pBlock Block
+ */
+void SensorBinReset(SensorBinBlock *pBlock);
+
+/**
+ * @brief Add a sample to the open block.
+ * 
+ * @details If the sample can not join the open block (full, pressure changed,
+ *          sequence gap or time offset overflow) the open block is closed
+ *          into pBuff first.
+ * @param [in,out] pBlock Block
+ * @param [in] pRecord Sample
+ * @param [out] pBuff %Buffer for a closed block, at least SENSOR_BIN_BLOCK_MAX
+ * @return Bytes of the closed block written to pBuff, 0 if none
+ */
+int SensorBinPut(SensorBinBlock *pBlock, const SensorRecord *pRecord, uint8_t *pBuff);
+
+/**
+ * @brief Close the open block.
+ * 
+ * @param [in,out] pBlock Block
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_BLOCK_MAX
+ * @return Bytes written to pBuff, 0 if the block was empty
+ */
+int SensorBinFlush(SensorBinBlock *pBlock, uint8_t *pBuff);
+
+/**
+ * @brief Write a jitter record.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_JITTER_SIZE
+ * @param [in] pJitter Jitter of one block
+ * @return Bytes written
+ */
+int SensorBinWriteJitter(uint8_t *pBuff, const SensorBinJitter *pJitter);
+
+/**
+ * @brief Write a time correction record.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_TIME_SIZE
+ * @param [in] pTime Time correction
+ * @return Bytes written
+ */
+int SensorBinWriteTime(uint8_t *pBuff, const SensorBinTime *pTime);
+
+/**
+ * @brief Write a GNSS session record.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_GNSS_SIZE
+ * @param [in] pGnss GNSS session
+ * @return Bytes written
+ */
+int SensorBinWriteGnss(uint8_t *pBuff, const SensorBinGnss *pGnss);
+
+/**
+ * @brief Write a position fix record.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_TRACK_SIZE
+ * @param [in] pTrack Position fix
+ * @return Bytes written
+ */
+int SensorBinWriteTrack(uint8_t *pBuff, const SensorBinTrack *pTrack);
+
+/**
+ * @brief Write a burst record.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_BURST_MAX
+ * @param [in] pBurst Burst samples
+ * @return Bytes written
+ */
+int SensorBinWriteBurst(uint8_t *pBuff, const SensorBinBurst *pBurst);
+
+/**
+ * @brief Write a file close record.
+ * 
+ * @param [out] pBuff %Buffer, at least SENSOR_BIN_CLOSE_SIZE
+ * @param [in] pClose Size and CRC-32 of the file
+ * @return Bytes written
+ */
+int SensorBinWriteClose(uint8_t *pBuff, const SensorBinClose *pClose);
+
+/**
+ * @brief Get the type and total length of a record.
+ * 
+ * @param [in] pBuff Record tag
+ * @param [out] type Record type
+ * @param [out] num Count field of the tag
+ * @return Total record length including the tag
+ */
+int SensorBinReadTag(const uint8_t *pBuff, uint8_t *type, uint8_t *num);
+
+/**
+ * @brief Decode one sample of a block record.
+ * 
+ * @param [in] pBuff Block record including the tag
+ * @param [in] index Sample index in the block
+ * @param [in] pHead File header
+ * @param [out] pRecord Sample
+ */
+void SensorBinReadSample(const uint8_t *pBuff, int index, const SensorBinHead *pHead, SensorRecord *pRecord);
+
+/**
+ * @brief Decode a jitter record.
+ * 
+ * @param [in] pBuff Jitter record including the tag
+ * @param [out] pJitter Jitter of one block
+ */
+void SensorBinReadJitter(const uint8_t *pBuff, SensorBinJitter *pJitter);
+
+/**
+ * @brief Decode a time correction record.
+ * 
+ * @param [in] pBuff Time correction record including the tag
+ * @param [out] pTime Time correction
+ */
+void SensorBinReadTime(const uint8_t *pBuff, SensorBinTime *pTime);
+
+/**
+ * @brief Decode a GNSS session record.
+ * 
+ * @param [in] pBuff GNSS session record including the tag
+ * @param [out] pGnss GNSS session
+ */
+void SensorBinReadGnss(const uint8_t *pBuff, SensorBinGnss *pGnss);
+
+/**
+ * @brief Decode a position fix record.
+ * 
+ * @param [in] pBuff Position fix record including the tag
+ * @param [out] pTrack Position fix
+ */
+void SensorBinReadTrack(const uint8_t *pBuff, SensorBinTrack *pTrack);
+
+/**
+ * @brief Decode a burst record.
+ * 
+ * @param [in] pBuff Burst record including the tag
+ * @param [out] pBurst Burst samples
+ */
+void SensorBinReadBurst(const uint8_t *pBuff, SensorBinBurst *pBurst);
+
+/**
+ * @brief Decode a file close record.
+ * 
+ * @param [in] pBuff File close record including the tag
+ * @param [out] pClose Size and CRC-32 of the file
+ */
+void SensorBinReadClose(const uint8_t *pBuff, SensorBinClose *pClose);
+
+/**
+ * @brief Format one burst sample as a CSV line.
+ * 
+ * @details $B00300,device,time,trigger,index,x[G],y[G],z[G]
+ * @param [out] pBuff %Buffer to write the line
+ * @param [in] size Size of pBuff, at least SENSOR_BURST_MAX
+ * @param [in] device Device number
+ * @param [in] sens Acceleration counts per G
+ * @param [in] pBurst Burst samples
+ * @param [in] index Sample in pBurst
+ * @return Length without NUL, 0 if size is too small
+ */
+int SensorBinFormatBurst(char *pBuff, int size, uint16_t device, uint16_t sens, const SensorBinBurst *pBurst, int index);
+
+/**
+ * @brief Format a position fix as a CSV line.
+ * 
+ * @details $P00300,device,time,seq,2D|3D,latitude,longitude,altitude[m],
+ *          HDOP,satellites,speed[m/s]
+ * @param [out] pBuff %Buffer to write the line
+ * @param [in] size Size of pBuff, at least SENSOR_TRACK_MAX
+ * @param [in] device Device number
+ * @param [in] pTrack Position fix
+ * @return Length without NUL, 0 if size is too small
+ */
+int SensorBinFormatTrack(char *pBuff, int size, uint16_t device, const SensorBinTrack *pTrack);
+
+/**
+ * @brief Format a file close record as a CSV line.
+ * 
+ * @details $C00300,device,bytes,CRC-32 in hex
+ * @param [out] pBuff %Buffer to write the line
+ * @param [in] size Size of pBuff, at least SENSOR_CLOSE_MAX
+ * @param [in] device Device number
+ * @param [in] pClose Size and CRC-32 of the file
+ * @return Length without NUL, 0 if size is too small
+ */
+int SensorBinFormatClose(char *pBuff, int size, uint16_t device, const SensorBinClose *pClose);
+
+/**
+ * @brief Update a CRC-32 (IEEE 802.3, as zlib and crc32 on a PC).
+ * 
+ * @param [in] crc CRC of the bytes before, 0 at the start
+ * @param [in] pBuff Bytes
+ * @param [in] length Length of pBuff
+ * @return CRC including pBuff
+ */
+uint32_t SensorBinCrc32(uint32_t crc, const uint8_t *pBuff, uint32_t length);
+
+/**
+ * @brief Get the name of a GNSS start.
+ * 
+ * @param [in] start SensorGnssStart
+ * @return "HOT", "BOOT" or "RESTORED"
+ */
+const char *SensorBinGnssStartName(uint8_t start);
+
+/**
+ * @brief Get the name of a time correction type.
+ * 
+ * @param [in] type SensorTimeType
+ * @return "STEP", "SLEW" or "FIT"
+ */
+const char *SensorBinTimeName(uint8_t type);
+
+#endif /* _SENSOR_BINARY_H_ */
@@ -0,0 +1,273 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sensor_codec.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Delta coded sensor blocks for the binary log.
+ */
+
+#include <string.h>
+#include "sensor_codec.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define BLOCK_DATA_OFFSET      (SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD)
+
+/**
+ * @brief Map signed to unsigned so small magnitudes stay small.
+ */
+static uint32_t ZigZag(int32_t value)
+{
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t UnZigZag(uint32_t value)
+{
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @brief Write an unsigned LEB128 varint.
+ * 
+ * @param [out] p %Buffer, at least 5 bytes
+ * @param [in] value Value
+ * @return Pointer past the varint
+ */
+static uint8_t *PutVarint(uint8_t *p, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    *p++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+
+  return p;
+}
+
+/**
+ * @brief Read an unsigned LEB128 varint.
+ * 
+ * @param [in] p Varint
+ * @param [in] end End of the record
+ * @param [out] value Value
+ * @return Pointer past the varint, NULL if truncated
+ */
+static const uint8_t *GetVarint(const uint8_t *p, const uint8_t *end, uint32_t *value)
+{
+  uint32_t result = 0;
+  int shift = 0;
+
+  while ((p < end) && (shift < 35))
+  {
+    result |= (uint32_t)(*p & 0x7F) << shift;
+    if ((*p++ & 0x80) == 0)
+    {
+      *value = result;
+      return p;
+    }
+    shift += 7;
+  }
+
+  return NULL;
+}
+
+void SensorCodecReset(SensorCodecBlock *pBlock)
+{
+  pBlock->num = 0;
+  pBlock->length = BLOCK_DATA_OFFSET;
+}
+
+int SensorCodecFlush(SensorCodecBlock *pBlock, uint8_t *pBuff)
+{
+  int length = pBlock->length;
+
+  if (pBlock->num == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  SensorBinWriteBlockHead(pBlock->buff, eBinDelta, pBlock->num, length - SENSOR_BIN_TAG_SIZE,
+                          pBlock->seq - pBlock->num, pBlock->sec, pBlock->msec, pBlock->press);
+  memcpy(pBuff, pBlock->buff, length);
+  SensorCodecReset(pBlock);
+
+  return length;
+}
+
+int SensorCodecPut(SensorCodecBlock *pBlock, const SensorRecord *pRecord, uint8_t *pBuff)
+{
+  uint8_t *p;
+  int32_t toff = 0;
+  int length = 0;
+  int cnt;
+
+  if (pBlock->num != 0)
+  {
+    toff = (int32_t)(pRecord->sec - pBlock->sec) * 1000 + ((int32_t)pRecord->msec - pBlock->msec);
+    if ((pBlock->num >= SENSOR_CODEC_BLOCK_NUM) ||
+        (pBlock->length + SENSOR_CODEC_SAMPLE_MAX > SENSOR_CODEC_BLOCK_MAX) ||
+        (pBlock->press != pRecord->press) || (pBlock->seq != pRecord->seq) ||
+        (toff < (int32_t)pBlock->toff))
+    {
+      length = SensorCodecFlush(pBlock, pBuff);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  p = &pBlock->buff[pBlock->length];
+  if (pBlock->num == 0)
+  {
+    /* Key frame. */
+    pBlock->sec = pRecord->sec;
+    pBlock->msec = pRecord->msec;
+    pBlock->press = pRecord->press;
+    pBlock->toff = 0;
+    p = PutVarint(p, pRecord->interval_us);
+    for (cnt = 0; cnt < 3; cnt++)
+    {
+      p = PutVarint(p, ZigZag(pRecord->acc[cnt]));
+    }
+  }
+  else
+  {
+    /* Residuals from the previous sample. */
+    p = PutVarint(p, (uint32_t)toff - pBlock->toff);
+    /* Modulo 2^32, so long gaps and intervals still decode exactly. */
+    p = PutVarint(p, ZigZag((int32_t)(pRecord->interval_us - ((uint32_t)toff - pBlock->toff) * 1000U)));
+    for (cnt = 0; cnt < 3; cnt++)
+    {
+      p = PutVarint(p, ZigZag((int32_t)pRecord->acc[cnt] - pBlock->acc[cnt]));
+    }
+    pBlock->toff = (uint32_t)toff;
+  }
+
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    pBlock->acc[cnt] = pRecord->acc[cnt];
+  }
+  pBlock->length = (int)(p - pBlock->buff);
+  pBlock->num++;
+  pBlock->seq = pRecord->seq + 1;
+
+  return length;
+}
+
+void SensorCodecBegin(SensorCodecDecoder *pDecoder, const uint8_t *pBuff, const SensorBinHead *pHead)
+{
+  uint8_t type;
+  uint8_t num;
+  int length;
+
+  length = SensorBinReadTag(pBuff, &type, &num);
+  SensorBinReadBlockHead(pBuff, pHead, &pDecoder->base);
+  pDecoder->p = &pBuff[BLOCK_DATA_OFFSET];
+  pDecoder->end = &pBuff[length];
+  pDecoder->index = 0;
+  pDecoder->num = num;
+  pDecoder->toff = 0;
+  pDecoder->version = pHead->version;
+}
+
+int SensorCodecNext(SensorCodecDecoder *pDecoder, SensorRecord *pRecord)
+{
+  const uint8_t *p = pDecoder->p;
+  uint32_t value[5];
+  uint32_t msec;
+  int cnt;
+
+  if (pDecoder->index >= pDecoder->num)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Key frame has no dt. */
+  value[0] = 0;
+  for (cnt = (pDecoder->index == 0) ? 1 : 0; cnt < 5; cnt++)
+  {
+    p = GetVarint(p, pDecoder->end, &value[cnt]);
+    if (p == NULL)
+    {
+      return -1;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  *pRecord = pDecoder->base;
+  if (pDecoder->index == 0)
+  {
+    pRecord->interval_us = (pDecoder->version < 2) ? value[1] * 1000 : value[1];
+    for (cnt = 0; cnt < 3; cnt++)
+    {
+      pRecord->acc[cnt] = (int16_t)UnZigZag(value[cnt + 2]);
+    }
+  }
+  else
+  {
+    pDecoder->toff += value[0];
+    if (pDecoder->version < 2)
+    {
+      pRecord->interval_us = (value[0] + (uint32_t)UnZigZag(value[1])) * 1000U;
+    }
+    else
+    {
+      pRecord->interval_us = value[0] * 1000U + (uint32_t)UnZigZag(value[1]);
+    }
+    for (cnt = 0; cnt < 3; cnt++)
+    {
+      pRecord->acc[cnt] = (int16_t)(pDecoder->last.acc[cnt] + UnZigZag(value[cnt + 2]));
+    }
+  }
+
+  msec = pDecoder->base.msec + pDecoder->toff;
+  pRecord->sec = pDecoder->base.sec + msec / 1000;
+  pRecord->msec = msec % 1000;
+  pRecord->seq = pDecoder->base.seq + pDecoder->index;
+
+  pDecoder->last = *pRecord;
+  pDecoder->p = p;
+  pDecoder->index++;
+
+  return 1;
+}
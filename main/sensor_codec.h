@@ -0,0 +1,131 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _SENSOR_CODEC_H_
+#define _SENSOR_CODEC_H_
+
+/**
+ * @file sensor_codec.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Delta coded sensor blocks for the binary log.
+ * @details An eBinDelta record has the same tag and header as an eBinBlock
+ *          record. The first sample is a key frame of absolute values, each
+ *          following sample stores zigzag varint residuals:
+ *          dt(ms from previous sample) interval(us)-dt*1000 x-x' y-y' z-z'.
+ *          Version 1 files stored interval(ms)-dt.
+ *          A resting animal needs about 5 bytes per sample.
+ *          This file is shared with the host side converter.
+ */
+
+#include <stdint.h>
+#include "sensor_binary.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define SENSOR_CODEC_BLOCK_MAX   512          /**< Max record size */
+#define SENSOR_CODEC_SAMPLE_MAX  19           /**< Worst case sample size */
+#define SENSOR_CODEC_BLOCK_NUM   255          /**< Max samples per block */
+
+/**
+ * @struct SensorCodecBlock
+ * @brief Delta block under construction
+ */
+typedef struct
+{
+  uint8_t  buff[SENSOR_CODEC_BLOCK_MAX]; /**< Encoded block */
+  int      length;        /**< Bytes used in buff */
+  int      num;           /**< Samples in the block */
+  uint32_t seq;           /**< Sequence number of the next sample */
+  uint32_t sec;           /**< Time of the first sample [s] */
+  uint16_t msec;          /**< Time of the first sample [ms] */
+  uint32_t press;         /**< Pressure of the block [counts] */
+  uint32_t toff;          /**< Time offset of the previous sample [ms] */
+  int16_t  acc[3];        /**< Acceleration of the previous sample */
+} SensorCodecBlock;
+
+/**
+ * @struct SensorCodecDecoder
+ * @brief Streaming decoder of one delta block
+ */
+typedef struct
+{
+  const uint8_t *p;       /**< Next byte to decode */
+  const uint8_t *end;     /**< End of the record */
+  int            index;   /**< Samples decoded */
+  int            num;     /**< Samples in the block */
+  uint32_t       toff;    /**< Time offset of the previous sample [ms] */
+  uint16_t       version; /**< Format version of the file */
+  SensorRecord   base;    /**< First sample time, sequence and pressure */
+  SensorRecord   last;    /**< Previous sample */
+} SensorCodecDecoder;
+
+/**
+ * @brief Start an empty block.
+ * 
+ * @param [out] pBlock Block
+ */
+void SensorCodecReset(SensorCodecBlock *pBlock);
+
+/**
+ * @brief Add a sample to the open block.
+ * 
+ * @details If the sample can not join the open block (full, pressure changed,
+ *          sequence gap or time going backwards) the open block is closed
+ *          into pBuff first.
+ * @param [in,out] pBlock Block
+ * @param [in] pRecord Sample
+ * @param [out] pBuff %Buffer for a closed block, at least SENSOR_CODEC_BLOCK_MAX
+ * @return Bytes of the closed block written to pBuff, 0 if none
+ */
+int SensorCodecPut(SensorCodecBlock *pBlock, const SensorRecord *pRecord, uint8_t *pBuff);
+
+/**
+ * @brief Close the open block.
+ * 
+ * @param [in,out] pBlock Block
+ * @param [out] pBuff %Buffer, at least SENSOR_CODEC_BLOCK_MAX
+ * @return Bytes written to pBuff, 0 if the block was empty
+ */
+int SensorCodecFlush(SensorCodecBlock *pBlock, uint8_t *pBuff);
+
+/**
+ * @brief Start decoding a delta block.
+ * 
+ * @param [out] pDecoder Decoder
+ * @param [in] pBuff eBinDelta record including the tag
+ * @param [in] pHead File header
+ */
+void SensorCodecBegin(SensorCodecDecoder *pDecoder, const uint8_t *pBuff, const SensorBinHead *pHead);
+
+/**
+ * @brief Decode the next sample.
+ * 
+ * @param [in,out] pDecoder Decoder
+ * @param [out] pRecord Sample
+ * @return 1 if a sample was decoded, 0 at the end of the block, -1 if corrupt
+ */
+int SensorCodecNext(SensorCodecDecoder *pDecoder, SensorRecord *pRecord);
+
+#endif /* _SENSOR_CODEC_H_ */
@@ -0,0 +1,213 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sensor_format.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Format sensor records without heap or floating point.
+ */
+
+#include "sensor_format.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define SEC_PER_DAY            86400UL
+
+char *FormatUint(char *pBuff, unsigned long value, int width)
+{
+  char digit[10];
+  int cnt = 0;
+
+  /* Digits in reverse order. */
+  do
+  {
+    digit[cnt++] = '0' + (value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  while (width > cnt)
+  {
+    *pBuff++ = '0';
+    width--;
+  }
+
+  while (cnt > 0)
+  {
+    *pBuff++ = digit[--cnt];
+  }
+
+  return pBuff;
+}
+
+char *FormatFixed(char *pBuff, long value, int decimals)
+{
+  unsigned long scale = 1;
+  unsigned long abs_value;
+  int cnt;
+
+  for (cnt = 0; cnt < decimals; cnt++)
+  {
+    scale *= 10;
+  }
+
+  if (value < 0)
+  {
+    *pBuff++ = '-';
+    abs_value = (unsigned long)(-value);
+  }
+  else
+  {
+    abs_value = (unsigned long)value;
+  }
+
+  pBuff = FormatUint(pBuff, abs_value / scale, 1);
+  if (decimals > 0)
+  {
+    *pBuff++ = '.';
+    pBuff = FormatUint(pBuff, abs_value % scale, decimals);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return pBuff;
+}
+
+char *FormatSensorTime(char *pBuff, unsigned long sec, unsigned short msec)
+{
+  unsigned long days = sec / SEC_PER_DAY;
+  unsigned long rem = sec % SEC_PER_DAY;
+  unsigned long doe, yoe, doy, mp;
+  unsigned long year, month, day;
+
+  /* Civil date from days since 1970/01/01 (era of 400 years from 0000/03/01). */
+  days += 719468;
+  doe = days % 146097;
+  yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = (mp < 10) ? (mp + 3) : (mp - 9);
+  year = yoe + (days / 146097) * 400 + ((month <= 2) ? 1 : 0);
+
+  pBuff = FormatUint(pBuff, year, 4);
+  *pBuff++ = '/';
+  pBuff = FormatUint(pBuff, month, 2);
+  *pBuff++ = '/';
+  pBuff = FormatUint(pBuff, day, 2);
+  *pBuff++ = ' ';
+  pBuff = FormatUint(pBuff, rem / 3600, 2);
+  *pBuff++ = ':';
+  pBuff = FormatUint(pBuff, (rem / 60) % 60, 2);
+  *pBuff++ = ':';
+  pBuff = FormatUint(pBuff, rem % 60, 2);
+  *pBuff++ = '.';
+  pBuff = FormatUint(pBuff, msec, 3);
+
+  return pBuff;
+}
+
+long DivRound(long value, unsigned long divisor)
+{
+  unsigned long abs_value = (value < 0) ? (unsigned long)(-value) : (unsigned long)value;
+  unsigned long quot = abs_value / divisor;
+  unsigned long rem = abs_value % divisor;
+
+  if ((rem * 2 > divisor) || ((rem * 2 == divisor) && ((quot & 1) != 0)))
+  {
+    quot++;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return (value < 0) ? -(long)quot : (long)quot;
+}
+
+int FormatSensorRecord(char *pBuff, int size, const SensorRecord *pRecord)
+{
+  static const char Sign[] = SENSOR_RECORD_SIGN ",0x";
+  static const char Hex[] = "0123456789ABCDEF";
+  char *p = pBuff;
+  long acc;
+  int cnt;
+
+  if (size < SENSOR_RECORD_MAX)
+  {
+    return 0;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Set Header. */
+  for (cnt = 0; Sign[cnt] != '\0'; cnt++)
+  {
+    *p++ = Sign[cnt];
+  }
+  for (cnt = 12; cnt >= 0; cnt -= 4)
+  {
+    *p++ = Hex[(pRecord->device >> cnt) & 0x0F];
+  }
+  *p++ = ',';
+
+  p = FormatSensorTime(p, pRecord->sec, pRecord->msec);
+  *p++ = ',';
+
+  p = FormatUint(p, pRecord->seq, 1);
+  *p++ = ',';
+
+  /* Interval [ms] with 1 [us] resolution, high output data rates are below 1 [ms]. */
+  p = FormatFixed(p, (long)pRecord->interval_us, 3);
+  *p++ = ',';
+
+  /* Acceleration [G] with 1 [mG] resolution, sign kept for -0.000 like printf. */
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    acc = pRecord->acc[cnt];
+    if (acc < 0)
+    {
+      *p++ = '-';
+      acc = -acc;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    p = FormatFixed(p, (pRecord->sens != 0) ? DivRound(acc * 1000, pRecord->sens) : 0, 3);
+    *p++ = ',';
+  }
+
+  /* Barometer [hPa] with 4 decimals: counts * 10000 / 2048 = counts * 625 / 128. */
+  p = FormatFixed(p, DivRound((long)(pRecord->press * 625), 128), 4);
+
+  *p++ = '\n';
+  *p = '\0';
+
+  return (int)(p - pBuff);
+}
@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _SENSOR_FORMAT_H_
+#define _SENSOR_FORMAT_H_
+
+/**
+ * @file sensor_format.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Format sensor records without heap or floating point.
+ * @details Raw counts are converted with integer arithmetic and written
+ *          straight into the caller's buffer.
+ */
+
+/**
+ * @brief Macro definitions
+ */
+#define SENSOR_RECORD_SIGN     "$V00300"      /**< Record sign name */
+#define SENSOR_RECORD_MAX      112            /**< Longest possible record */
+
+/**
+ * @struct SensorRecord
+ * @brief One sensor sample in raw counts
+ */
+typedef struct
+{
+  unsigned long  sec;          /**< Time of the sample [s since 1970/01/01] */
+  unsigned short msec;         /**< Time of the sample [ms] */
+  unsigned short device;       /**< Device number */
+  unsigned long  seq;          /**< Sequence number */
+  unsigned long  interval_us;  /**< Time interval [us] */
+  signed short   acc[3];       /**< Acceleration X/Y/Z [counts] */
+  unsigned short sens;         /**< Acceleration counts per G */
+  unsigned long  press;        /**< Barometric pressure [counts] */
+} SensorRecord;
+
+/**
+ * @brief Write one CSV sensor record.
+ * 
+ * @details $V00300,0xDDDD,YYYY/MM/DD hh:mm:ss.sss,seq,interval[ms].uuu,x,y,z,press\n
+ * @param [out] pBuff %Buffer to write the record
+ * @param [in] size Size of pBuff, at least SENSOR_RECORD_MAX
+ * @param [in] pRecord Sensor sample
+ * @return Length of the record, 0 if pBuff is too small
+ */
+int FormatSensorRecord(char *pBuff, int size, const SensorRecord *pRecord);
+
+/**
+ * @brief Write "YYYY/MM/DD hh:mm:ss.sss".
+ * 
+ * @param [out] pBuff %Buffer to write, at least 23 bytes
+ * @param [in] sec Time [s since 1970/01/01]
+ * @param [in] msec Time [ms]
+ * @return Pointer past the last written character
+ */
+char *FormatSensorTime(char *pBuff, unsigned long sec, unsigned short msec);
+
+/**
+ * @brief Write an unsigned decimal.
+ * 
+ * @param [out] pBuff %Buffer to write, at least 10 bytes or width
+ * @param [in] value Value to write
+ * @param [in] width Minimum digits, padded with '0'
+ * @return Pointer past the last written character
+ */
+char *FormatUint(char *pBuff, unsigned long value, int width);
+
+/**
+ * @brief Write a signed fixed point decimal.
+ * 
+ * @param [out] pBuff %Buffer to write
+ * @param [in] value Value multiplied by 10^decimals
+ * @param [in] decimals Digits after the decimal point
+ * @return Pointer past the last written character
+ */
+char *FormatFixed(char *pBuff, long value, int decimals);
+
+/**
+ * @brief Divide rounding half to even, the same as printf("%f").
+ * 
+ * @param [in] value Dividend
+ * @param [in] divisor Divisor, greater than 0
+ * @return Rounded quotient
+ */
+long DivRound(long value, unsigned long divisor);
+
+#endif /* _SENSOR_FORMAT_H_ */
@@ -0,0 +1,723 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sensor_offload.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Encode sensor samples for the file outside of the sampling path.
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include "sensor_offload.h"
+#if (SENSOR_OFFLOAD_CORE != 0)
+#include <MP.h>
+#endif /* SENSOR_OFFLOAD_CORE */
+
+/**
+ * @brief Macro definitions
+ */
+#define OFFLOAD_MSG_BEGIN      1              /**< Mailbox message with the address of the shared state */
+#define OFFLOAD_MSG_WAKE       2              /**< Mailbox message for new samples and commands */
+
+/**
+ * @brief Internal types
+ */
+typedef struct
+{
+  uint8_t       kind;         /**< SensorOffloadKind */
+  uint8_t       format;       /**< SensorOutFormat, eOffloadStart */
+  uint16_t      length;       /**< Bytes in data, eOffloadBytes; device, eOffloadClose */
+  unsigned long pos;          /**< SensorRingIn when the command was queued */
+  char          data[SENSOR_OFFLOAD_BYTES_MAX];
+} OffloadCommand;
+
+/**
+ * @struct OffloadShared
+ * @brief State shared by the loop and the encoder, in main core memory
+ * @details Blocks [Tail, Filled) are encoded and wait to be written, block
+ *          Filled is being encoded. Commands [CmdDone, CmdHead) wait for
+ *          the encoder. Tail and CmdHead are written by the loop only,
+ *          Filled, CmdDone and Received by the encoder only.
+ */
+typedef struct
+{
+  SensorOffloadBlock     Pool[SENSOR_OFFLOAD_BLOCKS];
+  OffloadCommand         Command[SENSOR_OFFLOAD_COMMANDS];
+  SensorRing             *pRing;      /**< Physical address of the sensor ring, SubCore only */
+  volatile unsigned long Filled;
+  volatile unsigned long Tail;
+  volatile unsigned long CmdHead;
+  volatile unsigned long CmdDone;
+  volatile unsigned long Received;    /**< Wake up messages taken by the SubCore */
+  SensorOffloadStat      Stat;
+} OffloadShared;
+
+/**
+ * @brief private variables
+ */
+#ifndef SUBCORE
+static OffloadShared Shared;                  /**< Owned by the main core */
+static OffloadShared *pShared = &Shared;
+#else
+static OffloadShared *pShared = NULL;         /**< Main core memory, set by OFFLOAD_MSG_BEGIN */
+#endif /* SUBCORE */
+
+/* Loop only. */
+static unsigned long Woken = 0;               /**< SensorRingIn at the last wake up */
+static unsigned long Sent = 0;                /**< Wake up messages sent to the SubCore */
+static uint32_t FileQueued = 0;               /**< SensorOffloadStart calls queued */
+static boolean Running = false;
+static int Core = 0;                          /**< SubCore of the encoder, 0 for the thread */
+static pthread_t Thread;
+static sem_t Ready;                           /**< Posted for new samples and commands, thread only */
+
+/* Encoder only, in the memory of the core that runs it. */
+static uint32_t FileEncoded = 0;              /**< SensorOffloadStart calls run */
+static uint8_t Format = eFormatCsv;           /**< SensorOutFormat */
+static SensorBinBlock BinBlock;               /**< Binary block under construction */
+static SensorCodecBlock DeltaBlock;           /**< Delta block under construction */
+
+/**
+ * @brief Get the block being encoded, wait until one is free.
+ * 
+ * @return Block owned by the encoder
+ */
+static SensorOffloadBlock *OffloadBlock(void)
+{
+  while ((pShared->Filled - pShared->Tail) >= SENSOR_OFFLOAD_BLOCKS)
+  {
+    /* The card is behind, the ring keeps the samples meanwhile. */
+    usleep(1000);
+  }
+
+  return &pShared->Pool[pShared->Filled % SENSOR_OFFLOAD_BLOCKS];
+}
+
+/**
+ * @brief Hand the block being encoded back to the loop.
+ */
+static void OffloadHandBack(void)
+{
+  SensorOffloadBlock *pBlock = &pShared->Pool[pShared->Filled % SENSOR_OFFLOAD_BLOCKS];
+  unsigned long pending;
+
+  if (pBlock->length != 0)
+  {
+    pShared->Stat.crc = SensorBinCrc32(pShared->Stat.crc, pBlock->out, pBlock->length);
+    pShared->Stat.bytes += pBlock->length;
+    pShared->Stat.blocks++;
+
+    /* Publish the block contents before the index. */
+    __sync_synchronize();
+    pShared->Filled = pShared->Filled + 1;
+
+    pending = pShared->Filled - pShared->Tail;
+    if (pending > pShared->Stat.pending_max)
+    {
+      pShared->Stat.pending_max = pending;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    pBlock = OffloadBlock();
+    pBlock->length = 0;
+    pBlock->file = FileEncoded;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Get room in the block being encoded.
+ * 
+ * @param [in] length Bytes needed
+ * @return Write position
+ */
+static uint8_t *OffloadRoom(uint32_t length)
+{
+  SensorOffloadBlock *pBlock = OffloadBlock();
+
+  if (pBlock->length + length > SENSOR_OFFLOAD_OUT_MAX)
+  {
+    OffloadHandBack();
+    pBlock = OffloadBlock();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return &pBlock->out[pBlock->length];
+}
+
+/**
+ * @brief Encode one sample into the block.
+ * 
+ * @param [in] pRecord Sensor sample
+ */
+static void OffloadEncode(const SensorRecord *pRecord)
+{
+  SensorOffloadBlock *pBlock;
+  uint8_t *pOut;
+
+  switch (Format)
+  {
+    case eFormatCompressed:
+      pOut = OffloadRoom(SENSOR_CODEC_BLOCK_MAX);
+      pBlock = OffloadBlock();
+      pBlock->length += SensorCodecPut(&DeltaBlock, pRecord, pOut);
+      break;
+
+    case eFormatBinary:
+      pOut = OffloadRoom(SENSOR_BIN_BLOCK_MAX);
+      pBlock = OffloadBlock();
+      pBlock->length += SensorBinPut(&BinBlock, pRecord, pOut);
+      break;
+
+    case eFormatCsv:
+    default:
+      pOut = OffloadRoom(SENSOR_RECORD_MAX);
+      pBlock = OffloadBlock();
+      pBlock->length += FormatSensorRecord((char*)pOut, SENSOR_RECORD_MAX, pRecord);
+      break;
+  }
+}
+
+/**
+ * @brief Close the binary block under construction into the block.
+ */
+static void OffloadFlushBlock(void)
+{
+  uint8_t *pOut;
+
+  if (Format == eFormatCompressed)
+  {
+    pOut = OffloadRoom(SENSOR_CODEC_BLOCK_MAX);
+    OffloadBlock()->length += SensorCodecFlush(&DeltaBlock, pOut);
+  }
+  else if (Format == eFormatBinary)
+  {
+    pOut = OffloadRoom(SENSOR_BIN_BLOCK_MAX);
+    OffloadBlock()->length += SensorBinFlush(&BinBlock, pOut);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Add the file close record with the size and CRC-32 of the file so far.
+ * 
+ * @param [in] device Device number of the CSV line
+ */
+static void OffloadCloseRecord(uint16_t device)
+{
+  SensorOffloadBlock *pBlock;
+  SensorBinClose Close;
+  uint8_t *pOut;
+
+  pOut = OffloadRoom(SENSOR_CLOSE_MAX);
+  pBlock = OffloadBlock();
+
+  /* Blocks handed back so far and the bytes of this block before the record. */
+  Close.bytes = pShared->Stat.bytes + pBlock->length;
+  Close.crc = SensorBinCrc32(pShared->Stat.crc, pBlock->out, pBlock->length);
+  if (Format == eFormatCsv)
+  {
+    pBlock->length += SensorBinFormatClose((char*)pOut, SENSOR_CLOSE_MAX, device, &Close);
+  }
+  else
+  {
+    pBlock->length += SensorBinWriteClose(pOut, &Close);
+  }
+}
+
+/**
+ * @brief Run one command.
+ * 
+ * @param [in] pCommand Command
+ */
+static void OffloadCommandRun(const OffloadCommand *pCommand)
+{
+  uint8_t *pOut;
+
+  switch (pCommand->kind)
+  {
+    case eOffloadStart:
+      /* The previous file was handed back with its last flush, the next block starts the new file. */
+      OffloadHandBack();
+      FileEncoded++;
+      OffloadBlock()->file = FileEncoded;
+      Format = pCommand->format;
+      SensorBinReset(&BinBlock);
+      SensorCodecReset(&DeltaBlock);
+      pShared->Stat.last_bytes = pShared->Stat.bytes;
+      pShared->Stat.last_crc = pShared->Stat.crc;
+      pShared->Stat.bytes = 0;
+      pShared->Stat.crc = 0;
+      break;
+
+    case eOffloadBytes:
+      pOut = OffloadRoom(pCommand->length);
+      memcpy(pOut, pCommand->data, pCommand->length);
+      OffloadBlock()->length += pCommand->length;
+      break;
+
+    case eOffloadFlush:
+      OffloadFlushBlock();
+      OffloadHandBack();
+      break;
+
+    case eOffloadClose:
+      OffloadFlushBlock();
+      OffloadCloseRecord(pCommand->length);
+      OffloadHandBack();
+      break;
+
+    default:
+      /* do nothing. */
+      break;
+  }
+}
+
+/**
+ * @brief Encode the queued samples and run the queued commands.
+ */
+static void OffloadRun(void)
+{
+  SensorRecord Record;
+  OffloadCommand *pCommand;
+  unsigned long start;
+  unsigned long elapsed;
+
+  start = micros();
+  while (1)
+  {
+    if (pShared->CmdDone != pShared->CmdHead)
+    {
+      /* Samples pushed before the command first. */
+      __sync_synchronize();
+      pCommand = &pShared->Command[pShared->CmdDone % SENSOR_OFFLOAD_COMMANDS];
+      while (((long)(pCommand->pos - SensorRingOut()) > 0) && (SensorRingPop(&Record) == true))
+      {
+        OffloadEncode(&Record);
+      }
+      OffloadCommandRun(pCommand);
+
+      /* Free the command after it has run. */
+      __sync_synchronize();
+      pShared->CmdDone = pShared->CmdDone + 1;
+    }
+    else if (SensorRingPop(&Record) == true)
+    {
+      OffloadEncode(&Record);
+    }
+    else
+    {
+      break;
+    }
+  }
+  elapsed = micros() - start;
+  if (elapsed > pShared->Stat.encode_max_us)
+  {
+    pShared->Stat.encode_max_us = elapsed;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Start the encoder state of this core for a new shared state.
+ */
+static void OffloadEncoderBegin(void)
+{
+  FileEncoded = 0;
+  Format = eFormatCsv;
+  SensorBinReset(&BinBlock);
+  SensorCodecReset(&DeltaBlock);
+}
+
+/**
+ * @brief Encoder thread on the main core.
+ * 
+ * @param [in] arg Not used
+ * @return NULL
+ */
+static void* OffloadEncoder(void* arg)
+{
+  while (1)
+  {
+    while ((sem_wait(&Ready) != 0) && (errno == EINTR))
+    {
+      /* Interrupted, wait again. */
+    }
+    OffloadRun();
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Wake up the encoder for the samples and commands queued so far.
+ */
+static void OffloadWake(void)
+{
+#if (SENSOR_OFFLOAD_CORE != 0)
+  if (Core != 0)
+  {
+    /* At most one message in the mailbox, the SubCore takes everything queued before it runs. */
+    __sync_synchronize();
+    if ((Sent == pShared->Received) &&
+        (MP.Send(OFFLOAD_MSG_WAKE, (uint32_t)0, Core) >= 0))
+    {
+      Sent++;
+      pShared->Stat.wakeups++;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+#endif /* SENSOR_OFFLOAD_CORE */
+  sem_post(&Ready);
+}
+
+/**
+ * @brief Start the encoder on the SubCore.
+ * 
+ * @return true if the SubCore image was started and took the shared state
+ */
+static boolean OffloadBeginSubCore(void)
+{
+#if (SENSOR_OFFLOAD_CORE != 0)
+  /* The SubCore reads the main core memory at its physical address. */
+  pShared->pRing = (SensorRing*)MP.Virt2Phys(SensorRingShared());
+  if ((MP.begin(SENSOR_OFFLOAD_CORE) >= 0) &&
+      (MP.Send(OFFLOAD_MSG_BEGIN, (void*)MP.Virt2Phys(pShared), SENSOR_OFFLOAD_CORE) >= 0))
+  {
+    Core = SENSOR_OFFLOAD_CORE;
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+#else
+  return false;
+#endif /* SENSOR_OFFLOAD_CORE */
+}
+
+/**
+ * @brief Start the encoder thread on the main core.
+ * 
+ * @return true if the thread was started
+ */
+static boolean OffloadBeginThread(void)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  boolean started;
+
+  OffloadEncoderBegin();
+  sem_init(&Ready, 0, 0);
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, SENSOR_OFFLOAD_STACK);
+  sched_getparam(0, &param);
+  param.sched_priority += SENSOR_OFFLOAD_PRIORITY;
+  pthread_attr_setschedparam(&attr, &param);
+  started = (pthread_create(&Thread, &attr, OffloadEncoder, NULL) == 0);
+  pthread_attr_destroy(&attr);
+
+  if (started == false)
+  {
+    sem_destroy(&Ready);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return started;
+}
+
+/**
+ * @brief Get a free command.
+ * 
+ * @return Command, NULL if the queue is full
+ */
+static OffloadCommand *OffloadCommandGet(void)
+{
+  OffloadCommand *pCommand;
+
+  if ((pShared->CmdHead - pShared->CmdDone) >= SENSOR_OFFLOAD_COMMANDS)
+  {
+    pShared->Stat.dropped++;
+    return NULL;
+  }
+  else
+  {
+    pCommand = &pShared->Command[pShared->CmdHead % SENSOR_OFFLOAD_COMMANDS];
+    pCommand->pos = SensorRingIn();
+    return pCommand;
+  }
+}
+
+/**
+ * @brief Queue the command of OffloadCommandGet and wake up the encoder.
+ */
+static void OffloadCommandPut(void)
+{
+  /* Publish the command before the index. */
+  __sync_synchronize();
+  pShared->CmdHead = pShared->CmdHead + 1;
+  Woken = SensorRingIn();
+  OffloadWake();
+}
+
+boolean SensorOffloadBegin(void)
+{
+  if (Running == true)
+  {
+    return true;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  memset(&pShared->Stat, 0, sizeof(pShared->Stat));
+  pShared->Filled = 0;
+  pShared->Tail = 0;
+  pShared->CmdHead = 0;
+  pShared->CmdDone = 0;
+  pShared->Received = 0;
+  pShared->Pool[0].length = 0;
+  pShared->Pool[0].file = 0;
+  SensorRingBegin(SENSOR_RING_POLICY);
+  Woken = 0;
+  Sent = 0;
+  FileQueued = 0;
+  Core = 0;
+
+  /* The thread if the SubCore image was not uploaded. */
+  Running = (OffloadBeginSubCore() == true) || (OffloadBeginThread() == true);
+
+  return Running;
+}
+
+boolean SensorOffloadRunning(void)
+{
+  return Running;
+}
+
+int SensorOffloadCore(void)
+{
+  return Core;
+}
+
+uint32_t SensorOffloadStart(uint8_t format)
+{
+  OffloadCommand *pCommand = OffloadCommandGet();
+
+  if (pCommand != NULL)
+  {
+    pCommand->kind = eOffloadStart;
+    pCommand->format = format;
+    OffloadCommandPut();
+    FileQueued++;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return FileQueued;
+}
+
+void SensorOffloadPut(const SensorRecord *pRecord)
+{
+  SensorRingPush(pRecord);
+
+  if ((SensorRingIn() - Woken) >= SENSOR_OFFLOAD_RECORDS)
+  {
+    Woken = SensorRingIn();
+    OffloadWake();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+void SensorOffloadBytes(const char *pBuff, int length)
+{
+  OffloadCommand *pCommand;
+
+  if ((length <= 0) || (length > SENSOR_OFFLOAD_BYTES_MAX))
+  {
+    pShared->Stat.dropped++;
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pCommand = OffloadCommandGet();
+  if (pCommand != NULL)
+  {
+    pCommand->kind = eOffloadBytes;
+    pCommand->length = length;
+    memcpy(pCommand->data, pBuff, length);
+    OffloadCommandPut();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+void SensorOffloadFlush(void)
+{
+  OffloadCommand *pCommand = OffloadCommandGet();
+
+  if (pCommand != NULL)
+  {
+    pCommand->kind = eOffloadFlush;
+    OffloadCommandPut();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+void SensorOffloadClose(uint16_t device)
+{
+  OffloadCommand *pCommand = OffloadCommandGet();
+
+  if (pCommand != NULL)
+  {
+    pCommand->kind = eOffloadClose;
+    pCommand->length = device;
+    OffloadCommandPut();
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+boolean SensorOffloadDone(void)
+{
+  return (Running == false) || (pShared->CmdDone == pShared->CmdHead);
+}
+
+const SensorOffloadBlock *SensorOffloadGet(void)
+{
+  if (pShared->Tail == pShared->Filled)
+  {
+    return NULL;
+  }
+  else
+  {
+    /* Read the block after the index. */
+    __sync_synchronize();
+    return &pShared->Pool[pShared->Tail % SENSOR_OFFLOAD_BLOCKS];
+  }
+}
+
+void SensorOffloadRelease(void)
+{
+  if (pShared->Tail != pShared->Filled)
+  {
+    /* Free the block after it has been read. */
+    __sync_synchronize();
+    pShared->Tail = pShared->Tail + 1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+boolean SensorOffloadPending(void)
+{
+  return (pShared->CmdDone != pShared->CmdHead) || (SensorRingCount() != 0);
+}
+
+void SensorOffloadGetStat(SensorOffloadStat *pStat)
+{
+  *pStat = pShared->Stat;
+}
+
+void SensorOffloadSubCore(void)
+{
+#if (SENSOR_OFFLOAD_CORE != 0)
+  int8_t msgid;
+  void *pAddress;
+
+  /* Tell the main core that the SubCore has started. */
+  MP.begin();
+  MP.RecvTimeout(MP_RECV_BLOCKING);
+
+  while (1)
+  {
+    if (MP.Recv(&msgid, &pAddress) < 0)
+    {
+      continue;
+    }
+    else if (msgid == OFFLOAD_MSG_BEGIN)
+    {
+      pShared = (OffloadShared*)pAddress;
+      SensorRingAttach(pShared->pRing);
+      OffloadEncoderBegin();
+    }
+    else if (pShared != NULL)
+    {
+      /* Taken before the run, so the loop sends again for anything queued after this point. */
+      pShared->Received = pShared->Received + 1;
+      __sync_synchronize();
+      OffloadRun();
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+#endif /* SENSOR_OFFLOAD_CORE */
+}
@@ -0,0 +1,209 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef _SENSOR_OFFLOAD_H_
+#define _SENSOR_OFFLOAD_H_
+
+/**
+ * @file sensor_offload.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Encode sensor samples for the file outside of the sampling path.
+ * @details The main loop pushes raw samples into the sensor ring. The
+ *          encoder pops them and writes CSV, binary or compressed records
+ *          into fixed size blocks of a pool, adds them to the CRC-32 of the
+ *          file and hands each full block back by moving an index, the data
+ *          is not copied again. The main loop passes encoded blocks to the
+ *          SD writer in the order they were filled. Other records of the
+ *          file are queued as commands that carry the ring position they
+ *          follow, so the file order is kept.
+ * 
+ *          The encoder runs on SubCore SENSOR_OFFLOAD_CORE, the same sketch
+ *          built for that SubCore calls SensorOffloadSubCore. The ring, the
+ *          pool and the commands stay in main core memory, the SubCore gets
+ *          their address in its first mailbox message and is woken up by
+ *          later ones. Without a SubCore image the encoder runs in a thread
+ *          on the main core.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define SENSOR_OFFLOAD_RECORDS 32             /**< Samples queued before the encoder is woken up */
+#define SENSOR_OFFLOAD_BLOCKS  4              /**< Blocks in the pool */
+#define SENSOR_OFFLOAD_OUT_MAX 4096           /**< Encoded bytes per block */
+#define SENSOR_OFFLOAD_COMMANDS 16            /**< Commands queued for the encoder */
+#define SENSOR_OFFLOAD_BYTES_MAX 128          /**< Longest record encoded by the caller */
+#define SENSOR_OFFLOAD_STACK   4096           /**< [byte] Encoder thread stack. */
+#define SENSOR_OFFLOAD_PRIORITY 0             /**< Encoder thread priority relative to the loop, it runs while the loop sleeps or yields. */
+
+/**
+ * @enum SensorOffloadKind
+ * @brief Command to the encoder
+ */
+enum SensorOffloadKind
+{
+  eOffloadStart = 0,    /**< Start a file */
+  eOffloadBytes,        /**< Records encoded by the caller */
+  eOffloadFlush,        /**< Close the binary block under construction and hand the block back */
+  eOffloadClose,        /**< Flush and add the file close record */
+};
+
+/**
+ * @struct SensorOffloadBlock
+ * @brief One block of the pool
+ */
+typedef struct
+{
+  uint32_t      length;       /**< Bytes in out */
+  uint32_t      file;         /**< Number of SensorOffloadStart the block belongs to */
+  uint8_t       out[SENSOR_OFFLOAD_OUT_MAX];
+} SensorOffloadBlock;
+
+/**
+ * @struct SensorOffloadStat
+ * @brief Counters of the encoder
+ */
+typedef struct
+{
+  unsigned long blocks;       /**< Blocks encoded */
+  unsigned long dropped;      /**< Records dropped because the command queue was full */
+  unsigned long wakeups;      /**< Mailbox messages that woke up the SubCore */
+  unsigned long pending_max;  /**< Most blocks encoded and not yet written */
+  unsigned long encode_max_us;/**< [us] Longest encoder run after a wake up */
+  unsigned long bytes;        /**< Bytes encoded for the file */
+  uint32_t      crc;          /**< CRC-32 of the bytes encoded for the file */
+  unsigned long last_bytes;   /**< Bytes of the file before the last start */
+  uint32_t      last_crc;     /**< CRC-32 of the file before the last start */
+} SensorOffloadStat;
+
+/**
+ * @brief Start the encoder on the SubCore, or in a thread if the SubCore does not start.
+ * 
+ * @return true if success, false if the encoder was not started
+ */
+boolean SensorOffloadBegin(void);
+
+/**
+ * @brief Check whether the encoder runs.
+ * 
+ * @return true if running
+ */
+boolean SensorOffloadRunning(void);
+
+/**
+ * @brief Get where the encoder runs.
+ * 
+ * @return SubCore number, 0 for a thread on the main core
+ */
+int SensorOffloadCore(void);
+
+/**
+ * @brief Start a new file after the samples pushed so far.
+ * 
+ * @details Blocks of the new file carry the returned number, so the
+ *          caller can switch the SD file in front of its first block.
+ * @param [in] format SensorOutFormat of the file
+ * @return Number of the new file, the current one if the command was dropped
+ */
+uint32_t SensorOffloadStart(uint8_t format);
+
+/**
+ * @brief Add one sample. Samples are dropped by SENSOR_RING_POLICY when the ring is full.
+ * 
+ * @param [in] pRecord Sensor sample
+ */
+void SensorOffloadPut(const SensorRecord *pRecord);
+
+/**
+ * @brief Add records encoded by the caller, after the samples added so far.
+ * 
+ * @param [in] pBuff Records
+ * @param [in] length Length of pBuff, at most SENSOR_OFFLOAD_BYTES_MAX
+ */
+void SensorOffloadBytes(const char *pBuff, int length);
+
+/**
+ * @brief Close the binary block under construction after the samples
+ *        added so far and hand the block back.
+ */
+void SensorOffloadFlush(void);
+
+/**
+ * @brief End the file after the samples added so far.
+ * 
+ * @details The block under construction is closed and followed by a
+ *          SensorBinClose record, or a $C00300 line in CSV, with the size
+ *          and CRC-32 of the file before it.
+ * @param [in] device Device number of the CSV line
+ */
+void SensorOffloadClose(uint16_t device);
+
+/**
+ * @brief Check whether every queued command has run. Samples after the
+ *        last command may still be queued.
+ * 
+ * @details The encoder waits for a free block when the pool is full, so
+ *          the caller must keep taking blocks with SensorOffloadGet while
+ *          it waits for this.
+ * @return true if done
+ */
+boolean SensorOffloadDone(void);
+
+/**
+ * @brief Get the oldest encoded block.
+ * 
+ * @return Block, NULL if none is encoded
+ */
+const SensorOffloadBlock *SensorOffloadGet(void);
+
+/**
+ * @brief Return the block of SensorOffloadGet to the pool.
+ */
+void SensorOffloadRelease(void);
+
+/**
+ * @brief Check whether samples or commands wait for the encoder.
+ * 
+ * @return true if the encoder has work
+ */
+boolean SensorOffloadPending(void);
+
+/**
+ * @brief Get the counters of the encoder.
+ * 
+ * @param [out] pStat Counters
+ */
+void SensorOffloadGetStat(SensorOffloadStat *pStat);
+
+/**
+ * @brief Run the encoder on this SubCore. Called from setup() of the
+ *        SubCore image, it does not return.
+ */
+void SensorOffloadSubCore(void);
+
+#endif /* _SENSOR_OFFLOAD_H_ */
@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sensor_queue.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Single-producer/single-consumer queue of sample timestamps.
+ */
+
+#ifndef SUBCORE
+#include "sensor_queue.h"
+
+/**
+ * @brief private variables
+ */
+static volatile unsigned long QueueBuff[SENSOR_QUEUE_SIZE];
+static volatile unsigned int QueueHead = 0;   /**< written by producer only */
+static volatile unsigned int QueueTail = 0;   /**< written by consumer only */
+static volatile unsigned long QueueDropped = 0;
+static int QueueMax = 0;                      /**< written by consumer only */
+
+boolean SensorQueuePush(unsigned long time_us)
+{
+  unsigned int next = (QueueHead + 1) % SENSOR_QUEUE_SIZE;
+
+  if (next == QueueTail)
+  {
+    /* Full, keep the older samples. */
+    QueueDropped++;
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  QueueBuff[QueueHead] = time_us;
+  /* Publish the entry after it is written. */
+  __sync_synchronize();
+  QueueHead = next;
+
+  return true;
+}
+
+boolean SensorQueuePop(unsigned long *time_us)
+{
+  int count = SensorQueueCount();
+
+  if (count == 0)
+  {
+    return false;
+  }
+  else if (count > QueueMax)
+  {
+    QueueMax = count;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  *time_us = QueueBuff[QueueTail];
+  /* Release the slot after it is read. */
+  __sync_synchronize();
+  QueueTail = (QueueTail + 1) % SENSOR_QUEUE_SIZE;
+
+  return true;
+}
+
+int SensorQueueCount(void)
+{
+  return (QueueHead + SENSOR_QUEUE_SIZE - QueueTail) % SENSOR_QUEUE_SIZE;
+}
+
+void SensorQueueClear(void)
+{
+  QueueTail = QueueHead;
+}
+
+unsigned long SensorQueueDropped(void)
+{
+  return QueueDropped;
+}
+
+int SensorQueueMax(void)
+{
+  int count = QueueMax;
+
+  QueueMax = 0;
+  return count;
+}
+
+#endif /* SUBCORE */
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _SENSOR_QUEUE_H_
+#define _SENSOR_QUEUE_H_
+
+/**
+ * @file sensor_queue.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Single-producer/single-consumer queue of sample timestamps.
+ * @details The interrupt handler pushes and the main loop pops.
+ *          Each side only writes its own index, so no lock is needed.
+ */
+
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define SENSOR_QUEUE_SIZE      256            /**< Queue capacity [samples] */
+
+/**
+ * @brief Push a sample timestamp. Called from the interrupt handler.
+ * 
+ * @param [in] time_us Sample time [us]
+ * @return true if success, false if the queue is full
+ */
+boolean SensorQueuePush(unsigned long time_us);
+
+/**
+ * @brief Pop the oldest sample timestamp. Called from the main loop.
+ * 
+ * @param [out] time_us Sample time [us]
+ * @return true if success, false if the queue is empty
+ */
+boolean SensorQueuePop(unsigned long *time_us);
+
+/**
+ * @brief Get number of queued timestamps.
+ * 
+ * @return Number of timestamps
+ */
+int SensorQueueCount(void);
+
+/**
+ * @brief Discard all queued timestamps. Called from the main loop.
+ */
+void SensorQueueClear(void);
+
+/**
+ * @brief Get number of timestamps dropped because the queue was full.
+ * 
+ * @return Dropped count
+ */
+unsigned long SensorQueueDropped(void);
+
+/**
+ * @brief Get the most timestamps queued at once since the last call.
+ * 
+ * @return Queued timestamps seen by the consumer
+ */
+int SensorQueueMax(void);
+
+#endif /* _SENSOR_QUEUE_H_ */
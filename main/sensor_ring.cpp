@@ -0,0 +1,198 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sensor_ring.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Single-producer/single-consumer ring of raw sensor samples.
+ * @details With eRingDropOldest the producer writes over the slot at the
+ *          tail. It announces each write in Claim before it touches the
+ *          slot. The consumer copies a slot, then reads Claim: if the
+ *          producer has claimed the slot meanwhile, the copy is discarded
+ *          and the consumer moves past the overwritten samples.
+ */
+
+#include "sensor_ring.h"
+
+#define RING_MASK              (SENSOR_RING_SIZE - 1)
+
+/**
+ * @brief Internal types
+ */
+struct SensorRing
+{
+  /** Written by the producer only. */
+  struct
+  {
+    volatile unsigned long head;      /**< Samples published */
+    volatile unsigned long claim;     /**< Samples being written or published */
+    volatile unsigned long dropped;   /**< Samples dropped by eRingDropNewest */
+    unsigned long high_water;
+    uint8_t policy;
+  } __attribute__((aligned(SENSOR_RING_ALIGN))) Producer;
+
+  /** Written by the consumer only. */
+  struct
+  {
+    volatile unsigned long tail;      /**< Samples popped or skipped */
+    volatile unsigned long skipped;   /**< Samples overwritten by eRingDropOldest */
+  } __attribute__((aligned(SENSOR_RING_ALIGN))) Consumer;
+
+  SensorRecord Buff[SENSOR_RING_SIZE];
+};
+
+/**
+ * @brief private variables
+ */
+#ifndef SUBCORE
+static SensorRing Ring;                       /**< Ring in main core memory */
+static SensorRing *pRing = &Ring;
+#else
+static SensorRing *pRing = NULL;              /**< Ring of the main core, set by SensorRingAttach */
+#endif /* SUBCORE */
+
+SensorRing *SensorRingShared(void)
+{
+  return pRing;
+}
+
+void SensorRingAttach(SensorRing *pShared)
+{
+  pRing = pShared;
+}
+
+void SensorRingBegin(uint8_t policy)
+{
+  pRing->Producer.head = 0;
+  pRing->Producer.claim = 0;
+  pRing->Producer.dropped = 0;
+  pRing->Producer.high_water = 0;
+  pRing->Producer.policy = policy;
+  pRing->Consumer.tail = 0;
+  pRing->Consumer.skipped = 0;
+  __sync_synchronize();
+}
+
+boolean SensorRingPush(const SensorRecord *pRecord)
+{
+  unsigned long head = pRing->Producer.head;
+  unsigned long count = head - pRing->Consumer.tail;
+
+  if (count >= SENSOR_RING_SIZE)
+  {
+    if (pRing->Producer.policy == eRingDropNewest)
+    {
+      /* Full, keep the older samples. */
+      pRing->Producer.dropped++;
+      return false;
+    }
+    else
+    {
+      /* Full, the consumer skips the slot being overwritten. */
+      count = SENSOR_RING_SIZE - 1;
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  if (count + 1 > pRing->Producer.high_water)
+  {
+    pRing->Producer.high_water = count + 1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Announce the write before the slot changes. */
+  pRing->Producer.claim = head + 1;
+  __sync_synchronize();
+  pRing->Buff[head & RING_MASK] = *pRecord;
+  /* Publish the entry after it is written. */
+  __sync_synchronize();
+  pRing->Producer.head = head + 1;
+
+  return true;
+}
+
+boolean SensorRingPop(SensorRecord *pRecord)
+{
+  unsigned long tail = pRing->Consumer.tail;
+  unsigned long claim;
+
+  while (tail != pRing->Producer.head)
+  {
+    /* Read the entry after the index. */
+    __sync_synchronize();
+    *pRecord = pRing->Buff[tail & RING_MASK];
+    __sync_synchronize();
+    claim = pRing->Producer.claim;
+    if (claim - tail <= SENSOR_RING_SIZE)
+    {
+      /* The slot was not claimed again while it was copied. */
+      pRing->Consumer.tail = tail + 1;
+      return true;
+    }
+    else
+    {
+      /* Overwritten, continue at the oldest sample the producer keeps. */
+      pRing->Consumer.skipped = pRing->Consumer.skipped + (claim - SENSOR_RING_SIZE - tail);
+      tail = claim - SENSOR_RING_SIZE;
+      pRing->Consumer.tail = tail;
+    }
+  }
+
+  return false;
+}
+
+unsigned long SensorRingIn(void)
+{
+  return pRing->Producer.head;
+}
+
+unsigned long SensorRingOut(void)
+{
+  return pRing->Consumer.tail;
+}
+
+int SensorRingCount(void)
+{
+  unsigned long count = pRing->Producer.head - pRing->Consumer.tail;
+
+  return (count > SENSOR_RING_SIZE) ? SENSOR_RING_SIZE : (int)count;
+}
+
+void SensorRingGetStat(SensorRingStat *pStat)
+{
+  pStat->pushed = pRing->Producer.head + pRing->Producer.dropped;
+  pStat->dropped = pRing->Producer.dropped + pRing->Consumer.skipped;
+  pStat->high_water = pRing->Producer.high_water;
+}
+
+void SensorRingClearStat(void)
+{
+  pRing->Producer.high_water = 0;
+}
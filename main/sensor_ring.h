@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef _SENSOR_RING_H_
+#define _SENSOR_RING_H_
+
+/**
+ * @file sensor_ring.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Single-producer/single-consumer ring of raw sensor samples.
+ * @details The main loop pushes samples as they are read and the encoder
+ *          pops them, in a thread or on a SubCore. Each side only writes its
+ *          own index and the indices sit on separate cache lines, so no lock
+ *          is needed.
+ *          Indices run freely and are masked, the size is a power of two.
+ *          Dropped samples leave a gap in seq, which the file formats keep.
+ */
+
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define SENSOR_RING_SIZE       256            /**< Ring capacity [samples], power of two */
+#define SENSOR_RING_ALIGN      64             /**< [byte] Cache line, keeps the indices of both sides apart */
+
+#if ((SENSOR_RING_SIZE & (SENSOR_RING_SIZE - 1)) != 0)
+#error "SENSOR_RING_SIZE must be a power of two"
+#endif
+
+/**
+ * @enum SensorRingPolicy
+ * @brief Sample dropped when the ring is full
+ */
+enum SensorRingPolicy
+{
+  eRingDropNewest = 0,  /**< Keep the queued samples, drop the new one */
+  eRingDropOldest,      /**< Overwrite the oldest queued sample */
+};
+
+/**
+ * @struct SensorRing
+ * @brief Ring owned by the main core, see sensor_ring.cpp
+ */
+typedef struct SensorRing SensorRing;
+
+/**
+ * @struct SensorRingStat
+ * @brief Counters of the ring
+ */
+typedef struct
+{
+  unsigned long pushed;       /**< Samples pushed */
+  unsigned long dropped;      /**< Samples dropped because the ring was full */
+  unsigned long high_water;   /**< Most samples queued at once since the last SensorRingClearStat */
+} SensorRingStat;
+
+/**
+ * @brief Empty the ring and set its policy. Both sides must be idle.
+ * 
+ * @param [in] policy SensorRingPolicy
+ */
+void SensorRingBegin(uint8_t policy);
+
+/**
+ * @brief Get the ring of the main core, to pass its address to a SubCore.
+ * 
+ * @return Ring
+ */
+SensorRing *SensorRingShared(void);
+
+/**
+ * @brief Use the ring of the main core. Called on a SubCore before the
+ *        other functions.
+ * 
+ * @param [in] pShared Address from SensorRingShared
+ */
+void SensorRingAttach(SensorRing *pShared);
+
+/**
+ * @brief Push a sample. Called by the producer.
+ * 
+ * @param [in] pRecord Sensor sample
+ * @return true if queued, false if it was dropped (eRingDropNewest)
+ */
+boolean SensorRingPush(const SensorRecord *pRecord);
+
+/**
+ * @brief Pop the oldest sample. Called by the consumer.
+ * 
+ * @param [out] pRecord Sensor sample
+ * @return true if success, false if the ring is empty
+ */
+boolean SensorRingPop(SensorRecord *pRecord);
+
+/**
+ * @brief Get the number of samples pushed so far, including dropped ones.
+ * 
+ * @return Producer index
+ */
+unsigned long SensorRingIn(void);
+
+/**
+ * @brief Get the number of samples popped or skipped so far.
+ * 
+ * @return Consumer index
+ */
+unsigned long SensorRingOut(void);
+
+/**
+ * @brief Get the number of queued samples.
+ * 
+ * @return Number of samples
+ */
+int SensorRingCount(void);
+
+/**
+ * @brief Get the counters of the ring.
+ * 
+ * @param [out] pStat Counters
+ */
+void SensorRingGetStat(SensorRingStat *pStat);
+
+/**
+ * @brief Restart the high water mark. Called by the producer.
+ */
+void SensorRingClearStat(void);
+
+#endif /* _SENSOR_RING_H_ */
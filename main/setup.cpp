@@ -32,6 +32,11 @@ SOFTWARE.
 /**
  * @brief <System Includes> , "Project Includes"
  */
+#ifndef SUBCORE
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <strings.h>
 #include "main.h"
 
 /**
@@ -39,16 +44,189 @@ SOFTWARE.
  */
 extern void SetupPositioning(void);
 extern void Led_isState();
+extern const char *GetParameterKey(int index);
+extern int GetParameter(const char *pKey, char *pBuff, int size, boolean saved);
+extern int SetParameter(const char *pKey, const char *pData);
+extern void SaveParameter(void);
 
 /**
  * @brief private APIs
  */
 static int ReadParameter(ConfigParam *pConfigParam);
 static void WriteParameter(ConfigParam *pConfigParam);
-static String MakeParameterString(ConfigParam *pConfigParam);
-static int ParamCompare(const char *Input , const char *Refer);
+static int MakeParameterString(char *pBuff, int size, const ConfigParam *pConfigParam);
+static void ParseParameter(ConfigParam *pConfigParam, char *pLine);
 static int SetupParameter(void);
 
+/**
+ * @brief Private macro definitions
+ */
+#define PARAM_MEMBER(member)  offsetof(ConfigParam, member), sizeof(((ConfigParam*)0)->member)
+#define PARAM_LIST(list)      list, sizeof(list) / sizeof(list[0])
+
+/**
+ * @enum ParamType
+ * @brief How a parameter is written in the ini file
+ */
+enum ParamType
+{
+  eParamList,         /**< One of the names in pList */
+  eParamUint,         /**< Decimal number from Min to Max */
+  eParamHex,          /**< Number from Min to Max, written in hex */
+  eParamSentence,     /**< NMEA sentence list, see NmeaParseSentence */
+};
+
+/**
+ * @struct ParamName
+ * @brief Name of a listed value
+ */
+typedef struct
+{
+  const char    *pName;  /**< Name in the ini file */
+  unsigned long Value;   /**< Value in ConfigParam */
+} ParamName;
+
+/**
+ * @struct ParamEntry
+ * @brief One key of the ini file
+ */
+typedef struct
+{
+  const char      *pKey;      /**< Key without '=' */
+  const char      *pComment;  /**< Comment line written above the key */
+  ParamType       Type;       /**< How the value is written */
+  boolean         Live;       /**< A change takes effect without a restart */
+  unsigned short  Offset;     /**< Member offset in ConfigParam */
+  unsigned char   Size;       /**< Member size in ConfigParam */
+  unsigned long   Min;        /**< Smallest number */
+  unsigned long   Max;        /**< Largest number */
+  const ParamName *pList;     /**< Names of eParamList */
+  unsigned char   ListNum;    /**< Entries in pList */
+} ParamEntry;
+
+/**
+ * @brief private variables
+ */
+static const ParamName BoolList[] =
+{
+  { "TRUE",  true  },
+  { "FALSE", false },
+};
+
+static const ParamName SatelliteList[] =
+{
+  { "GPS+GLONASS+QZSS_L1CA",  eSatGpsGlonassQz1c },
+  { "GPS+QZSS_L1CA+QZSS_L1S", eSatGpsQz1cQz1S    },
+  { "GPS+QZSS_L1CA",          eSatGpsQz1c        },
+  { "GPS+GLONASS",            eSatGpsGlonass     },
+  { "GLONASS",                eSatGlonass        },
+  { "GPS+SBAS",               eSatGpsSbas        },
+  { "GPS",                    eSatGps            },
+};
+
+static const ParamName FormatList[] =
+{
+  { "CSV",        eFormatCsv        },
+  { "BINARY",     eFormatBinary     },
+  { "COMPRESSED", eFormatCompressed },
+};
+
+static const ParamName AccRateList[] =
+{
+  { "25600", KX122_ODCNTL_OSA_25600HZ },
+  { "12800", KX122_ODCNTL_OSA_12800HZ },
+  { "6400",  KX122_ODCNTL_OSA_6400HZ  },
+  { "3200",  KX122_ODCNTL_OSA_3200HZ  },
+  { "1600",  KX122_ODCNTL_OSA_1600HZ  },
+  { "800",   KX122_ODCNTL_OSA_800HZ   },
+  { "400",   KX122_ODCNTL_OSA_400HZ   },
+  { "200",   KX122_ODCNTL_OSA_200HZ   },
+  { "100",   KX122_ODCNTL_OSA_100HZ   },
+  { "50",    KX122_ODCNTL_OSA_50HZ    },
+  { "25",    KX122_ODCNTL_OSA_25HZ    },
+  { "12.5",  KX122_ODCNTL_OSA_12_5HZ  },
+  { "6.25",  KX122_ODCNTL_OSA_6_25HZ  },
+  { "3.125", KX122_ODCNTL_OSA_3_125HZ },
+  { "1.563", KX122_ODCNTL_OSA_1_563HZ },
+  { "0.781", KX122_ODCNTL_OSA_0_781HZ },
+};
+
+static const ParamName BurstList[] =
+{
+  { "OFF",    eBurstOff    },
+  { "DBA",    eBurstDba    },
+  { "WAKEUP", eBurstWakeup },
+};
+
+static const ParamName AccRangeList[] =
+{
+  { "2", KX122_CNTL1_GSEL_2G },
+  { "4", KX122_CNTL1_GSEL_4G },
+  { "8", KX122_CNTL1_GSEL_8G },
+};
+
+static const ParamName DebugList[] =
+{
+  { "NONE",    PrintNone    },
+  { "ERROR",   PrintError   },
+  { "WARNING", PrintWarning },
+  { "INFO",    PrintInfo    },
+};
+
+/* Keys in the order they are written to the ini file. */
+static const ParamEntry ParamList[] =
+{
+  { "SatelliteSystem",  "; Satellite system(GPS/GLONASS/SBAS/QZSS_L1CA/QZSS_L1S)",
+    eParamList,     false, PARAM_MEMBER(SatelliteSystem),  0, 0,        PARAM_LIST(SatelliteList) },
+  { "NmeaOutUart",      "; Output NMEA message to UART(TRUE/FALSE)",
+    eParamList,     true,  PARAM_MEMBER(NmeaOutUart),      0, 0,        PARAM_LIST(BoolList)      },
+  { "NmeaOutFile",      "; Output NMEA message to file(TRUE/FALSE)",
+    eParamList,     false, PARAM_MEMBER(NmeaOutFile),      0, 0,        PARAM_LIST(BoolList)      },
+  { "NmeaSentence",     "; NMEA sentences to output(GGA+RMC+GSA+GSV+ZDA)",
+    eParamSentence, true,  PARAM_MEMBER(NmeaSentence),     0, 0,        NULL, 0                   },
+  { "SensorOutUart",    "; Output Sensor message to UART(TRUE/FALSE)",
+    eParamList,     true,  PARAM_MEMBER(SensorOutUart),    0, 0,        PARAM_LIST(BoolList)      },
+  { "SensorOutFile",    "; Output Sensor message to file(TRUE/FALSE)",
+    eParamList,     false, PARAM_MEMBER(SensorOutFile),    0, 0,        PARAM_LIST(BoolList)      },
+  { "SensorOutFormat",  "; Sensor file format(CSV/BINARY/COMPRESSED)",
+    eParamList,     false, PARAM_MEMBER(SensorOutFormat),  0, 0,        PARAM_LIST(FormatList)    },
+  { "IntervalSec",      "; Positioning interval sec(1-300)",
+    eParamUint,     false, PARAM_MEMBER(IntervalSec),      1, 300,      NULL, 0                   },
+  { "AccRate",          "; Acceleration output data rate Hz(0.781/1.563/3.125/6.25/12.5/25/50/100-25600)",
+    eParamList,     false, PARAM_MEMBER(AccRate),          0, 0,        PARAM_LIST(AccRateList)   },
+  { "AccRange",         "; Acceleration range G(2/4/8)",
+    eParamList,     false, PARAM_MEMBER(AccRange),         0, 0,        PARAM_LIST(AccRangeList)  },
+  { "PressInterval",    "; Pressure interval ms(100-60000)",
+    eParamUint,     true,  PARAM_MEMBER(PressInterval),    100, 60000,  NULL, 0                   },
+  { "TimeErrorBound",   "; Timestamp error that starts GNSS ms(1-1000)",
+    eParamUint,     false, PARAM_MEMBER(TimeErrorBound),   1, 1000,     NULL, 0                   },
+  { "TrackInterval",    "; Position fix record interval min(0-1440), 0 off",
+    eParamUint,     true,  PARAM_MEMBER(TrackInterval),    0, 1440,     NULL, 0                   },
+  { "ActivityWindow",   "; Activity summary window sec(0-600), 0 off",
+    eParamUint,     false, PARAM_MEMBER(ActivityWindow),   0, 600,      NULL, 0                   },
+  { "BurstTrigger",     "; Burst trigger(OFF/DBA/WAKEUP)",
+    eParamList,     false, PARAM_MEMBER(BurstTrigger),     0, 0,        PARAM_LIST(BurstList)     },
+  { "BurstRate",        "; Burst output data rate Hz(AccRate values, above AccRate)",
+    eParamList,     false, PARAM_MEMBER(BurstRate),        0, 0,        PARAM_LIST(AccRateList)   },
+  { "BurstThreshold",   "; Burst trigger threshold mG(50-8000)",
+    eParamUint,     false, PARAM_MEMBER(BurstThreshold),   50, 8000,    NULL, 0                   },
+  { "BurstPre",         "; Burst samples before the trigger ms(0-5000)",
+    eParamUint,     false, PARAM_MEMBER(BurstPre),         0, 5000,     NULL, 0                   },
+  { "BurstPost",        "; Burst samples after the trigger ms(10-10000)",
+    eParamUint,     false, PARAM_MEMBER(BurstPost),        10, 10000,   NULL, 0                   },
+  { "FileInterval",     "; New file interval min(1-1440)",
+    eParamUint,     true,  PARAM_MEMBER(FileInterval),     1, 1440,     NULL, 0                   },
+  { "StoreRecords",     "; Records collected before they are written(1-16)",
+    eParamUint,     true,  PARAM_MEMBER(StoreRecords),     1, STORE_RECORDS_MAX, NULL, 0          },
+  { "DeviceId",         "; Device number in each record(0x0000-0xFFFF)",
+    eParamHex,      false, PARAM_MEMBER(DeviceId),         0, 0xFFFF,   NULL, 0                   },
+  { "UartDebugMessage", "; Uart debug message(NONE/ERROR/WARNING/INFO)",
+    eParamList,     false, PARAM_MEMBER(UartDebugMessage), 0, 0,        PARAM_LIST(DebugList)     },
+};
+
+static char ParamBuff[CONFIG_FILE_SIZE + 1];  /**< ini file being read or written */
+static ConfigParam SavedParam;                /**< Parameters for the ini file, changed by SetParameter */
+
 /**
  * @brief global variables and functions
  */
@@ -131,168 +309,162 @@ void Led_isState()
 }
 
 /**
- * @brief Convert configuration parameters to String
+ * @brief Get a parameter from ConfigParam.
  * 
  * @param [in] pConfigParam Configuration parameters
- * @return Configuration parameters as String
+ * @param [in] pEntry Key of the parameter
+ * @return Value of the member
  */
-static String MakeParameterString(ConfigParam *pConfigParam)
+static unsigned long ParamGet(const ConfigParam *pConfigParam, const ParamEntry *pEntry)
 {
-  const char *pComment;
-  const char *pParam;
-  const char *pData;
-  char StringBuffer[STRING_BUFFER_SIZE];
-  String ParamString;
+  const unsigned char *pMember = (const unsigned char*)pConfigParam + pEntry->Offset;
 
-  /* Set SatelliteSystem. */
-  pComment = "; Satellite system(GPS/GLONASS/SBAS/QZSS_L1CA/QZSS_L1S)";
-  pParam = "SatelliteSystem=";
-  switch (pConfigParam->SatelliteSystem)
+  switch (pEntry->Size)
   {
-    case eSatGps:
-      pData = "GPS";
-      break;
+    case 1:
+      return *(const uint8_t*)pMember;
 
-    case eSatGpsSbas:
-      pData = "GPS+SBAS";
-      break;
+    case 2:
+      return *(const uint16_t*)pMember;
 
-    case eSatGlonass:
-      pData = "GLONASS";
-      break;
+    default:
+      return *(const uint32_t*)pMember;
+  }
+}
 
-    case eSatGpsGlonass:
-      pData = "GPS+GLONASS";
-      break;
+/**
+ * @brief Set a parameter in ConfigParam.
+ * 
+ * @param [out] pConfigParam Configuration parameters
+ * @param [in] pEntry Key of the parameter
+ * @param [in] value Value of the member
+ */
+static void ParamSet(ConfigParam *pConfigParam, const ParamEntry *pEntry, unsigned long value)
+{
+  unsigned char *pMember = (unsigned char*)pConfigParam + pEntry->Offset;
 
-    case eSatGpsQz1c:
-      pData = "GPS+QZSS_L1CA";
+  switch (pEntry->Size)
+  {
+    case 1:
+      *(uint8_t*)pMember = (uint8_t)value;
       break;
 
-    case eSatGpsQz1cQz1S:
-      pData = "GPS+QZSS_L1CA+QZSS_L1S";
+    case 2:
+      *(uint16_t*)pMember = (uint16_t)value;
       break;
 
-    case eSatGpsGlonassQz1c:
     default:
-      pData = "GPS+GLONASS+QZSS_L1CA";
+      *(uint32_t*)pMember = (uint32_t)value;
       break;
   }
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%s\n%s%s\n", pComment, pParam, pData);
-  ParamString += StringBuffer;
+}
 
-  /* Set NmeaOutUart. */
-  pComment = "; Output NMEA message to UART(TRUE/FALSE)";
-  pParam = "NmeaOutUart=";
-  if (pConfigParam->NmeaOutUart == FALSE)
-  {
-    pData = "FALSE";
-  }
-  else
-  {
-    pData = "TRUE";
-  }
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%s\n%s%s\n", pComment, pParam, pData);
-  ParamString += StringBuffer;
+/**
+ * @brief Get the text of a parameter in the ini file.
+ * 
+ * @param [in] pConfigParam Configuration parameters
+ * @param [in] pEntry Key of the parameter
+ * @param [out] pBuff %Buffer for numbers, at least 24 bytes
+ * @param [in] size Size of pBuff
+ * @return Value text, pBuff or a name of pList
+ */
+static const char *ParamFormat(const ConfigParam *pConfigParam, const ParamEntry *pEntry, char *pBuff, int size)
+{
+  unsigned long value = ParamGet(pConfigParam, pEntry);
+  int item;
 
-  /* Set NmeaOutFile. */
-  pComment = "; Output NMEA message to file(TRUE/FALSE)";
-  pParam = "NmeaOutFile=";
-  if (pConfigParam->NmeaOutFile == FALSE)
-  {
-    pData = "FALSE";
-  }
-  else
+  switch (pEntry->Type)
   {
-    pData = "TRUE";
-  }
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%s\n%s%s\n", pComment, pParam, pData);
-  ParamString += StringBuffer;
+    case eParamList:
+      for (item = 0; item < pEntry->ListNum; item++)
+      {
+        if (pEntry->pList[item].Value == value)
+        {
+          return pEntry->pList[item].pName;
+        }
+        else
+        {
+          /* do nothing. */
+        }
+      }
+      return pEntry->pList[0].pName;
 
-  /* Set SensorOutUart. */
-  pComment = "; Output Sensor message to UART(TRUE/FALSE)";
-  pParam = "SensorOutUart=";
-  if (pConfigParam->SensorOutUart == FALSE)
-  {
-    pData = "FALSE";
+    case eParamHex:
+      snprintf(pBuff, size, "0x%04lX", value);
+      return pBuff;
+
+    case eParamSentence:
+      NmeaSentenceName(pBuff, size, value);
+      return pBuff;
+
+    case eParamUint:
+    default:
+      snprintf(pBuff, size, "%lu", value);
+      return pBuff;
   }
-  else
+}
+
+/**
+ * @brief Convert configuration parameters to the ini file.
+ * 
+ * @param [out] pBuff %Buffer to write the ini file
+ * @param [in] size Size of pBuff
+ * @param [in] pConfigParam Configuration parameters
+ * @return Length without NUL
+ */
+static int MakeParameterString(char *pBuff, int size, const ConfigParam *pConfigParam)
+{
+  const ParamEntry *pEntry;
+  char DataBuffer[32];
+  int length = 0;
+  unsigned int cnt;
+
+  for (cnt = 0; cnt < sizeof(ParamList) / sizeof(ParamList[0]); cnt++)
   {
-    pData = "TRUE";
+    pEntry = &ParamList[cnt];
+    length += snprintf(&pBuff[length], size - length, "%s\n%s=%s\n", pEntry->pComment, pEntry->pKey,
+                       ParamFormat(pConfigParam, pEntry, DataBuffer, sizeof(DataBuffer)));
+    if (length >= size)
+    {
+      return 0;
+    }
+    else
+    {
+      /* do nothing. */
+    }
   }
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%s\n%s%s\n", pComment, pParam, pData);
-  ParamString += StringBuffer;
 
-  /* Set SensorOutFile. */
-  pComment = "; Output Sensor message to file(TRUE/FALSE)";
-  pParam = "SensorOutFile=";
-  if (pConfigParam->NmeaOutFile == FALSE)
+  /* End of file. */
+  length += snprintf(&pBuff[length], size - length, "; EOF");
+  if (length >= size)
   {
-    pData = "FALSE";
+    return 0;
   }
   else
   {
-    pData = "TRUE";
-  }
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%s\n%s%s\n", pComment, pParam, pData);
-  ParamString += StringBuffer;
-
-  /* Set IntervalSec. */
-  pComment = "; Positioning interval sec(1-300)";
-  pParam = "IntervalSec=";
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%s\n%s%d\n", pComment, pParam, pConfigParam->IntervalSec);
-  ParamString += StringBuffer;
-
-  /* Set UartDebugMessage. */
-  pComment = "; Uart debug message(NONE/ERROR/WARNING/INFO)";
-  pParam = "UartDebugMessage=";
-  switch (pConfigParam->UartDebugMessage)
-  {
-    case PrintError:
-      pData = "ERROR";
-      break;
-
-    case PrintWarning:
-      pData = "WARNING";
-      break;
-
-    case PrintInfo:
-      pData = "INFO";
-      break;
-
-    case PrintNone:
-    default:
-      pData = "NONE";
-      break;
+    /* do nothing. */
   }
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "%s\n%s%s\n", pComment, pParam, pData);
-  ParamString += StringBuffer;
-
-  /* End of file. */
-  snprintf(StringBuffer, STRING_BUFFER_SIZE, "; EOF");
-  ParamString += StringBuffer;
 
-  return ParamString;
+  return length;
 }
 
 /**
  * @brief Create an ini file based on the current parameters.
  * 
  * @param [in] pConfigParam Configuration parameters
- * @return 0 if success, -1 if failure
  */
 void WriteParameter(ConfigParam *pConfigParam)
 {
-  String ParamString;
+  int length;
 
   /* Make parameter data. */
-  ParamString = MakeParameterString(pConfigParam);
+  length = MakeParameterString(ParamBuff, sizeof(ParamBuff), pConfigParam);
 
   /* Write parameter data. */
-  if (strlen(ParamString.c_str()) != 0)
+  if (length != 0)
   {
-    write_size = WriteChar(ParamString.c_str(), CONFIG_FILE_NAME, FILE_WRITE);
-    if (write_size != strlen(ParamString.c_str()))
+    write_size = WriteChar(ParamBuff, CONFIG_FILE_NAME, FILE_WRITE);
+    if (write_size != (unsigned long)length)
     {
       state = eStateWriteError;
       Led_isState();
@@ -309,76 +481,20 @@ void WriteParameter(ConfigParam *pConfigParam)
 }
 
 /**
- * @brief Read the ini file and set it as a parameter.
+ * @brief Find a key of the ini file.
  * 
- * @details If there is no description, it will be the default value.
- * @param [out] pConfigParam Configuration parameters
- * @return 0 if success, -1 if failure
+ * @param [in] pKey Key without '=', not case sensitive
+ * @return Key of the parameter, NULL if unknown
  */
-static int ReadParameter(ConfigParam *pConfigParam)
+static const ParamEntry *ParamFind(const char *pKey)
 {
-  char *pReadBuff = NULL;
-  int ReadSize = 0;
-  int CharCount;
-  int LineCount = 0;
-  boolean FindSeparator = true;
-  char *LineList[128] = {0,};
-  int MaxLine = LineCount;
-  char *pParamName;
-  char *pParamData;
-  int length;
-  int tmp;
-
-  pReadBuff = (char*)malloc(CONFIG_FILE_SIZE);
-  if (pReadBuff == NULL)
-  {
-    return -1;
-  }
-  else
-  {
-    /* do nothing. */  
-  }
-
-  /* Read file. */
-  ReadSize = ReadChar(pReadBuff, CONFIG_FILE_SIZE, CONFIG_FILE_NAME, FILE_READ);
-  if (ReadSize == 0)
-  {
-    return -1;
-  }
-  else
-  {
-    /* do nothing. */
-  }
+  unsigned int cnt;
 
-  /* Set NULL at EOF. */
-  pReadBuff[ReadSize] = NULL;
-
-  /* Record the start position for each line. */
-  for (CharCount = 0; CharCount < ReadSize; CharCount++)
+  for (cnt = 0; cnt < sizeof(ParamList) / sizeof(ParamList[0]); cnt++)
   {
-    if (FindSeparator == true)
-    {
-      LineList[LineCount] = &pReadBuff[CharCount];
-      FindSeparator = false;
-      LineCount++;
-      if (LineCount >= 128)
-      {
-        break;
-      }
-      else
-      {
-        /* nop */
-      }
-    }
-    else
+    if (strcasecmp(pKey, ParamList[cnt].pKey) == 0)
     {
-      /* do nothing. */
-    }
-
-    if (pReadBuff[CharCount] == SEPARATOR)
-    {
-      FindSeparator = true;
-      pReadBuff[CharCount] = NULL;
+      return &ParamList[cnt];
     }
     else
     {
@@ -386,121 +502,179 @@ static int ReadParameter(ConfigParam *pConfigParam)
     }
   }
 
-  /* Parse each line. */
-  for (LineCount = 0; LineCount < MaxLine; LineCount++)
-  {
-    pParamName = LineList[LineCount];
+  return NULL;
+}
 
-    pParamData = NULL;
-    if (pParamName[0] != ';')
-    {
-      length = strlen(pParamName);
+/**
+ * @brief Set a parameter from its text in the ini file.
+ * 
+ * @param [in,out] pConfigParam Configuration parameters
+ * @param [in] pEntry Key of the parameter
+ * @param [in] pData Value without spaces around it
+ * @return true if set, false if the value is unknown, not a number or out of range
+ */
+static boolean ParamParse(ConfigParam *pConfigParam, const ParamEntry *pEntry, const char *pData)
+{
+  unsigned long value;
+  char *pEnd;
+  int item;
 
-      for (CharCount = 0; CharCount < length; CharCount++)
+  switch (pEntry->Type)
+  {
+    case eParamList:
+      for (item = 0; item < pEntry->ListNum; item++)
       {
-        if (pParamName[CharCount] == '=')
+        if (strcasecmp(pData, pEntry->pList[item].pName) == 0)
+        {
+          ParamSet(pConfigParam, pEntry, pEntry->pList[item].Value);
+          return true;
+        }
+        else
         {
-          pParamData = &(pParamName[CharCount + 1]);
-          break;
+          /* do nothing. */
         }
       }
-    }
+      return false;
 
-    /* Parse start. */
-    if (pParamData == NULL)
-    {
-      /* nop */
-    }
-    else if (!ParamCompare(pParamName, "SatelliteSystem="))
-    {
-      if (!ParamCompare(pParamData, "GPS+GLONASS+QZSS_L1CA"))
+    case eParamSentence:
+      value = NmeaParseSentence(pData);
+      if (value == 0)
       {
-        pConfigParam->SatelliteSystem = eSatGpsGlonassQz1c;
-      }
-      else if (!ParamCompare(pParamData, "GPS+QZSS_L1CA+QZSS_L1S"))
-      {
-        pConfigParam->SatelliteSystem = eSatGpsQz1cQz1S;
-      }
-      else if (!ParamCompare(pParamData, "GPS+QZSS_L1CA"))
-      {
-        pConfigParam->SatelliteSystem = eSatGpsQz1c;
-      }
-      else if (!ParamCompare(pParamData, "GPS+GLONASS"))
-      {
-        pConfigParam->SatelliteSystem = eSatGpsGlonass;
-      }
-      else if (!ParamCompare(pParamData, "GLONASS"))
-      {
-        pConfigParam->SatelliteSystem = eSatGlonass;
-      }
-      else if (!ParamCompare(pParamData, "GPS+SBAS"))
-      {
-        pConfigParam->SatelliteSystem = eSatGpsSbas;
-      }
-      else if (!ParamCompare(pParamData, "GPS"))
-      {
-        pConfigParam->SatelliteSystem = eSatGps;
+        return false;
       }
       else
       {
-        pConfigParam->SatelliteSystem = eSatGpsGlonassQz1c;
+        ParamSet(pConfigParam, pEntry, value);
+        return true;
       }
-    }
-    else if (!ParamCompare(pParamName, "NmeaOutUart="))
-    {
-      if (!ParamCompare(pParamData, "FALSE"))
+
+    case eParamUint:
+    case eParamHex:
+    default:
+      /* strtoul takes "-1" as ULONG_MAX, only digits may start the number. */
+      if (isdigit((unsigned char)pData[0]) == 0)
       {
-        pConfigParam->NmeaOutUart = false;
+        return false;
       }
       else
       {
-        pConfigParam->NmeaOutUart = true;
+        /* do nothing. */
       }
-    }
-    else if (!ParamCompare(pParamName, "NmeaOutFile="))
-    {
-      if (!ParamCompare(pParamData, "FALSE"))
+      errno = 0;
+      value = strtoul(pData, &pEnd, (pEntry->Type == eParamHex) ? 0 : 10);
+      if ((*pEnd != '\0') || (errno == ERANGE) || (value < pEntry->Min) || (value > pEntry->Max))
       {
-        pConfigParam->NmeaOutFile = false;
+        return false;
       }
       else
       {
-        pConfigParam->NmeaOutFile = true;
+        ParamSet(pConfigParam, pEntry, value);
+        return true;
       }
-    }
-    else if (!ParamCompare(pParamName, "IntervalSec="))
-    {
-      tmp = strtoul(pParamData, NULL, 10);
-      pConfigParam->IntervalSec = max(1, min(tmp, 300));
-    }
-    else if (!ParamCompare(pParamName, "UartDebugMessage="))
+  }
+}
+
+/**
+ * @brief Parse one line of the ini file.
+ * 
+ * @details Keys and names are not case sensitive. Unknown keys, unknown
+ *          names and numbers out of range keep the current value.
+ * @param [in,out] pConfigParam Configuration parameters
+ * @param [in] pLine Line without the separator, modified in place
+ */
+static void ParseParameter(ConfigParam *pConfigParam, char *pLine)
+{
+  const ParamEntry *pEntry;
+  char *pData;
+  char *pEnd;
+
+  /* Skip blank lines and comments. */
+  while (isspace(*pLine))
+  {
+    pLine++;
+  }
+  pData = strchr(pLine, '=');
+  if ((*pLine == ';') || (pData == NULL))
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Cut the key and the value, without spaces around them. */
+  pEnd = pData;
+  while ((pEnd > pLine) && isspace(pEnd[-1]))
+  {
+    pEnd--;
+  }
+  *pEnd = '\0';
+  pData++;
+  while (isspace(*pData))
+  {
+    pData++;
+  }
+  pEnd = pData + strlen(pData);
+  while ((pEnd > pData) && isspace(pEnd[-1]))
+  {
+    pEnd--;
+  }
+  *pEnd = '\0';
+
+  pEntry = ParamFind(pLine);
+  if (pEntry != NULL)
+  {
+    ParamParse(pConfigParam, pEntry, pData);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Read the ini file and set it as a parameter.
+ * 
+ * @details If there is no description, it will be the default value.
+ * @param [out] pConfigParam Configuration parameters
+ * @return 0 if success, -1 if failure
+ */
+static int ReadParameter(ConfigParam *pConfigParam)
+{
+  int ReadSize;
+  char *pLine;
+  char *pNext;
+
+  /* Read file. */
+  ReadSize = ReadChar(ParamBuff, CONFIG_FILE_SIZE, CONFIG_FILE_NAME, FILE_READ);
+  if (ReadSize <= 0)
+  {
+    return -1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  /* Set NULL at EOF. */
+  ParamBuff[ReadSize] = '\0';
+
+  /* Parse each line. */
+  for (pLine = ParamBuff; *pLine != '\0'; pLine = pNext)
+  {
+    pNext = strchr(pLine, SEPARATOR);
+    if (pNext != NULL)
     {
-      if (!ParamCompare(pParamData, "NONE"))
-      {
-        pConfigParam->UartDebugMessage = PrintNone;
-      }
-      else if (!ParamCompare(pParamData, "ERROR"))
-      {
-        pConfigParam->UartDebugMessage = PrintError;
-      }
-      else if (!ParamCompare(pParamData, "WARNING"))
-      {
-        pConfigParam->UartDebugMessage = PrintWarning;
-      }
-      else if (!ParamCompare(pParamData, "INFO"))
-      {
-        pConfigParam->UartDebugMessage = PrintInfo;
-      }
-      else
-      {
-        /* do nothing. */
-      }
+      *pNext++ = '\0';
     }
     else
     {
-      /* do nothing. */
+      pNext = pLine + strlen(pLine);
     }
+    ParseParameter(pConfigParam, pLine);
   }
+
   return OK;
 }
 
@@ -512,7 +686,6 @@ static int ReadParameter(ConfigParam *pConfigParam)
 int SetupParameter(void)
 {
   int ret;
-  String ParamString;
 
   /* Read parameter file. */
   ret = ReadParameter(&Parameter);
@@ -525,32 +698,90 @@ int SetupParameter(void)
   {
     /* do nothing. */
   }
-
-  /* Print parameter. */
-  ParamString = MakeParameterString(&Parameter);
+  SavedParam = Parameter;
 
   return ret;
 }
 
 /**
- * @brief Compare parameter.
+ * @brief Get a key of the ini file.
+ * 
+ * @param [in] index Number of the key from 0
+ * @return Key, NULL after the last key
+ */
+const char *GetParameterKey(int index)
+{
+  if ((index < 0) || (index >= (int)(sizeof(ParamList) / sizeof(ParamList[0]))))
+  {
+    return NULL;
+  }
+  else
+  {
+    return ParamList[index].pKey;
+  }
+}
+
+/**
+ * @brief Get the text of a parameter as written in the ini file.
+ * 
+ * @param [in] pKey Key, not case sensitive
+ * @param [out] pBuff %Buffer for the text
+ * @param [in] size Size of pBuff
+ * @param [in] saved true for the value for the ini file, false for the value in use
+ * @return Length of the text, -1 if the key is unknown
+ */
+int GetParameter(const char *pKey, char *pBuff, int size, boolean saved)
+{
+  const ParamEntry *pEntry = ParamFind(pKey);
+  char DataBuffer[32];
+
+  if (pEntry == NULL)
+  {
+    return -1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  return snprintf(pBuff, size, "%s", ParamFormat(saved ? &SavedParam : &Parameter, pEntry, DataBuffer, sizeof(DataBuffer)));
+}
+
+/**
+ * @brief Set a parameter from its text as written in the ini file.
  * 
- * @param [in] Input Parameter to compare
- * @param [in] Refer Reference parameter
- * @return 0 if equal
+ * @details The value is kept for SaveParameter. Keys that the loop reads
+ *          each time are also changed in use, the others at the next start.
+ * @param [in] pKey Key, not case sensitive
+ * @param [in] pData Value text
+ * @return 0 if in use now, 1 if in use after the next start, -1 if invalid
  */
-int ParamCompare(const char *Input , const char *Refer)
+int SetParameter(const char *pKey, const char *pData)
 {
-  /* Set argument. */
-  String InputStr = Input;
-  String ReferStr = Refer;
+  const ParamEntry *pEntry = ParamFind(pKey);
 
-  /* Convert to upper case. */
-  InputStr.toUpperCase();
-  ReferStr.toUpperCase();
+  if ((pEntry == NULL) || (ParamParse(&SavedParam, pEntry, pData) == false))
+  {
+    return -1;
+  }
+  else if (pEntry->Live == true)
+  {
+    ParamSet(&Parameter, pEntry, ParamGet(&SavedParam, pEntry));
+    return 0;
+  }
+  else
+  {
+    /* Taken at the next start from the saved file. */
+    return 1;
+  }
+}
 
-  /* Compare. */
-  return memcmp(InputStr.c_str(), ReferStr.c_str(), strlen(ReferStr.c_str()));
+/**
+ * @brief Write the parameters set by SetParameter to the ini file.
+ */
+void SaveParameter(void)
+{
+  WriteParameter(&SavedParam);
 }
 
 extern void SetupPositioning(void)
@@ -559,9 +790,25 @@ extern void SetupPositioning(void)
   Parameter.SatelliteSystem  = SATELLIT_ESYSTEM;
   Parameter.NmeaOutUart      = NMEA_OUT_UART;
   Parameter.NmeaOutFile      = NMEA_OUT_FILE;
+  Parameter.NmeaSentence     = NMEA_OUT_SENTENCE;
   Parameter.SensorOutUart    = SENSOR_OUT_UART;
   Parameter.SensorOutFile    = SENSOR_OUT_FILE;
+  Parameter.SensorOutFormat  = SENSOR_OUT_FORMAT;
   Parameter.IntervalSec      = INTERVAL_SEC;
+  Parameter.AccRate          = SENSOR_ACC_RATE;
+  Parameter.AccRange         = SENSOR_ACC_RANGE;
+  Parameter.PressInterval    = SENSOR_PRESS_INTERVAL;
+  Parameter.TimeErrorBound   = GNSS_ERROR_BOUND;
+  Parameter.TrackInterval    = TRACK_INTERVAL;
+  Parameter.ActivityWindow   = ACTIVITY_WINDOW;
+  Parameter.BurstTrigger     = BURST_TRIGGER;
+  Parameter.BurstRate        = BURST_RATE;
+  Parameter.BurstThreshold   = BURST_THRESHOLD;
+  Parameter.BurstPre         = BURST_PRE;
+  Parameter.BurstPost        = BURST_POST;
+  Parameter.FileInterval     = FILE_INTERVAL / 60000;
+  Parameter.StoreRecords     = STORE_RECORDS_NUM;
+  Parameter.DeviceId         = DEVICE_ID;
   Parameter.UartDebugMessage = UART_DEBUG_MESSAGE;
 
   /* Mount SD card. */
@@ -625,3 +872,5 @@ extern void SetupPositioning(void)
     Gnss.setInterval(Parameter.IntervalSec);
   }
 }
+
+#endif /* SUBCORE */
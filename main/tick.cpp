@@ -0,0 +1,291 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file tick.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Periodic tasks of the main loop run at absolute deadlines.
+ */
+
+#ifndef SUBCORE
+#include "tick.h"
+
+/**
+ * @struct TickTask
+ * @brief One periodic task
+ */
+typedef struct
+{
+  const char    *pName;       /**< Name for the counters */
+  void          (*pHandler)(void);
+  uint64_t      period_us;    /**< Period [us] */
+  uint64_t      deadline_us;  /**< Timebase counter of the next run [us] */
+  boolean       running;      /**< Started */
+  unsigned long runs;
+  unsigned long overruns;
+  unsigned long late_max_us;
+  uint64_t      late_sum_us;
+  unsigned long exec_min_us;
+  unsigned long exec_max_us;
+  uint64_t      exec_sum_us;
+} TickTask;
+
+/**
+ * @brief private variables
+ */
+static TickTask Tasks[TICK_TASK_MAX];
+static int TaskNum = 0;
+
+int TickAdd(const char *pName, void (*pHandler)(void), uint64_t period_us)
+{
+  TickTask *pTask;
+
+  if (TaskNum >= TICK_TASK_MAX)
+  {
+    return -1;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pTask = &Tasks[TaskNum];
+  memset(pTask, 0, sizeof(*pTask));
+  pTask->pName = pName;
+  pTask->pHandler = pHandler;
+  pTask->period_us = period_us;
+
+  return TaskNum++;
+}
+
+void TickStart(int task, uint64_t count_us)
+{
+  if ((task < 0) || (task >= TaskNum))
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  Tasks[task].deadline_us = count_us;
+  Tasks[task].running = true;
+}
+
+void TickStop(int task)
+{
+  if ((task < 0) || (task >= TaskNum))
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  Tasks[task].running = false;
+}
+
+void TickSetPeriod(int task, uint64_t period_us)
+{
+  TickTask *pTask;
+
+  if ((task < 0) || (task >= TaskNum) || (Tasks[task].period_us == period_us))
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pTask = &Tasks[task];
+  if ((pTask->running == true) && (pTask->period_us != 0))
+  {
+    /* Keep the last deadline, the task was run there. */
+    pTask->deadline_us = pTask->deadline_us - pTask->period_us + period_us;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  pTask->period_us = period_us;
+}
+
+int TickRun(uint64_t count_us)
+{
+  TickTask *pTask;
+  uint64_t begin_us;
+  unsigned long late_us;
+  unsigned long exec_us;
+  uint64_t missed;
+  int num = 0;
+  int task;
+
+  for (task = 0; task < TaskNum; task++)
+  {
+    pTask = &Tasks[task];
+    if ((pTask->running == false) || (count_us < pTask->deadline_us))
+    {
+      continue;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    if (pTask->period_us == 0)
+    {
+      /* Runs at each call, it is never late. */
+      pTask->deadline_us = count_us;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+
+    begin_us = TimebaseNow();
+    pTask->pHandler();
+    exec_us = (unsigned long)(TimebaseNow() - begin_us);
+    late_us = (unsigned long)(begin_us - pTask->deadline_us);
+    num++;
+
+    if ((pTask->runs == 0) || (exec_us < pTask->exec_min_us))
+    {
+      pTask->exec_min_us = exec_us;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    pTask->exec_max_us = max(pTask->exec_max_us, exec_us);
+    pTask->exec_sum_us += exec_us;
+    pTask->late_max_us = max(pTask->late_max_us, late_us);
+    pTask->late_sum_us += late_us;
+    pTask->runs++;
+
+    if ((pTask->period_us != 0) && (pTask->running == true))
+    {
+      /* Next period of the schedule, skip the ones that were missed. */
+      pTask->deadline_us += pTask->period_us;
+      if (pTask->deadline_us < count_us)
+      {
+        missed = (count_us - pTask->deadline_us) / pTask->period_us + 1;
+        pTask->deadline_us += missed * pTask->period_us;
+        pTask->overruns += (unsigned long)missed;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  return num;
+}
+
+uint64_t TickNext(void)
+{
+  uint64_t next_us = TICK_NONE;
+  int task;
+
+  for (task = 0; task < TaskNum; task++)
+  {
+    if ((Tasks[task].running == true) && (Tasks[task].deadline_us < next_us))
+    {
+      next_us = Tasks[task].deadline_us;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  return next_us;
+}
+
+const char *TickName(int task)
+{
+  if ((task < 0) || (task >= TaskNum))
+  {
+    return NULL;
+  }
+  else
+  {
+    return Tasks[task].pName;
+  }
+}
+
+void TickGetStat(int task, TickStat *pStat)
+{
+  const TickTask *pTask;
+
+  memset(pStat, 0, sizeof(*pStat));
+  if ((task < 0) || (task >= TaskNum))
+  {
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  pTask = &Tasks[task];
+  pStat->runs = pTask->runs;
+  pStat->overruns = pTask->overruns;
+  pStat->late_max_us = pTask->late_max_us;
+  pStat->exec_min_us = pTask->exec_min_us;
+  pStat->exec_max_us = pTask->exec_max_us;
+  if (pTask->runs != 0)
+  {
+    pStat->late_avg_us = (unsigned long)(pTask->late_sum_us / pTask->runs);
+    pStat->exec_avg_us = (unsigned long)(pTask->exec_sum_us / pTask->runs);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+void TickClearStat(void)
+{
+  int task;
+
+  for (task = 0; task < TaskNum; task++)
+  {
+    Tasks[task].runs = 0;
+    Tasks[task].overruns = 0;
+    Tasks[task].late_max_us = 0;
+    Tasks[task].late_sum_us = 0;
+    Tasks[task].exec_min_us = 0;
+    Tasks[task].exec_max_us = 0;
+    Tasks[task].exec_sum_us = 0;
+  }
+}
+
+#endif /* SUBCORE */
@@ -0,0 +1,135 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef _TICK_H_
+#define _TICK_H_
+
+/**
+ * @file tick.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Periodic tasks of the main loop run at absolute deadlines.
+ * @details Each task has a period and the timebase counter of its next run.
+ *          After a run the deadline moves by whole periods, never to the
+ *          time the task was seen, so late runs do not shift later ones.
+ *          A task more than a whole period late skips the missed runs and
+ *          counts them as overruns, one due exactly now runs on time. Start
+ *          delay and run time of each task are measured. Called from the
+ *          main loop only.
+ */
+
+#include <stdint.h>
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define TICK_TASK_MAX          8              /**< Most tasks */
+#define TICK_NONE              UINT64_MAX     /**< TickNext without a running task */
+
+/**
+ * @struct TickStat
+ * @brief Counters of one task
+ */
+typedef struct
+{
+  unsigned long runs;         /**< Runs since the counters were cleared */
+  unsigned long overruns;     /**< Runs skipped because the task was more than a whole period late */
+  unsigned long late_max_us;  /**< Longest start after the deadline [us] */
+  unsigned long late_avg_us;  /**< Average start after the deadline [us] */
+  unsigned long exec_min_us;  /**< Shortest run [us] */
+  unsigned long exec_max_us;  /**< Longest run [us] */
+  unsigned long exec_avg_us;  /**< Average run [us] */
+} TickStat;
+
+/**
+ * @brief Add a stopped task.
+ * 
+ * @param [in] pName Name for the counters
+ * @param [in] pHandler Called at each deadline
+ * @param [in] period_us Period [us], 0 to run at each TickRun
+ * @return Task number, -1 if TICK_TASK_MAX tasks are added
+ */
+int TickAdd(const char *pName, void (*pHandler)(void), uint64_t period_us);
+
+/**
+ * @brief Start a task.
+ * 
+ * @param [in] task Task number
+ * @param [in] count_us Timebase counter of the first run [us]
+ */
+void TickStart(int task, uint64_t count_us);
+
+/**
+ * @brief Stop a task. Its counters are kept.
+ * 
+ * @param [in] task Task number
+ */
+void TickStop(int task);
+
+/**
+ * @brief Change the period of a task.
+ * 
+ * @details The next deadline is moved to the last one plus the new period,
+ *          so a shorter period may make the task due at once.
+ * @param [in] task Task number
+ * @param [in] period_us Period [us]
+ */
+void TickSetPeriod(int task, uint64_t period_us);
+
+/**
+ * @brief Run every task that is due, once, in the order they were added.
+ * 
+ * @param [in] count_us Timebase counter [us]
+ * @return Number of tasks run
+ */
+int TickRun(uint64_t count_us);
+
+/**
+ * @brief Get the earliest deadline of the running tasks.
+ * 
+ * @return Timebase counter [us], TICK_NONE if no task runs
+ */
+uint64_t TickNext(void);
+
+/**
+ * @brief Get the name of a task.
+ * 
+ * @param [in] task Task number
+ * @return Name, NULL if there is no such task
+ */
+const char *TickName(int task);
+
+/**
+ * @brief Get the counters of a task.
+ * 
+ * @param [in] task Task number
+ * @param [out] pStat Counters
+ */
+void TickGetStat(int task, TickStat *pStat);
+
+/**
+ * @brief Clear the counters of all tasks.
+ */
+void TickClearStat(void);
+
+#endif /* _TICK_H_ */
@@ -0,0 +1,336 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file timebase.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Sample timestamps from a monotonic counter fitted to GNSS time.
+ */
+
+#ifndef SUBCORE
+#include "timebase.h"
+
+/**
+ * @struct TimebaseBin
+ * @brief GNSS fixes averaged into one point of the fit
+ */
+typedef struct
+{
+  uint64_t      count;        /**< Counter of the first fix [us] */
+  int64_t       offset;       /**< UTC minus counter of the first fix [us] */
+  int64_t       sum_count;    /**< Sum of counter differences to the first fix [us] */
+  int64_t       sum_offset;   /**< Sum of offset differences to the first fix [us] */
+  unsigned long num;          /**< Fixes in the bin */
+} TimebaseBin;
+
+/**
+ * @brief private variables
+ */
+static uint64_t CounterHigh = 0;              /**< Upper 32 bit of the counter */
+static unsigned long CounterLast = 0;         /**< Last micros() */
+static TimebaseBin Bins[TIMEBASE_FIT_NUM];
+static int BinHead = 0;                       /**< Newest bin */
+static int BinNum = 0;
+static boolean ModelValid = false;
+static uint64_t ModelCount = 0;               /**< Counter where ModelOffset applies [us] */
+static int64_t ModelOffset = 0;               /**< UTC minus counter at ModelCount [us] */
+static long ModelRate = 0;                    /**< Change of ModelOffset per counter second [ppb] */
+static uint64_t LastFixCount = 0;             /**< Counter of the last fix [us] */
+static TimebaseStat Stat = {};
+
+/**
+ * @brief Convert a GNSS time to microseconds since 1970/01/01.
+ * 
+ * @param [in] pTime GNSS time (UTC)
+ * @return UTC [us]
+ */
+static int64_t GnssToUs(const SpGnssTime *pTime)
+{
+  RtcTime utc(pTime->year, pTime->month, pTime->day, pTime->hour, pTime->minute, pTime->sec, 0);
+
+  return (int64_t)utc.unixtime() * 1000000LL + pTime->usec;
+}
+
+/**
+ * @brief Convert the counter with the current model.
+ * 
+ * @param [in] count_us Counter [us]
+ * @return UTC [us]
+ */
+static int64_t ModelToUs(uint64_t count_us)
+{
+  int64_t elapsed = (int64_t)(count_us - ModelCount);
+
+  return (int64_t)count_us + ModelOffset + elapsed * ModelRate / 1000000000LL;
+}
+
+/**
+ * @brief Get the mean of a bin.
+ * 
+ * @param [in] pBin Bin
+ * @param [out] count Mean counter [us]
+ * @param [out] offset Mean UTC minus counter [us]
+ */
+static void BinMean(const TimebaseBin *pBin, uint64_t *count, int64_t *offset)
+{
+  *count = pBin->count + pBin->sum_count / (int64_t)pBin->num;
+  *offset = pBin->offset + pBin->sum_offset / (int64_t)pBin->num;
+}
+
+/**
+ * @brief Fit the model through the bins.
+ * 
+ * @details Least squares line relative to the newest bin. With one bin
+ *          only the offset is updated and the last rate is kept.
+ *          The uncertainty of the rate is two standard errors of the slope,
+ *          with the scatter of the bins taken as at least TIMEBASE_NOISE_US.
+ */
+static void Fit(void)
+{
+  uint64_t count_n;
+  int64_t offset_n;
+  uint64_t count;
+  int64_t offset;
+  double x;
+  double y;
+  double sx = 0;
+  double sy = 0;
+  double sxx = 0;
+  double sxy = 0;
+  double slope;
+  double intercept;
+  double sxxc;
+  double sse = 0;
+  double noise = TIMEBASE_NOISE_US;
+  double n = BinNum;
+  int cnt;
+
+  BinMean(&Bins[BinHead], &count_n, &offset_n);
+  ModelCount = count_n;
+  ModelOffset = offset_n;
+  Stat.span_us = 0;
+  Stat.noise_us = TIMEBASE_NOISE_US;
+  Stat.uncert_ppb = TIMEBASE_RATE_MAX_PPB;
+
+  if (BinNum >= 2)
+  {
+    for (cnt = 0; cnt < BinNum; cnt++)
+    {
+      BinMean(&Bins[(BinHead + TIMEBASE_FIT_NUM - cnt) % TIMEBASE_FIT_NUM], &count, &offset);
+      x = (double)(int64_t)(count - count_n) / 1000000.0; /* [s] */
+      y = (double)(offset - offset_n);                    /* [us] */
+      sx += x;
+      sy += y;
+      sxx += x * x;
+      sxy += x * y;
+      Stat.span_us = count_n - count;
+    }
+
+    sxxc = sxx - sx * sx / n;
+    if (sxxc > 0)
+    {
+      /* [us/s] = [ppm] */
+      slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+      intercept = (sy - slope * sx) / n;
+      ModelRate = (long)(slope * 1000.0 + ((slope < 0) ? -0.5 : 0.5));
+      ModelOffset = offset_n + (int64_t)intercept;
+
+      if (BinNum >= 3)
+      {
+        for (cnt = 0; cnt < BinNum; cnt++)
+        {
+          BinMean(&Bins[(BinHead + TIMEBASE_FIT_NUM - cnt) % TIMEBASE_FIT_NUM], &count, &offset);
+          x = (double)(int64_t)(count - count_n) / 1000000.0;
+          y = (double)(offset - offset_n) - (intercept + slope * x);
+          sse += y * y;
+        }
+        noise = max(noise, sqrt(sse / (n - 2)));
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      Stat.noise_us = (long)noise;
+      Stat.uncert_ppb = max((long)TIMEBASE_WANDER_PPB, (long)(2.0 * noise / sqrt(sxxc) * 1000.0));
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  ModelValid = true;
+  Stat.bins = BinNum;
+  Stat.rate_ppb = ModelRate;
+}
+
+void TimebaseBegin(void)
+{
+  BinHead = 0;
+  BinNum = 0;
+  ModelValid = false;
+  ModelRate = 0;
+  memset(&Stat, 0, sizeof(Stat));
+}
+
+uint64_t TimebaseNow(void)
+{
+  unsigned long now = micros();
+
+  if (now < CounterLast)
+  {
+    /* micros() wrapped. */
+    CounterHigh += 0x100000000ULL;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  CounterLast = now;
+
+  return CounterHigh | now;
+}
+
+uint64_t TimebaseExtend(unsigned long time_us)
+{
+  uint64_t now = TimebaseNow();
+
+  return now - (uint32_t)((uint32_t)now - (uint32_t)time_us);
+}
+
+boolean TimebaseFix(uint64_t count_us, const SpGnssTime *pTime, long *residual_us)
+{
+  TimebaseBin *pBin;
+  int64_t utc = GnssToUs(pTime);
+  int64_t offset = utc - (int64_t)count_us;
+  int64_t residual = 0;
+  boolean compared = false;
+
+  if (ModelValid == true)
+  {
+    residual = ModelToUs(count_us) - utc;
+    if (llabs(residual) < TIMEBASE_RESET_US)
+    {
+      compared = true;
+    }
+    else
+    {
+      /* GNSS or counter jumped, older bins no longer fit. */
+      BinNum = 0;
+      Stat.resets += 1;
+    }
+  }
+  else
+  {
+    BinNum = 0;
+  }
+
+  pBin = &Bins[BinHead];
+  if ((BinNum > 0) && ((count_us - pBin->count) < (uint64_t)TIMEBASE_BIN_MS * 1000))
+  {
+    /* Average fixes of one GNSS session. */
+    pBin->sum_count += (int64_t)(count_us - pBin->count);
+    pBin->sum_offset += offset - pBin->offset;
+    pBin->num += 1;
+  }
+  else
+  {
+    /* Start a new bin, the oldest one is dropped when all are used. */
+    BinHead = (BinNum > 0) ? ((BinHead + 1) % TIMEBASE_FIT_NUM) : 0;
+    BinNum = min(BinNum + 1, TIMEBASE_FIT_NUM);
+    pBin = &Bins[BinHead];
+    pBin->count = count_us;
+    pBin->offset = offset;
+    pBin->sum_count = 0;
+    pBin->sum_offset = 0;
+    pBin->num = 1;
+  }
+
+  Fit();
+
+  LastFixCount = count_us;
+  Stat.fixes += 1;
+  Stat.residual_us = (long)residual;
+  *residual_us = (long)residual;
+
+  return compared;
+}
+
+boolean TimebaseToUtc(uint64_t count_us, uint32_t *sec, uint32_t *usec)
+{
+  int64_t utc;
+
+  if (ModelValid == false)
+  {
+    *sec = 0;
+    *usec = 0;
+    return false;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  utc = ModelToUs(count_us);
+  *sec = (uint32_t)(utc / 1000000);
+  *usec = (uint32_t)(utc % 1000000);
+
+  return true;
+}
+
+unsigned long TimebaseError(uint64_t count_us)
+{
+  uint64_t elapsed;
+  uint64_t error;
+
+  if (ModelValid == false)
+  {
+    return 0xFFFFFFFF;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  elapsed = (count_us > LastFixCount) ? (count_us - LastFixCount) : 0;
+  error = (uint64_t)Stat.noise_us + elapsed / 1000 * (uint64_t)Stat.uncert_ppb / 1000000;
+
+  return (error > 0xFFFFFFFF) ? 0xFFFFFFFF : (unsigned long)error;
+}
+
+long TimebaseDrift(void)
+{
+  return ModelRate;
+}
+
+void TimebaseGetStat(TimebaseStat *pStat)
+{
+  *pStat = Stat;
+}
+
+#endif /* SUBCORE */
@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+
+/**
+ * @file timebase.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Sample timestamps from a monotonic counter fitted to GNSS time.
+ * @details Samples are stamped with a 64 bit microsecond counter built on
+ *          micros(). GNSS fixes are averaged into bins and a line
+ *          (offset + rate) is fitted through the bins, so the counter is
+ *          converted to UTC without reading the RTC and without the one
+ *          second steps of an RTC correction. Called from the main loop only.
+ */
+
+#include <stdint.h>
+#include "main.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define TIMEBASE_FIT_NUM       8              /**< Bins in the fit, 8 file rotations by default */
+#define TIMEBASE_BIN_MS        60000          /**< [ms] Fixes closer than this are averaged into one bin */
+#define TIMEBASE_RESET_US      100000         /**< [us] Larger disagreement restarts the fit */
+#define TIMEBASE_NOISE_US      200            /**< [us] Smallest error assumed for a bin */
+#define TIMEBASE_WANDER_PPB    500            /**< [ppb] Smallest drift uncertainty, oscillator wander */
+#define TIMEBASE_RATE_MAX_PPB  50000          /**< [ppb] Drift uncertainty before a rate is measured */
+
+/**
+ * @struct TimebaseStat
+ * @brief State of the fit
+ */
+typedef struct
+{
+  unsigned long fixes;        /**< GNSS fixes since the fit was started */
+  unsigned long resets;       /**< Fits restarted because of a disagreement */
+  int           bins;         /**< Bins in the fit */
+  long          residual_us;  /**< Model minus GNSS time at the last fix [us] */
+  long          rate_ppb;     /**< Counter drift, positive if the counter is slow [ppb] */
+  long          uncert_ppb;   /**< Uncertainty of rate_ppb [ppb] */
+  long          noise_us;     /**< Scatter of the bins around the line [us] */
+  uint64_t      span_us;      /**< Counter time covered by the bins [us] */
+} TimebaseStat;
+
+/**
+ * @brief Clear the fit. The counter keeps running.
+ */
+void TimebaseBegin(void);
+
+/**
+ * @brief Get the monotonic counter.
+ * 
+ * @details Extends micros() to 64 bit, so it has to be called at least
+ *          once per 71 minutes.
+ * @return Counter [us]
+ */
+uint64_t TimebaseNow(void);
+
+/**
+ * @brief Extend a recent micros() value, e.g. taken in an interrupt handler.
+ * 
+ * @param [in] time_us micros() at most 71 minutes ago
+ * @return Counter [us]
+ */
+uint64_t TimebaseExtend(unsigned long time_us);
+
+/**
+ * @brief Add a GNSS fix to the fit.
+ * 
+ * @param [in] count_us Counter when the fix was received
+ * @param [in] pTime GNSS time (UTC)
+ * @param [out] residual_us Model minus GNSS time before the fix was added [us]
+ * @return true if the fix was compared with a model, false if the fit (re)started
+ */
+boolean TimebaseFix(uint64_t count_us, const SpGnssTime *pTime, long *residual_us);
+
+/**
+ * @brief Convert the counter to UTC.
+ * 
+ * @param [in] count_us Counter [us]
+ * @param [out] sec UTC [s since 1970/01/01]
+ * @param [out] usec UTC [us]
+ * @return true if success, false if there was no GNSS fix yet
+ */
+boolean TimebaseToUtc(uint64_t count_us, uint32_t *sec, uint32_t *usec);
+
+/**
+ * @brief Get the current drift estimate.
+ * 
+ * @return Counter drift, positive if the counter is slow [ppb]
+ */
+long TimebaseDrift(void);
+
+/**
+ * @brief Predict the timestamp error.
+ * 
+ * @details Grows with the drift uncertainty since the last GNSS fix.
+ * @param [in] count_us Counter [us]
+ * @return Predicted error [us], 0xFFFFFFFF if there was no GNSS fix yet
+ */
+unsigned long TimebaseError(uint64_t count_us);
+
+/**
+ * @brief Get the state of the fit.
+ * 
+ * @param [out] pStat State
+ */
+void TimebaseGetStat(TimebaseStat *pStat);
+
+#endif /* _TIMEBASE_H_ */
@@ -0,0 +1,423 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file codec_test.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Round trip test of the delta/zigzag/varint sensor codec.
+ * @details Host side test. Build:
+ *          g++ -O2 -Imain -o codec_test test/codec_test.cpp
+ *              main/sensor_binary.cpp main/sensor_codec.cpp main/sensor_format.cpp
+ *          Usage: codec_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sensor_binary.h"
+#include "sensor_codec.h"
+#include "test_check.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define TEST_SAMPLES           2000           /**< Largest sample set */
+#define TEST_STREAM_SIZE       (TEST_SAMPLES * SENSOR_CODEC_SAMPLE_MAX + 4096) /**< Encoded records */
+#define TEST_START_SEC         1700000000UL   /**< Time of the first sample */
+#define TEST_DEVICE            0x0102         /**< Device number */
+#define TEST_SENS              4096           /**< Acceleration counts per G */
+
+/**
+ * @struct TestStream
+ * @brief Closed blocks of one encoder run
+ */
+typedef struct
+{
+  uint8_t buff[TEST_STREAM_SIZE]; /**< Records back to back */
+  int     length;                 /**< Bytes used in buff */
+  int     blocks;                 /**< Closed blocks */
+  int     largest;                /**< Longest block [bytes] */
+  int     smallest;               /**< Shortest block other than the last [bytes] */
+} TestStream;
+
+static SensorBinHead Head;        /**< File header of the stream */
+
+/**
+ * @brief Fill samples with a fixed period, pressure and rising sequence.
+ * 
+ * @param [out] pSet Samples
+ * @param [in] num Number of samples
+ * @param [in] period_us Sample period [us]
+ */
+static void MakeSamples(SensorRecord *pSet, int num, unsigned long period_us)
+{
+  unsigned long long time_us;
+  int cnt;
+
+  memset(pSet, 0, sizeof(SensorRecord) * num);
+  for (cnt = 0; cnt < num; cnt++)
+  {
+    time_us = (unsigned long long)cnt * period_us;
+    pSet[cnt].sec = TEST_START_SEC + (unsigned long)(time_us / 1000000ULL);
+    pSet[cnt].msec = (unsigned short)((time_us / 1000ULL) % 1000ULL);
+    pSet[cnt].device = TEST_DEVICE;
+    pSet[cnt].seq = 100 + cnt;
+    pSet[cnt].interval_us = period_us;
+    pSet[cnt].sens = TEST_SENS;
+    pSet[cnt].press = 1013 * 2048;
+  }
+}
+
+/**
+ * @brief Append one closed block to the stream.
+ * 
+ * @param [in,out] pStream Stream
+ * @param [in] pBlock Closed block
+ * @param [in] length Bytes of the block
+ */
+static void Append(TestStream *pStream, const uint8_t *pBlock, int length)
+{
+  if (length > 0)
+  {
+    memcpy(&pStream->buff[pStream->length], pBlock, length);
+    pStream->length += length;
+    pStream->blocks++;
+    pStream->largest = (length > pStream->largest) ? length : pStream->largest;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Encode samples into delta blocks.
+ * 
+ * @param [out] pStream Stream
+ * @param [in] pSet Samples
+ * @param [in] num Number of samples
+ */
+static void Encode(TestStream *pStream, const SensorRecord *pSet, int num)
+{
+  static SensorCodecBlock Block;
+  uint8_t Closed[SENSOR_CODEC_BLOCK_MAX];
+  int length;
+  int cnt;
+
+  pStream->length = 0;
+  pStream->blocks = 0;
+  pStream->largest = 0;
+  pStream->smallest = SENSOR_CODEC_BLOCK_MAX;
+  SensorCodecReset(&Block);
+  for (cnt = 0; cnt < num; cnt++)
+  {
+    length = SensorCodecPut(&Block, &pSet[cnt], Closed);
+    pStream->smallest = ((length > 0) && (length < pStream->smallest)) ? length : pStream->smallest;
+    Append(pStream, Closed, length);
+  }
+  Append(pStream, Closed, SensorCodecFlush(&Block, Closed));
+}
+
+/**
+ * @brief Decode a stream and compare it with the samples.
+ * 
+ * @param [in] pStream Stream
+ * @param [in] pSet Expected samples
+ * @param [in] num Number of samples
+ * @param [in] pName Test name
+ */
+static void Verify(const TestStream *pStream, const SensorRecord *pSet, int num, const char *pName)
+{
+  SensorCodecDecoder Decoder;
+  SensorRecord Record;
+  uint8_t type;
+  uint8_t count;
+  int pos = 0;
+  int index = 0;
+  int length;
+  int rc;
+  bool same = true;
+
+  while (pos < pStream->length)
+  {
+    length = SensorBinReadTag(&pStream->buff[pos], &type, &count);
+    Check((type == eBinDelta) && (length <= SENSOR_CODEC_BLOCK_MAX), pName, "block tag");
+    SensorCodecBegin(&Decoder, &pStream->buff[pos], &Head);
+    while ((rc = SensorCodecNext(&Decoder, &Record)) > 0)
+    {
+      if ((index >= num) || (Record.sec != pSet[index].sec) || (Record.msec != pSet[index].msec) ||
+          (Record.seq != pSet[index].seq) || (Record.interval_us != pSet[index].interval_us) ||
+          (Record.press != pSet[index].press) || (Record.sens != pSet[index].sens) ||
+          (Record.device != pSet[index].device) || (memcmp(Record.acc, pSet[index].acc, sizeof(Record.acc)) != 0))
+      {
+        if (same == true)
+        {
+          printf("  sample %d: seq %lu interval %lu acc %d %d %d\n", index, Record.seq, Record.interval_us,
+                 Record.acc[0], Record.acc[1], Record.acc[2]);
+        }
+        else
+        {
+          /* do nothing. */
+        }
+        same = false;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      index++;
+    }
+    Check(rc == 0, pName, "block decodes to its end");
+    pos += length;
+  }
+  Check(same, pName, "decoded samples match");
+  Check(index == num, pName, "decoded sample count");
+}
+
+/**
+ * @brief Write an unsigned LEB128 varint for hand made blocks.
+ * 
+ * @param [out] p %Buffer
+ * @param [in] value Value
+ * @return Pointer past the varint
+ */
+static uint8_t *PutVarint(uint8_t *p, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    *p++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+
+  return p;
+}
+
+/**
+ * @brief A single sample is one key frame with absolute values.
+ */
+static void TestKeyFrame(void)
+{
+  static SensorRecord Set[2];
+  static TestStream Stream;
+
+  MakeSamples(Set, 1, 1250);
+  Set[0].acc[0] = -1;
+  Set[0].acc[1] = 63;
+  Set[0].acc[2] = 64;
+  Encode(&Stream, Set, 1);
+  /* interval 1250 is 2 bytes, zigzag -1 -> 1, 63 -> 126 and 64 -> 128 (2 bytes). */
+  Check(Stream.length == SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD + 2 + 1 + 1 + 2, "keyframe", "key frame size");
+  Verify(&Stream, Set, 1, "keyframe");
+}
+
+/**
+ * @brief Steps across the whole int16 range, the residuals need 17 bits.
+ */
+static void TestInt16Wrap(void)
+{
+  static const int16_t Value[] = {32767, -32768, 32767, 0, -32768, -1, 32767, 1, -32767};
+  static SensorRecord Set[64];
+  static TestStream Stream;
+  int num = sizeof(Value) / sizeof(Value[0]);
+  int cnt;
+
+  MakeSamples(Set, num, 1000);
+  for (cnt = 0; cnt < num; cnt++)
+  {
+    Set[cnt].acc[0] = Value[cnt];
+    Set[cnt].acc[1] = Value[(cnt + 1) % num];
+    Set[cnt].acc[2] = -Value[cnt] - 1;
+  }
+  Encode(&Stream, Set, num);
+  Check(Stream.blocks == 1, "int16", "one block");
+  Verify(&Stream, Set, num, "int16");
+}
+
+/**
+ * @brief Intervals and gaps that need 5 byte varints.
+ */
+static void TestVarint5(void)
+{
+  static SensorRecord Set[8];
+  static TestStream Stream;
+
+  MakeSamples(Set, 4, 1000);
+  /* Key frame interval of 0xFFFFFFFF is 5 bytes. */
+  Set[0].interval_us = 0xFFFFFFFFUL;
+  /* Interval far from dt * 1000, the residual wraps modulo 2^32. */
+  Set[1].interval_us = 0x80000000UL;
+  /* A gap of 3000001 [ms]: dt is 4 bytes and dt * 1000 does not fit 31 bits. */
+  Set[2].sec = Set[1].sec + 3000;
+  Set[2].interval_us = 3000000000UL;
+  Set[3].sec = Set[2].sec;
+  Set[3].msec = Set[2].msec + 1;
+  Set[3].interval_us = 0;
+  Encode(&Stream, Set, 4);
+  Check(Stream.blocks == 1, "varint5", "one block");
+  /* Key frame 5+3, then dt 1 residual 5, dt 4 residual 2 and dt 1 residual 2, acc 3 each. */
+  Check(Stream.length == SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD + 8 + 9 + 9 + 6, "varint5", "varint sizes");
+  Verify(&Stream, Set, 4, "varint5");
+}
+
+/**
+ * @brief Long runs are split when the next sample might not fit.
+ */
+static void TestBlockFull(void)
+{
+  static SensorRecord Set[TEST_SAMPLES];
+  static TestStream Stream;
+  int cnt;
+  int axis;
+
+  /* Resting: 5 bytes per sample, so 95 samples reach 495 bytes and the byte limit
+     closes the block long before SENSOR_CODEC_BLOCK_NUM. */
+  MakeSamples(Set, TEST_SAMPLES, 1000);
+  Encode(&Stream, Set, TEST_SAMPLES);
+  Check(Stream.largest <= SENSOR_CODEC_BLOCK_MAX, "full", "resting block size");
+  Check(Stream.smallest > SENSOR_CODEC_BLOCK_MAX - SENSOR_CODEC_SAMPLE_MAX, "full", "resting blocks filled");
+  Check(Stream.blocks == (TEST_SAMPLES + 94) / 95, "full", "resting block count");
+  Verify(&Stream, Set, TEST_SAMPLES, "full");
+
+  /* Worst case: full scale noise, intervals far from dt. */
+  srand(7);
+  for (cnt = 0; cnt < TEST_SAMPLES; cnt++)
+  {
+    for (axis = 0; axis < 3; axis++)
+    {
+      Set[cnt].acc[axis] = (int16_t)(rand() & 0xFFFF);
+    }
+    Set[cnt].interval_us = (((unsigned long)rand() << 16) ^ (unsigned long)rand()) & 0xFFFFFFFFUL;
+  }
+  Encode(&Stream, Set, TEST_SAMPLES);
+  Check(Stream.largest <= SENSOR_CODEC_BLOCK_MAX, "noise", "noise block size");
+  Check(Stream.smallest > SENSOR_CODEC_BLOCK_MAX - SENSOR_CODEC_SAMPLE_MAX, "noise", "noise blocks filled");
+  Verify(&Stream, Set, TEST_SAMPLES, "noise");
+}
+
+/**
+ * @brief Pressure change, sequence gap and time going backwards close a block.
+ */
+static void TestSplit(void)
+{
+  static SensorRecord Set[40];
+  static TestStream Stream;
+
+  MakeSamples(Set, 40, 2000);
+  Set[10].press += 1;
+  Set[11].press += 1;
+  Set[20].seq += 5;
+  Set[21].seq += 5;
+  Set[30].sec -= 1;
+  Encode(&Stream, Set, 40);
+  /* 0-9, 10-11, 12-19, 20-21, 22-29 and 30-39, time goes forward again after 30. */
+  Check(Stream.blocks == 6, "split", "block count");
+  Verify(&Stream, Set, 40, "split");
+}
+
+/**
+ * @brief Version 1 blocks stored the interval in [ms].
+ */
+static void TestVersion1(void)
+{
+  static SensorRecord Set[3];
+  uint8_t Block[SENSOR_CODEC_BLOCK_MAX];
+  uint8_t *p = &Block[SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD];
+  SensorCodecDecoder Decoder;
+  SensorRecord Record;
+  SensorBinHead Head1 = Head;
+  int cnt;
+
+  MakeSamples(Set, 3, 10000);
+  Set[2].msec += 3;
+  Set[2].interval_us = 13000;
+  /* Key frame interval 10, then dt 10 and 13 with interval - dt 0. */
+  p = PutVarint(p, 10);
+  p = PutVarint(p, 0);
+  p = PutVarint(p, 0);
+  p = PutVarint(p, 0);
+  for (cnt = 0; cnt < 2; cnt++)
+  {
+    p = PutVarint(p, (cnt == 0) ? 10 : 13);
+    p = PutVarint(p, 0);
+    p = PutVarint(p, 0);
+    p = PutVarint(p, 0);
+    p = PutVarint(p, 0);
+  }
+  SensorBinWriteBlockHead(Block, eBinDelta, 3, (int)(p - Block) - SENSOR_BIN_TAG_SIZE,
+                          Set[0].seq, Set[0].sec, Set[0].msec, Set[0].press);
+  Head1.version = 1;
+  SensorCodecBegin(&Decoder, Block, &Head1);
+  for (cnt = 0; cnt < 3; cnt++)
+  {
+    Check(SensorCodecNext(&Decoder, &Record) == 1, "v1", "sample decoded");
+    Check((Record.interval_us == Set[cnt].interval_us) && (Record.msec == Set[cnt].msec) &&
+          (Record.seq == Set[cnt].seq), "v1", "interval in [us]");
+  }
+  Check(SensorCodecNext(&Decoder, &Record) == 0, "v1", "end of block");
+}
+
+/**
+ * @brief A block cut short must not decode past its end.
+ */
+static void TestTruncated(void)
+{
+  static SensorRecord Set[10];
+  static TestStream Stream;
+  SensorCodecDecoder Decoder;
+  SensorRecord Record;
+  int rc;
+  int decoded = 0;
+
+  MakeSamples(Set, 10, 1000);
+  Set[9].acc[0] = 20000;
+  Encode(&Stream, Set, 10);
+  /* Drop the last byte but keep the sample count. */
+  SensorBinWriteBlockHead(Stream.buff, eBinDelta, 10, Stream.length - 1 - SENSOR_BIN_TAG_SIZE,
+                          Set[0].seq, Set[0].sec, Set[0].msec, Set[0].press);
+  SensorCodecBegin(&Decoder, Stream.buff, &Head);
+  while ((rc = SensorCodecNext(&Decoder, &Record)) > 0)
+  {
+    decoded++;
+  }
+  Check((rc == -1) && (decoded == 9), "truncated", "corrupt block reported");
+}
+
+int main(void)
+{
+  memset(&Head, 0, sizeof(Head));
+  Head.version = SENSOR_BIN_VERSION;
+  Head.device = TEST_DEVICE;
+  Head.sens = TEST_SENS;
+
+  TestKeyFrame();
+  TestInt16Wrap();
+  TestVarint5();
+  TestBlockFull();
+  TestSplit();
+  TestVersion1();
+  TestTruncated();
+
+  return CheckResult();
+}
@@ -0,0 +1,179 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file format_bench.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Compare FormatSensorRecord with the former snprintf formatter.
+ * @details Host side test. Every record must match the float formatter and
+ *          the time per record of both is printed. Build:
+ *          g++ -O2 -Imain -o format_bench test/format_bench.cpp main/sensor_format.cpp
+ *          Usage: format_bench [records]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sensor_format.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define BENCH_RECORDS          200000         /**< Default records per formatter */
+#define BENCH_SET              1024           /**< Distinct records cycled through */
+#define LINE_SIZE              160            /**< Reference line buffer */
+
+/**
+ * @brief Format one record the way getSensor did before, with snprintf and float.
+ * 
+ * @param [out] pBuff Output buffer
+ * @param [in] size Size of pBuff
+ * @param [in] pRecord Sensor record
+ * @return Length of the record
+ */
+static int FormatReference(char *pBuff, int size, const SensorRecord *pRecord)
+{
+  struct tm Time;
+  time_t sec = (time_t)pRecord->sec;
+
+  gmtime_r(&sec, &Time);
+  return snprintf(pBuff, size, "%s,0x%04X,%04d/%02d/%02d %02d:%02d:%02d.%03d,%lu,%.3f,%5.3f,%5.3f,%5.3f,%4.4f\n",
+                  SENSOR_RECORD_SIGN, pRecord->device,
+                  Time.tm_year + 1900, Time.tm_mon + 1, Time.tm_mday, Time.tm_hour, Time.tm_min, Time.tm_sec, pRecord->msec,
+                  pRecord->seq, pRecord->interval_us / 1000.0,
+                  (double)pRecord->acc[0] / pRecord->sens, (double)pRecord->acc[1] / pRecord->sens,
+                  (double)pRecord->acc[2] / pRecord->sens, pRecord->press / 2048.0);
+}
+
+/**
+ * @brief Get a monotonic time.
+ * 
+ * @return Time [ns]
+ */
+static unsigned long long NowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Fill the record set with edge values and random samples.
+ * 
+ * @param [out] pSet Records
+ * @param [in] num Number of records
+ */
+static void MakeRecords(SensorRecord *pSet, int num)
+{
+  static const unsigned short Sens[] = {16384, 8192, 4096};
+  static const signed short Edge[] = {0, 1, -1, 8, -8, 32767, -32768, 16383, -16384};
+  int cnt;
+  int axis;
+
+  srand(1);
+  for (cnt = 0; cnt < num; cnt++)
+  {
+    pSet[cnt].sec = 1577836800UL + (unsigned long)rand() % 400000000UL;
+    pSet[cnt].msec = rand() % 1000;
+    pSet[cnt].device = rand() & 0xFFFF;
+    pSet[cnt].seq = (cnt < 2) ? (cnt * 0xFFFFFFFFUL) : (unsigned long)rand();
+    pSet[cnt].interval_us = (cnt < 2) ? (cnt * 0xFFFFFFFFUL) : (unsigned long)rand() % 2000000UL;
+    pSet[cnt].sens = Sens[cnt % 3];
+    for (axis = 0; axis < 3; axis++)
+    {
+      pSet[cnt].acc[axis] = (cnt < 9) ? Edge[(cnt + axis) % 9] : (signed short)(rand() & 0xFFFF);
+    }
+    /* BM1383AGLV range 300 to 1100 [hPa], 2048 counts per hPa. */
+    pSet[cnt].press = (cnt < 2) ? (cnt * 1100UL * 2048UL) : 300UL * 2048UL + (unsigned long)rand() % (800UL * 2048UL);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  static SensorRecord Set[BENCH_SET];
+  char Line[SENSOR_RECORD_MAX];
+  char Expect[LINE_SIZE];
+  unsigned long records = (argc > 1) ? strtoul(argv[1], NULL, 10) : 0;
+  unsigned long cnt;
+  unsigned long long start;
+  unsigned long long ref_ns;
+  unsigned long long fmt_ns;
+  unsigned long sum = 0;
+  int errors = 0;
+
+  if (records == 0)
+  {
+    records = BENCH_RECORDS;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  MakeRecords(Set, BENCH_SET);
+
+  for (cnt = 0; cnt < BENCH_SET; cnt++)
+  {
+    FormatReference(Expect, sizeof(Expect), &Set[cnt]);
+    FormatSensorRecord(Line, sizeof(Line), &Set[cnt]);
+    if (strcmp(Line, Expect) != 0)
+    {
+      if (errors < 10)
+      {
+        printf("mismatch %lu\n  got    %s  expect %s", cnt, Line, Expect);
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      errors++;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+
+  start = NowNs();
+  for (cnt = 0; cnt < records; cnt++)
+  {
+    sum += FormatReference(Expect, sizeof(Expect), &Set[cnt % BENCH_SET]);
+  }
+  ref_ns = NowNs() - start;
+
+  start = NowNs();
+  for (cnt = 0; cnt < records; cnt++)
+  {
+    sum += FormatSensorRecord(Line, sizeof(Line), &Set[cnt % BENCH_SET]);
+  }
+  fmt_ns = NowNs() - start;
+
+  printf("snprintf %llu ns/record, FormatSensorRecord %llu ns/record, %.1fx (%lu bytes)\n",
+         ref_ns / records, fmt_ns / records, (double)ref_ns / (fmt_ns ? fmt_ns : 1), sum);
+  printf("%d of %d records differ\n", errors, BENCH_SET);
+
+  return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file nmea_test.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Test of the NMEA sentence builders with fixed navigation data.
+ * @details Host side test. The expected sentences and checksums were
+ *          written from the NMEA 0183 field layout, not from the builder.
+ *          Build:
+ *          g++ -O2 -Itest/stubs -Imain -o nmea_test test/nmea_test.cpp
+ *              main/gnss_nmea.cpp main/sensor_format.cpp
+ *          Usage: nmea_test
+ */
+
+#include <GNSS.h>
+#include "gnss_nmea.h"
+#include "test_check.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define TEST_SMALL_SIZE        20             /**< Buffer too short for any sentence */
+
+/**
+ * @brief private variables
+ */
+static const char ExpectRmc[] = "$GPRMC,123456.78,A,3540.8742,N,13946.0275,E,2.9,87.3,171026,,,A*60\r\n";
+static const char ExpectGsa[] = "$GPGSA,A,3,,,,,,,,,,,,,1.8,0.9,1.5*36\r\n";
+static const char ExpectGsv[] = "$GPGSV,2,1,05,05,45,123,38,13,08,007,,193,70,200,42,50,40,190,33*4C\r\n"
+                                "$GPGSV,2,2,05,20,15,045,22*4B\r\n"
+                                "$GLGSV,1,1,01,67,30,300,25*52\r\n";
+static const char ExpectZda[] = "$GPZDA,123456.78,17,10,2026,00,00*6F\r\n";
+static const char ExpectRmcNoFix[] = "$GPRMC,123456.78,V,,,,,,,171026,,,N*76\r\n";
+static const char ExpectGsaNoFix[] = "$GPGSA,A,1,,,,,,,,,,,,,,,*1E\r\n";
+
+/**
+ * @brief Compare a built sentence with the expected one.
+ * 
+ * @param [in] pName Test name
+ * @param [in] pBuff Built sentences
+ * @param [in] length Length returned by the builder
+ * @param [in] pExpect Expected sentences
+ */
+static void CheckSentence(const char *pName, const char *pBuff, int length, const char *pExpect)
+{
+  if (strcmp(pBuff, pExpect) != 0)
+  {
+    printf("%s built:    %s", pName, pBuff);
+    printf("%s expected: %s", pName, pExpect);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  Check(strcmp(pBuff, pExpect) == 0, pName, "sentence");
+  Check(length == (int)strlen(pExpect), pName, "length");
+}
+
+/**
+ * @brief Set one satellite in view.
+ * 
+ * @param [out] pNavData Navigation data
+ * @param [in] index Satellite index
+ * @param [in] type Satellite system
+ * @param [in] svid Satellite ID from the receiver
+ * @param [in] elevation [deg] Elevation
+ * @param [in] azimuth [deg] Azimuth
+ * @param [in] level [dB-Hz] Signal level, 0 if not tracked
+ */
+static void SetSatellite(SpNavData *pNavData, int index, SpSatelliteType type, unsigned short svid,
+                         unsigned char elevation, short azimuth, float level)
+{
+  pNavData->satellite[index].type = type;
+  pNavData->satellite[index].svid = svid;
+  pNavData->satellite[index].elevation = elevation;
+  pNavData->satellite[index].azimuth = azimuth;
+  pNavData->satellite[index].sigLevel = level;
+}
+
+/**
+ * @brief Fixed 3D fix at 2026-10-17 12:34:56.78 UTC with six satellites.
+ * 
+ * @param [out] pNavData Navigation data
+ */
+static void MakeNavData(SpNavData *pNavData)
+{
+  memset(pNavData, 0, sizeof(*pNavData));
+  pNavData->time.year = 2026;
+  pNavData->time.month = 10;
+  pNavData->time.day = 17;
+  pNavData->time.hour = 12;
+  pNavData->time.minute = 34;
+  pNavData->time.sec = 56;
+  pNavData->time.usec = 780000;
+  pNavData->type = SpPvtTypeGnss;
+  pNavData->posFixMode = Fix3D;
+  pNavData->posDataExist = 1;
+  pNavData->latitude = 35.681236;
+  pNavData->longitude = 139.767125;
+  pNavData->altitude = 40.25;
+  pNavData->velocity = 1.5f;
+  pNavData->direction = 87.3f;
+  pNavData->pdop = 1.8f;
+  pNavData->hdop = 0.9f;
+  pNavData->vdop = 1.5f;
+  pNavData->numSatellitesCalcPos = 5;
+  pNavData->numSatellites = 6;
+
+  /* QZSS and SBAS are reported by GP, SBAS PRN 137 is 50, GLONASS slot 3 is 67. */
+  SetSatellite(pNavData, 0, GPS, 5, 45, 123, 38.4f);
+  SetSatellite(pNavData, 1, GPS, 13, 8, 7, 0.0f);
+  SetSatellite(pNavData, 2, QZ_L1CA, 193, 70, 200, 41.6f);
+  SetSatellite(pNavData, 3, GLONASS, 3, 30, 300, 25.0f);
+  SetSatellite(pNavData, 4, SBAS, 137, 40, 190, 33.0f);
+  SetSatellite(pNavData, 5, GPS, 20, 15, 45, 22.0f);
+}
+
+/**
+ * @brief Each sentence of a 3D fix.
+ */
+static void TestFix(void)
+{
+  SpNavData NavData;
+  char Buff[NMEA_OUTPUT_MAX];
+  int length;
+
+  MakeNavData(&NavData);
+
+  length = NmeaBuildRmc(Buff, sizeof(Buff), &NavData);
+  CheckSentence("RMC", Buff, length, ExpectRmc);
+  length = NmeaBuildGsa(Buff, sizeof(Buff), &NavData);
+  CheckSentence("GSA", Buff, length, ExpectGsa);
+  length = NmeaBuildGsv(Buff, sizeof(Buff), &NavData);
+  CheckSentence("GSV", Buff, length, ExpectGsv);
+  length = NmeaBuildZda(Buff, sizeof(Buff), &NavData);
+  CheckSentence("ZDA", Buff, length, ExpectZda);
+}
+
+/**
+ * @brief RMC and GSA without a position.
+ */
+static void TestNoFix(void)
+{
+  SpNavData NavData;
+  char Buff[NMEA_OUTPUT_MAX];
+  int length;
+
+  MakeNavData(&NavData);
+  NavData.type = 0;
+  NavData.posFixMode = FixInvalid;
+  NavData.posDataExist = 0;
+
+  length = NmeaBuildRmc(Buff, sizeof(Buff), &NavData);
+  CheckSentence("RMC no fix", Buff, length, ExpectRmcNoFix);
+  length = NmeaBuildGsa(Buff, sizeof(Buff), &NavData);
+  CheckSentence("GSA no fix", Buff, length, ExpectGsaNoFix);
+}
+
+/**
+ * @brief The selected sentences back to back, in the output order.
+ */
+static void TestBuild(void)
+{
+  SpNavData NavData;
+  char Buff[NMEA_OUTPUT_MAX];
+  char Expect[NMEA_OUTPUT_MAX];
+  int length;
+
+  MakeNavData(&NavData);
+  snprintf(Expect, sizeof(Expect), "%s%s%s%s", ExpectRmc, ExpectGsa, ExpectGsv, ExpectZda);
+
+  length = NmeaBuild(Buff, sizeof(Buff), &NavData, NMEA_ZDA | NMEA_GSV | NMEA_GSA | NMEA_RMC);
+  CheckSentence("RMC+GSA+GSV+ZDA", Buff, length, Expect);
+}
+
+/**
+ * @brief A buffer too short gives an empty string, never a partial sentence.
+ */
+static void TestShortBuffer(void)
+{
+  SpNavData NavData;
+  char Buff[TEST_SMALL_SIZE];
+
+  MakeNavData(&NavData);
+
+  Check((NmeaBuildRmc(Buff, sizeof(Buff), &NavData) == 0) && (Buff[0] == '\0'), "short", "RMC");
+  Check((NmeaBuildGsa(Buff, sizeof(Buff), &NavData) == 0) && (Buff[0] == '\0'), "short", "GSA");
+  Check((NmeaBuildGsv(Buff, sizeof(Buff), &NavData) == 0) && (Buff[0] == '\0'), "short", "GSV");
+  Check((NmeaBuildZda(Buff, sizeof(Buff), &NavData) == 0) && (Buff[0] == '\0'), "short", "ZDA");
+}
+
+int main(void)
+{
+  TestFix();
+  TestNoFix();
+  TestBuild();
+  TestShortBuffer();
+
+  return CheckResult();
+}
@@ -0,0 +1,358 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file offload_test.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host test of the sensor encoder with the pool of blocks full.
+ * @details Host side test. Samples are pushed while nobody takes the
+ *          encoded blocks, so the encoder waits for a free block. Closing
+ *          the file must still finish by taking blocks while waiting, and
+ *          the blocks must hold every sample the ring accepted, in order,
+ *          with the size and CRC-32 the encoder reports and records at the
+ *          end of the file. The encoder runs on the SubCore stand-in of
+ *          test/stubs/MP.h, or in its thread with "thread". Build:
+ *          g++ -O2 -Itest/stubs -Imain -DSD_MOUNT_DIR='"/tmp/offload_test/"' -o offload_test test/offload_test.cpp
+ *              main/sensor_offload.cpp main/sensor_ring.cpp main/sensor_binary.cpp
+ *              main/sensor_codec.cpp main/sensor_format.cpp -lpthread
+ *          Usage: offload_test [thread]
+ */
+
+#include <Arduino.h>
+#include <MP.h>
+#include "sensor_offload.h"
+#include "test_check.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define TEST_SAMPLES           1500           /**< Samples per file, more than the pool and the ring hold */
+#define TEST_FILE_MAX          (TEST_SAMPLES * SENSOR_RECORD_MAX + 4096) /**< Encoded bytes per file */
+#define TEST_CLOSE_MAX_US      5000000        /**< [us] Longest close accepted */
+#define TEST_START_SEC         1700000000UL   /**< Time of the first sample */
+#define TEST_BIN_SAMPLES       100            /**< Samples of the binary file */
+#define TEST_DEVICE            0x0001         /**< Device number of the samples */
+
+/**
+ * @struct TestFile
+ * @brief Blocks of one file
+ */
+typedef struct
+{
+  char          buff[TEST_FILE_MAX];  /**< Blocks back to back */
+  unsigned long length;               /**< Bytes used in buff */
+} TestFile;
+
+static TestFile Files[3];         /**< Files by SensorOffloadStart number */
+
+/**
+ * @brief Reference CRC-32 (IEEE 802.3), bit by bit.
+ * 
+ * @param [in] pBuff Bytes
+ * @param [in] length Length of pBuff
+ * @return CRC-32
+ */
+static uint32_t Crc32(const char *pBuff, unsigned long length)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  unsigned long cnt;
+  int bit;
+
+  for (cnt = 0; cnt < length; cnt++)
+  {
+    crc ^= (uint8_t)pBuff[cnt];
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+  }
+
+  return ~crc;
+}
+
+/**
+ * @brief Take the encoded blocks as WriteOffload does.
+ * 
+ * @param [in] wait true to wait until every command has run
+ * @return [us] Time taken
+ */
+static unsigned long Drain(bool wait)
+{
+  const SensorOffloadBlock *pBlock;
+  TestFile *pFile;
+  unsigned long start = micros();
+  boolean done;
+
+  do
+  {
+    done = (wait == false) || (SensorOffloadDone() == true);
+    while ((pBlock = SensorOffloadGet()) != NULL)
+    {
+      pFile = &Files[pBlock->file % 3];
+      if (pFile->length + pBlock->length <= sizeof(pFile->buff))
+      {
+        memcpy(&pFile->buff[pFile->length], pBlock->out, pBlock->length);
+        pFile->length += pBlock->length;
+      }
+      else
+      {
+        /* do nothing. */
+      }
+      SensorOffloadRelease();
+    }
+    if (done == false)
+    {
+      usleep(1000);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  } while ((done == false) && ((micros() - start) < TEST_CLOSE_MAX_US));
+
+  return micros() - start;
+}
+
+/**
+ * @brief Push samples without taking blocks, so the pool and the ring fill up.
+ * 
+ * @param [in] first Sequence number of the first sample
+ * @param [in] num Number of samples
+ */
+static void PushSamples(unsigned long first, int num)
+{
+  SensorRecord Record;
+  int cnt;
+
+  memset(&Record, 0, sizeof(Record));
+  Record.device = TEST_DEVICE;
+  Record.interval_us = 20000;
+  Record.sens = 4096;
+  Record.press = 1013 * 2048;
+  for (cnt = 0; cnt < num; cnt++)
+  {
+    Record.seq = first + cnt;
+    Record.sec = TEST_START_SEC + Record.seq / 50;
+    Record.msec = (Record.seq % 50) * 20;
+    Record.acc[0] = (signed short)cnt;
+    SensorOffloadPut(&Record);
+    if ((cnt % 32) == 0)
+    {
+      /* Let the encoder run, as the loop does while it sleeps. */
+      usleep(500);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+}
+
+/**
+ * @brief Check the close line at the end of a CSV file and remove it.
+ * 
+ * @param [in] pName Test name
+ * @param [in,out] pFile File
+ */
+static void CheckCloseLine(const char *pName, TestFile *pFile)
+{
+  char Expect[SENSOR_CLOSE_MAX];
+  SensorBinClose Close;
+  unsigned long start;
+  int length;
+
+  if ((pFile->length < 2) || (pFile->buff[pFile->length - 1] != '\n'))
+  {
+    Check(false, pName, "close line");
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  for (start = pFile->length - 1; (start > 0) && (pFile->buff[start - 1] != '\n'); start--)
+  {
+    /* Back to the start of the last line. */
+  }
+  Close.bytes = start;
+  Close.crc = Crc32(pFile->buff, start);
+  length = SensorBinFormatClose(Expect, sizeof(Expect), TEST_DEVICE, &Close);
+  Check((pFile->length - start == (unsigned long)length) && (memcmp(&pFile->buff[start], Expect, length) == 0),
+        pName, "close line with the size and CRC-32 before it");
+  pFile->length = start;
+}
+
+/**
+ * @brief Check the CSV lines of a file.
+ * 
+ * @param [in] pName Test name
+ * @param [in] pFile File
+ * @param [in] first Sequence number of the first sample pushed
+ * @param [in] accepted Samples the ring accepted
+ */
+static void CheckLines(const char *pName, TestFile *pFile, unsigned long first, unsigned long accepted)
+{
+  char *pLine = pFile->buff;
+  char *pEnd = pFile->buff + pFile->length;
+  char *pNext;
+  char *pSeq;
+  unsigned long lines = 0;
+  unsigned long seq;
+  unsigned long last = 0;
+  bool ordered = true;
+  bool in_range = true;
+  int field;
+
+  while (pLine < pEnd)
+  {
+    pNext = (char*)memchr(pLine, '\n', pEnd - pLine);
+    if (pNext == NULL)
+    {
+      break;
+    }
+    else
+    {
+      *pNext = '\0';
+    }
+
+    /* $V00300,0xDDDD,YYYY/MM/DD hh:mm:ss.sss,seq,... */
+    pSeq = pLine;
+    for (field = 0; (field < 3) && (pSeq != NULL); field++)
+    {
+      pSeq = strchr(pSeq, ',');
+      pSeq = (pSeq != NULL) ? pSeq + 1 : NULL;
+    }
+    seq = (pSeq != NULL) ? strtoul(pSeq, NULL, 10) : 0;
+    ordered = ordered && ((lines == 0) || (seq > last));
+    in_range = in_range && (pSeq != NULL) && (seq >= first) && (seq < first + TEST_SAMPLES);
+    last = seq;
+    lines++;
+    *pNext = '\n';
+    pLine = pNext + 1;
+  }
+
+  Check(pLine == pEnd, pName, "whole lines");
+  Check(ordered && in_range, pName, "samples in order");
+  Check(lines == accepted, pName, "every accepted sample encoded");
+}
+
+/**
+ * @brief Check the close record at the end of a binary file.
+ * 
+ * @param [in] pName Test name
+ * @param [in] pFile File
+ */
+static void CheckCloseRecord(const char *pName, const TestFile *pFile)
+{
+  const uint8_t *pRecord = (const uint8_t*)&pFile->buff[pFile->length - SENSOR_BIN_CLOSE_SIZE];
+  SensorBinClose Close;
+  uint8_t type;
+  uint8_t num;
+
+  if (pFile->length < SENSOR_BIN_CLOSE_SIZE)
+  {
+    Check(false, pName, "close record");
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  Check((SensorBinReadTag(pRecord, &type, &num) == SENSOR_BIN_CLOSE_SIZE) && (type == eBinClose),
+        pName, "close record last");
+  SensorBinReadClose(pRecord, &Close);
+  Check((Close.bytes == pFile->length - SENSOR_BIN_CLOSE_SIZE) &&
+        (Close.crc == Crc32(pFile->buff, pFile->length - SENSOR_BIN_CLOSE_SIZE)),
+        pName, "close record with the size and CRC-32 before it");
+}
+
+int main(int argc, char *argv[])
+{
+  SensorOffloadStat Stat;
+  SensorRingStat Ring;
+  unsigned long dropped = 0;
+  unsigned long accepted[2];
+  unsigned long elapsed;
+  uint32_t file;
+  bool thread = (argc >= 2) && (strcmp(argv[1], "thread") == 0);
+
+  memset(Files, 0, sizeof(Files));
+  MpStub().pSubCore = SensorOffloadSubCore;
+  MpStub().fail = thread;
+  Check(SensorOffloadBegin() == true, "begin", "encoder started");
+  Check(SensorOffloadCore() == (thread ? 0 : SENSOR_OFFLOAD_CORE), "begin", "encoder core");
+
+  /* First file, nobody takes blocks until it is closed. */
+  file = SensorOffloadStart(eFormatCsv);
+  Check(file == 1, "start", "first file number");
+  PushSamples(0, TEST_SAMPLES);
+  SensorRingGetStat(&Ring);
+  accepted[0] = TEST_SAMPLES - (Ring.dropped - dropped);
+  dropped = Ring.dropped;
+  Check(accepted[0] < TEST_SAMPLES, "pool full", "ring overflowed while the pool was full");
+
+  /* Next file queued behind the first one, then close both. */
+  SensorOffloadClose(TEST_DEVICE);
+  file = SensorOffloadStart(eFormatCsv);
+  Check(file == 2, "start", "second file number");
+  Drain(false);
+  PushSamples(TEST_SAMPLES, TEST_SAMPLES);
+  SensorOffloadClose(TEST_DEVICE);
+  elapsed = Drain(true);
+  SensorRingGetStat(&Ring);
+  SensorOffloadGetStat(&Stat);
+  accepted[1] = TEST_SAMPLES - (Ring.dropped - dropped);
+  dropped = Ring.dropped;
+
+  printf("pool full (%s): accepted %lu and %lu of %d, blocks %lu, wakeups %lu, pending max %lu/%d, close %lu us\n",
+         thread ? "thread" : "SubCore", accepted[0], accepted[1], TEST_SAMPLES, Stat.blocks, Stat.wakeups,
+         Stat.pending_max, SENSOR_OFFLOAD_BLOCKS, elapsed);
+
+  Check(SensorOffloadDone() == true, "close", "every command ran");
+  Check(elapsed < TEST_CLOSE_MAX_US, "close", "finished while the pool was full");
+  Check(Stat.pending_max == SENSOR_OFFLOAD_BLOCKS, "close", "pool was full");
+  Check(thread || ((Stat.wakeups != 0) && (Stat.wakeups == MpStub().sent - 1)), "close", "SubCore woken up by the mailbox");
+  Check((Stat.last_bytes == Files[1].length) && (Stat.last_crc == Crc32(Files[1].buff, Files[1].length)),
+        "file 1", "size and CRC-32");
+  Check((Stat.bytes == Files[2].length) && (Stat.crc == Crc32(Files[2].buff, Files[2].length)),
+        "file 2", "size and CRC-32");
+  CheckCloseLine("file 1", &Files[1]);
+  CheckCloseLine("file 2", &Files[2]);
+  CheckLines("file 1", &Files[1], 0, accepted[0]);
+  CheckLines("file 2", &Files[2], TEST_SAMPLES, accepted[1]);
+
+  /* Binary file, taken as it is encoded. */
+  file = SensorOffloadStart(eFormatBinary);
+  Check(file == 3, "start", "binary file number");
+  PushSamples(2 * TEST_SAMPLES, TEST_BIN_SAMPLES);
+  SensorOffloadClose(TEST_DEVICE);
+  Drain(true);
+  SensorRingGetStat(&Ring);
+  Check(Ring.dropped == dropped, "binary", "every sample accepted");
+  CheckCloseRecord("binary", &Files[3 % 3]);
+
+  return CheckResult();
+}
@@ -0,0 +1,243 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file ring_stress_test.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stress test of the sensor ring with a producer and a consumer thread.
+ * @details Host side test. A producer thread pushes numbered samples in
+ *          bursts faster than the consumer pops them, and the consumer
+ *          pauses now and then, so the ring runs full while both sides
+ *          are busy. For both policies every popped
+ *          sample must be whole, seq must rise, and the samples missing
+ *          from seq must be exactly the ones the ring counted as dropped.
+ *          Build:
+ *          g++ -O2 -Itest/stubs -Imain -DSD_MOUNT_DIR='"/tmp/ring_stress_test/"' -o ring_stress_test
+ *              test/ring_stress_test.cpp main/sensor_ring.cpp -lpthread
+ *          Usage: ring_stress_test [samples]
+ */
+
+#include <Arduino.h>
+#include <pthread.h>
+#include "sensor_ring.h"
+#include "test_check.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define TEST_SAMPLES           2000000        /**< Samples pushed per policy */
+#define TEST_BURST             1024           /**< Samples pushed at full speed between producer pauses */
+#define TEST_PAUSE_EVERY       4096           /**< Samples popped between consumer pauses */
+#define TEST_PAUSE_US          100            /**< [us] Pause of either side */
+
+static unsigned long Samples = TEST_SAMPLES;  /**< Samples pushed per policy */
+static volatile bool ProducerDone = false;    /**< Set after the last push */
+static unsigned long Refused = 0;             /**< Pushes that returned false */
+
+/**
+ * @brief Fill a sample so every field depends on seq.
+ * 
+ * @param [out] pRecord Sample
+ * @param [in] seq Sequence number
+ */
+static void MakeSample(SensorRecord *pRecord, unsigned long seq)
+{
+  pRecord->seq = seq;
+  pRecord->sec = seq / 50;
+  pRecord->msec = (unsigned short)((seq % 50) * 20);
+  pRecord->device = (unsigned short)(seq >> 3);
+  pRecord->interval_us = ~seq;
+  pRecord->acc[0] = (signed short)seq;
+  pRecord->acc[1] = (signed short)(seq >> 16);
+  pRecord->acc[2] = (signed short)(seq * 3);
+  pRecord->sens = (unsigned short)(seq * 5);
+  pRecord->press = seq * 7;
+}
+
+/**
+ * @brief Check that a popped sample was not torn by a concurrent write.
+ * 
+ * @param [in] pRecord Sample
+ * @return true if every field matches its seq
+ */
+static bool WholeSample(const SensorRecord *pRecord)
+{
+  SensorRecord Expect;
+
+  memset(&Expect, 0, sizeof(Expect));
+  MakeSample(&Expect, pRecord->seq);
+  return (pRecord->sec == Expect.sec) && (pRecord->msec == Expect.msec) &&
+         (pRecord->device == Expect.device) && (pRecord->interval_us == Expect.interval_us) &&
+         (memcmp(pRecord->acc, Expect.acc, sizeof(Expect.acc)) == 0) &&
+         (pRecord->sens == Expect.sens) && (pRecord->press == Expect.press);
+}
+
+/**
+ * @brief Push every sample, as the sampling loop does.
+ * 
+ * @param [in] arg Not used
+ * @return NULL
+ */
+static void *Producer(void *arg)
+{
+  SensorRecord Record;
+  unsigned long seq;
+
+  memset(&Record, 0, sizeof(Record));
+  for (seq = 0; seq < Samples; seq++)
+  {
+    MakeSample(&Record, seq);
+    if (SensorRingPush(&Record) == false)
+    {
+      Refused++;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    if ((seq % TEST_BURST) == (TEST_BURST - 1))
+    {
+      /* Let the consumer catch up, as between sensor reads. */
+      usleep(TEST_PAUSE_US);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  __sync_synchronize();
+  ProducerDone = true;
+
+  return NULL;
+}
+
+/**
+ * @brief Run the producer against the consumer with one policy.
+ * 
+ * @param [in] pName Test name
+ * @param [in] policy SensorRingPolicy
+ */
+static void Run(const char *pName, uint8_t policy)
+{
+  SensorRecord Record;
+  SensorRingStat Stat;
+  pthread_t thread;
+  unsigned long popped = 0;
+  unsigned long missing = 0;
+  unsigned long next = 0;
+  unsigned long torn = 0;
+  bool ordered = true;
+  bool empty;
+
+  SensorRingBegin(policy);
+  ProducerDone = false;
+  Refused = 0;
+  if (pthread_create(&thread, NULL, Producer, NULL) != 0)
+  {
+    Check(false, pName, "producer thread");
+    return;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  while (1)
+  {
+    /* Read the flag first, samples pushed before it are popped below. */
+    empty = ProducerDone;
+    __sync_synchronize();
+    if (SensorRingPop(&Record) == true)
+    {
+      torn += (WholeSample(&Record) == true) ? 0 : 1;
+      if (Record.seq < next)
+      {
+        ordered = false;
+      }
+      else
+      {
+        /* Every seq skipped here must be a counted drop. */
+        missing += Record.seq - next;
+        next = Record.seq + 1;
+      }
+      popped++;
+      if ((popped % TEST_PAUSE_EVERY) == 0)
+      {
+        /* The encoder falls behind, the ring runs full. */
+        usleep(TEST_PAUSE_US);
+      }
+      else
+      {
+        /* do nothing. */
+      }
+    }
+    else if (empty == true)
+    {
+      break;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  pthread_join(thread, NULL);
+  missing += Samples - next;
+
+  SensorRingGetStat(&Stat);
+  printf("%s: popped %lu of %lu, dropped %lu, missing from seq %lu, high water %lu/%d\n",
+         pName, popped, Samples, Stat.dropped, missing, Stat.high_water, SENSOR_RING_SIZE);
+
+  Check(torn == 0, pName, "every sample whole");
+  Check(ordered == true, pName, "seq rises");
+  Check(Stat.pushed == Samples, pName, "every push counted");
+  Check(Stat.dropped != 0, pName, "ring ran full");
+  Check(missing == Stat.dropped, pName, "gaps only at counted drops");
+  Check(popped + Stat.dropped == Samples, pName, "every sample popped or dropped");
+  Check(Stat.high_water == SENSOR_RING_SIZE, pName, "high water at the ring size");
+  if (policy == eRingDropNewest)
+  {
+    Check(Refused == Stat.dropped, pName, "dropped samples refused by the push");
+  }
+  else
+  {
+    Check(Refused == 0, pName, "every push accepted");
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc >= 2)
+  {
+    Samples = strtoul(argv[1], NULL, 10);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  Run("drop newest", eRingDropNewest);
+  Run("drop oldest", eRingDropOldest);
+
+  return CheckResult();
+}
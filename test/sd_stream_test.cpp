@@ -0,0 +1,359 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sd_stream_test.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the SD writer thread with injected write stalls.
+ * @details Host side test. A producer appends fixed size records at a fixed
+ *          rate while every n-th File::write of the stub stalls. The
+ *          producer must never wait for the card, dropped records must be
+ *          counted, and the file must hold whole records in order. The
+ *          rotation run switches files every few records in the writer
+ *          thread and checks each file and the index note. Build:
+ *          g++ -O2 -Itest/stubs -Imain -DSD_MOUNT_DIR='"/tmp/sd_stream_test/"'
+ *              -o sd_stream_test test/sd_stream_test.cpp main/SDHC_file.cpp -lpthread
+ *          Usage: sd_stream_test
+ */
+
+#include <Arduino.h>
+#include <SDHCI.h>
+#include "SDHC_file.h"
+#include "test_check.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define TEST_FILE_NAME         "STALL.CSV"    /**< File under SD_MOUNT_DIR */
+#define TEST_RECORD_SIZE       64             /**< Bytes per record, sector size is not a multiple */
+#define TEST_RECORDS           6000           /**< Records per run */
+#define TEST_PERIOD_US         250            /**< [us] Producer period, 256 KB/s */
+#define TEST_WRITE_MAX_US      20000          /**< [us] Longest SdStreamWrite accepted, far below the long stall */
+#define TEST_ROTATE_RECORDS    1000           /**< Records per file of the rotation run */
+#define TEST_ROTATE_FILES      (TEST_RECORDS / TEST_ROTATE_RECORDS) /**< Files of the rotation run */
+#define TEST_NOTE_NAME         "INDEX.INI"    /**< Note rewritten at each switch */
+
+extern SDClass theSD;
+
+/**
+ * @brief Write records at a fixed rate and check the file.
+ * 
+ * @param [in] pName Test name
+ * @param [in] stall_every Every n-th write stalls, 0 for none
+ * @param [in] stall_us [us] Stall
+ * @param [in] fail_every Every n-th write fails, 0 for none
+ * @param [in] reserve Bytes to preallocate
+ */
+static void RunStream(const char *pName, unsigned long stall_every, unsigned long stall_us,
+                      unsigned long fail_every, unsigned long reserve)
+{
+  static SdStream Stream;
+  static bool Accepted[TEST_RECORDS];
+  char Record[TEST_RECORD_SIZE + 1];
+  char Line[TEST_RECORD_SIZE + 1];
+  unsigned long long next_us;
+  unsigned long start;
+  unsigned long elapsed;
+  unsigned long write_max_us = 0;
+  unsigned long accepted = 0;
+  unsigned long refused = 0;
+  unsigned long found = 0;
+  unsigned long seq;
+  unsigned long last = 0;
+  bool whole = true;
+  bool ordered = true;
+  bool only_accepted = true;
+  char path[SD_PATH_LEN];
+  struct stat st;
+  FILE *pFile;
+  int cnt;
+
+  snprintf(path, sizeof(path), SD_MOUNT_DIR "%s", TEST_FILE_NAME);
+  unlink(path);
+  SdStub().stall_every = stall_every;
+  SdStub().stall_us = stall_us;
+  SdStub().fail_every = fail_every;
+  SdStub().writes = 0;
+
+  Check(SdStreamOpen(&Stream, TEST_FILE_NAME, FILE_WRITE | O_APPEND, reserve) == true, pName, "open");
+  if (reserve != 0)
+  {
+    Check((stat(path, &st) == 0) && ((unsigned long)st.st_size == reserve), pName, "extent preallocated");
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  next_us = StubNow_us();
+  for (cnt = 0; cnt < TEST_RECORDS; cnt++)
+  {
+    while (StubNow_us() < next_us)
+    {
+      /* Sample period. */
+    }
+    next_us += TEST_PERIOD_US;
+
+    snprintf(Record, sizeof(Record), "%08d,%*s\n", cnt, TEST_RECORD_SIZE - 10, "abcdefghijklmnopqrstuvwxyz");
+    start = micros();
+    Accepted[cnt] = (SdStreamWrite(&Stream, Record, TEST_RECORD_SIZE) == TEST_RECORD_SIZE);
+    elapsed = micros() - start;
+    write_max_us = max(write_max_us, elapsed);
+    if (Accepted[cnt] == true)
+    {
+      accepted++;
+    }
+    else
+    {
+      refused++;
+    }
+  }
+  start = micros();
+  SdStreamClose(&Stream);
+  elapsed = micros() - start;
+
+  /* Whole records in order, only those the stream accepted. */
+  pFile = fopen(path, "r");
+  Check(pFile != NULL, pName, "file exists");
+  while ((pFile != NULL) && (fgets(Line, sizeof(Line), pFile) != NULL))
+  {
+    if ((strlen(Line) != TEST_RECORD_SIZE) || (Line[8] != ',') || (Line[TEST_RECORD_SIZE - 1] != '\n'))
+    {
+      whole = false;
+      break;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    seq = strtoul(Line, NULL, 10);
+    ordered = ordered && ((found == 0) || (seq > last));
+    only_accepted = only_accepted && (seq < TEST_RECORDS) && (Accepted[seq] == true);
+    last = seq;
+    found++;
+  }
+  if (pFile != NULL)
+  {
+    fclose(pFile);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+
+  printf("%s: accepted %lu, dropped %lu, writes %lu, errors %lu, queued max %lu, stall max %lu us, "
+         "write max %lu us, close %lu us\n",
+         pName, accepted, Stream.stat.dropped, Stream.stat.writes, Stream.stat.errors,
+         Stream.stat.pending_max, Stream.stat.stall_max_us, write_max_us, elapsed);
+
+  Check(write_max_us < TEST_WRITE_MAX_US, pName, "producer never waits for the card");
+  Check(Stream.stat.dropped == refused, pName, "every refused record is counted");
+  Check(Stream.stat.pending_max <= SD_WRITE_BUFFER_NUM, pName, "queue bounded");
+  Check(whole && ordered && only_accepted, pName, "whole records in order");
+  if (fail_every == 0)
+  {
+    Check(found == accepted, pName, "every accepted record written");
+    Check(Stream.stat.errors == 0, pName, "no write errors");
+    Check((stat(path, &st) == 0) && ((unsigned long)st.st_size == accepted * TEST_RECORD_SIZE), pName,
+          "file trimmed to the records");
+  }
+  else
+  {
+    Check(Stream.stat.errors != 0, pName, "failed writes counted");
+    Check(found < accepted, pName, "failed writes lost");
+  }
+  if (stall_every != 0)
+  {
+    Check(Stream.stat.stall_max_us >= stall_us, pName, "stall seen by the writer");
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Write records at a fixed rate, switching files every TEST_ROTATE_RECORDS.
+ * 
+ * @param [in] pName Test name
+ * @param [in] stall_every Every n-th write stalls, 0 for none
+ * @param [in] stall_us [us] Stall
+ * @param [in] reserve Bytes to preallocate per file
+ */
+static void RunRotate(const char *pName, unsigned long stall_every, unsigned long stall_us, unsigned long reserve)
+{
+  static SdStream Stream;
+  static bool Accepted[TEST_RECORDS];
+  char Record[TEST_RECORD_SIZE + 1];
+  char Line[TEST_RECORD_SIZE + 1];
+  char Name[SD_PATH_LEN];
+  char Note[SD_NOTE_SIZE];
+  char path[SD_PATH_LEN];
+  unsigned long long next_us;
+  unsigned long start;
+  unsigned long elapsed;
+  unsigned long write_max_us = 0;
+  unsigned long refused = 0;
+  unsigned long found;
+  unsigned long expected;
+  unsigned long seq;
+  unsigned long last;
+  bool in_file = true;
+  bool ordered = true;
+  bool complete = true;
+  struct stat st;
+  FILE *pFile;
+  int cnt;
+  int file;
+
+  for (file = 0; file < TEST_ROTATE_FILES; file++)
+  {
+    snprintf(path, sizeof(path), SD_MOUNT_DIR "ROT%d.CSV", file);
+    unlink(path);
+  }
+  SdStub().stall_every = stall_every;
+  SdStub().stall_us = stall_us;
+  SdStub().fail_every = 0;
+  SdStub().writes = 0;
+
+  Check(SdStreamOpen(&Stream, "ROT0.CSV", FILE_WRITE | O_APPEND, reserve) == true, pName, "open");
+  next_us = StubNow_us();
+  for (cnt = 0; cnt < TEST_RECORDS; cnt++)
+  {
+    while (StubNow_us() < next_us)
+    {
+      /* Sample period. */
+    }
+    next_us += TEST_PERIOD_US;
+
+    start = micros();
+    if ((cnt != 0) && ((cnt % TEST_ROTATE_RECORDS) == 0))
+    {
+      snprintf(Name, sizeof(Name), "ROT%d.CSV", cnt / TEST_ROTATE_RECORDS);
+      snprintf(Note, sizeof(Note), "%08d", cnt / TEST_ROTATE_RECORDS);
+      Check(SdStreamRotate(&Stream, Name, FILE_WRITE | O_APPEND, reserve, TEST_NOTE_NAME, Note) == true,
+            pName, "rotate");
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    snprintf(Record, sizeof(Record), "%08d,%*s\n", cnt, TEST_RECORD_SIZE - 10, "abcdefghijklmnopqrstuvwxyz");
+    Accepted[cnt] = (SdStreamWrite(&Stream, Record, TEST_RECORD_SIZE) == TEST_RECORD_SIZE);
+    elapsed = micros() - start;
+    write_max_us = max(write_max_us, elapsed);
+    if (Accepted[cnt] != true)
+    {
+      refused++;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+  }
+  SdStreamClose(&Stream);
+
+  /* Each file holds the accepted records of its interval, in order, trimmed. */
+  for (file = 0; file < TEST_ROTATE_FILES; file++)
+  {
+    snprintf(path, sizeof(path), SD_MOUNT_DIR "ROT%d.CSV", file);
+    pFile = fopen(path, "r");
+    Check(pFile != NULL, pName, "file exists");
+    found = 0;
+    last = 0;
+    expected = 0;
+    for (cnt = file * TEST_ROTATE_RECORDS; cnt < (file + 1) * TEST_ROTATE_RECORDS; cnt++)
+    {
+      expected += (Accepted[cnt] == true) ? 1 : 0;
+    }
+    while ((pFile != NULL) && (fgets(Line, sizeof(Line), pFile) != NULL))
+    {
+      seq = strtoul(Line, NULL, 10);
+      in_file = in_file && (seq / TEST_ROTATE_RECORDS == (unsigned long)file) && (Accepted[seq] == true);
+      ordered = ordered && ((found == 0) || (seq > last));
+      last = seq;
+      found++;
+    }
+    if (pFile != NULL)
+    {
+      fclose(pFile);
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    complete = complete && (found == expected) &&
+               (stat(path, &st) == 0) && ((unsigned long)st.st_size == expected * TEST_RECORD_SIZE);
+  }
+
+  snprintf(path, sizeof(path), SD_MOUNT_DIR "%s", TEST_NOTE_NAME);
+  pFile = fopen(path, "r");
+  Line[0] = 0;
+  if (pFile != NULL)
+  {
+    if (fgets(Line, sizeof(Line), pFile) == NULL)
+    {
+      Line[0] = 0;
+    }
+    else
+    {
+      /* do nothing. */
+    }
+    fclose(pFile);
+  }
+  else
+  {
+    /* do nothing. */
+  }
+  snprintf(Note, sizeof(Note), "%08d", TEST_ROTATE_FILES - 1);
+
+  printf("%s: files %d, dropped %lu, writes %lu, errors %lu, queued max %lu, stall max %lu us, write max %lu us\n",
+         pName, TEST_ROTATE_FILES, Stream.stat.dropped, Stream.stat.writes, Stream.stat.errors,
+         Stream.stat.pending_max, Stream.stat.stall_max_us, write_max_us);
+
+  Check(write_max_us < TEST_WRITE_MAX_US, pName, "producer never waits for a switch");
+  Check(Stream.stat.dropped == refused, pName, "every refused record is counted");
+  Check(Stream.stat.errors == 0, pName, "no write errors");
+  Check(in_file && ordered, pName, "records in the file of their interval, in order");
+  Check(complete, pName, "every accepted record written, files trimmed");
+  Check(strcmp(Line, Note) == 0, pName, "note holds the last file number");
+}
+
+int main(void)
+{
+  theSD.begin();
+
+  /* Every write fast. */
+  RunStream("steady", 0, 0, 0, 0);
+  /* Short stalls the buffers absorb: 4 ms at 256 KB/s is 1 KB. */
+  RunStream("short stall", 4, 4000, 0, 1000000);
+  /* Stalls longer than the buffers hold: 120 ms is 30 KB, 16 KB are buffered. */
+  RunStream("long stall", 16, 120000, 0, 1000000);
+  /* Failing writes are counted and do not stop the writer. */
+  RunStream("write error", 0, 0, 5, 0);
+  /* Files switched by the writer under short stalls. */
+  RunRotate("rotate", 4, 4000, 1000000);
+
+  return CheckResult();
+}
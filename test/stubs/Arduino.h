@@ -0,0 +1,91 @@
+/**
+ * @file Arduino.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Arduino core for the tests in test/.
+ * @details Only what the sketch sources use. Time comes from CLOCK_MONOTONIC,
+ *          Serial output goes to stdout.
+ */
+
+#ifndef _TEST_STUB_ARDUINO_H_
+#define _TEST_STUB_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::min;
+using std::max;
+
+#define HEX                    16
+#define DEC                    10
+#define RISING                 3
+#define INPUT                  0
+#define OUTPUT                 1
+#define PIN_LED0               0
+#define PIN_LED1               1
+#define PIN_LED2               2
+#define PIN_LED3               3
+#define PIN_D02                4
+
+/**
+ * @brief Serial port writing to stdout.
+ */
+class HardwareSerial
+{
+public:
+  void begin(long) {}
+  operator bool() { return true; }
+  size_t print(const char *pText) { return fputs(pText, stdout) >= 0 ? strlen(pText) : 0; }
+  size_t print(long value) { return printf("%ld", value); }
+  size_t print(unsigned long value, int base = DEC) { return printf((base == HEX) ? "%lX" : "%lu", value); }
+  size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+  size_t println(const char *pText) { return print(pText) + println(); }
+  size_t println(unsigned long value, int base = DEC) { return print(value, base) + println(); }
+  size_t println() { return fputs("\n", stdout) >= 0 ? 1 : 0; }
+  size_t write(const char *pBuff, size_t n) { return fwrite(pBuff, 1, n, stdout); }
+  size_t write(const uint8_t *pBuff, size_t n) { return fwrite(pBuff, 1, n, stdout); }
+  size_t write(uint8_t c) { return fputc(c, stdout) != EOF; }
+  int available() { return 0; }
+  int availableForWrite() { return 4096; }
+  int read() { return -1; }
+  void flush() { fflush(stdout); }
+};
+
+static HardwareSerial Serial __attribute__((unused));
+static HardwareSerial Serial2 __attribute__((unused));
+
+static inline unsigned long long StubNow_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static inline unsigned long micros(void) { return (unsigned long)(uint32_t)StubNow_us(); }
+static inline unsigned long millis(void) { return (unsigned long)(uint32_t)(StubNow_us() / 1000); }
+static inline void delay(unsigned long ms) { usleep(ms * 1000); }
+static inline void delayMicroseconds(unsigned int us) { usleep(us); }
+static inline void pinMode(int, int) {}
+static inline int digitalRead(int) { return 0; }
+static inline void digitalWrite(int, int) {}
+static inline int digitalPinToInterrupt(int pin) { return pin; }
+static inline void attachInterrupt(int, void (*)(void), int) {}
+static inline void detachInterrupt(int) {}
+static inline void attachTimerInterrupt(unsigned int (*)(void), unsigned int) {}
+static inline void detachTimerInterrupt(void) {}
+static inline void ledOn(int) {}
+static inline void ledOff(int) {}
+static inline void interrupts(void) {}
+static inline void noInterrupts(void) {}
+
+#endif /* _TEST_STUB_ARDUINO_H_ */
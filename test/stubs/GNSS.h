@@ -0,0 +1,84 @@
+/**
+ * @file GNSS.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Spresense GNSS library for the tests in test/.
+ * @details SpNavData keeps the fields and accessors the sketch reads, so
+ *          tests can fill in fixed navigation data.
+ */
+
+#ifndef _TEST_STUB_GNSS_H_
+#define _TEST_STUB_GNSS_H_
+
+#include <Arduino.h>
+
+#define SP_GNSS_MAX_SV_NUM     32
+
+enum SpPrintLevel { PrintNone, PrintError, PrintWarning, PrintInfo };
+enum SpStartMode { COLD_START, WARM_START, HOT_START };
+enum SpSatelliteType { GPS, GLONASS, SBAS, QZ_L1CA, QZ_L1S, IMES, BEIDOU, GALILEO };
+enum SpPvtType { SpPvtTypeNone = 0, SpPvtTypeGnss = 1 };
+enum SpFixMode { FixInvalid = 1, Fix2D = 2, Fix3D = 3 };
+
+typedef struct
+{
+  unsigned short year;
+  unsigned char  month;
+  unsigned char  day;
+  unsigned char  hour;
+  unsigned char  minute;
+  unsigned char  sec;
+  unsigned int   usec;
+} SpGnssTime;
+
+typedef struct
+{
+  SpSatelliteType type;
+  unsigned short  svid;
+  unsigned char   elevation;
+  short           azimuth;
+  float           sigLevel;
+} SpSatellite;
+
+class SpNavData
+{
+public:
+  SpGnssTime     time;
+  unsigned char  type;
+  unsigned char  numSatellites;
+  unsigned char  numSatellitesCalcPos;
+  unsigned char  posFixMode;
+  unsigned char  posDataExist;
+  double         latitude;
+  double         longitude;
+  double         altitude;
+  float          velocity;
+  float          direction;
+  float          pdop;
+  float          hdop;
+  float          vdop;
+  SpSatellite    satellite[SP_GNSS_MAX_SV_NUM];
+
+  SpSatelliteType getSatelliteType(unsigned long index) { return satellite[index].type; }
+  unsigned short getSatelliteId(unsigned long index) { return satellite[index].svid; }
+  unsigned char getSatelliteElevation(unsigned long index) { return satellite[index].elevation; }
+  short getSatelliteAzimuth(unsigned long index) { return satellite[index].azimuth; }
+  float getSatelliteSignalLevel(unsigned long index) { return satellite[index].sigLevel; }
+};
+
+class SpGnss
+{
+public:
+  void setDebugMode(SpPrintLevel) {}
+  int begin() { return 0; }
+  int end() { return 0; }
+  int start(SpStartMode = HOT_START) { return 0; }
+  int stop() { return 0; }
+  int select(SpSatelliteType) { return 0; }
+  int setInterval(int) { return 0; }
+  bool waitUpdate(int = -1) { return false; }
+  void getNavData(SpNavData *) {}
+  int saveEphemeris() { return 0; }
+  int setTime(SpGnssTime *) { return 0; }
+};
+
+#endif /* _TEST_STUB_GNSS_H_ */
@@ -0,0 +1,10 @@
+/**
+ * @file GNSSPositionData.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Spresense GNSS position data for the tests in test/.
+ */
+
+#ifndef _TEST_STUB_GNSSPOSITIONDATA_H_
+#define _TEST_STUB_GNSSPOSITIONDATA_H_
+
+#endif /* _TEST_STUB_GNSSPOSITIONDATA_H_ */
@@ -0,0 +1,30 @@
+/**
+ * @file LowPower.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Spresense low power library for the tests in test/.
+ */
+
+#ifndef _TEST_STUB_LOWPOWER_H_
+#define _TEST_STUB_LOWPOWER_H_
+
+#include <Arduino.h>
+
+typedef enum
+{
+  CLOCK_MODE_156MHz,
+  CLOCK_MODE_32MHz,
+  CLOCK_MODE_8MHz,
+} clockmode_e;
+
+class LowPowerClass
+{
+public:
+  void begin() {}
+  void end() {}
+  void clockMode(clockmode_e) {}
+  clockmode_e getClockMode() { return CLOCK_MODE_156MHz; }
+};
+
+static LowPowerClass LowPower __attribute__((unused));
+
+#endif /* _TEST_STUB_LOWPOWER_H_ */
@@ -0,0 +1,149 @@
+/**
+ * @file MP.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Spresense multi core library for the tests in test/.
+ * @details The SubCore is a thread that runs MpStub().pSubCore, the
+ *          mailbox to it is a queue. Addresses are the same on both sides.
+ *          MpStub().fail makes MP.begin fail as if no SubCore image was
+ *          uploaded.
+ */
+
+#ifndef _TEST_STUB_MP_H_
+#define _TEST_STUB_MP_H_
+
+#include <Arduino.h>
+#include <pthread.h>
+#include <deque>
+
+#define MP_RECV_BLOCKING       0
+
+/**
+ * @brief SubCore of the stand-in
+ */
+typedef struct
+{
+  void          (*pSubCore)(void);    /**< setup() of the SubCore image */
+  volatile bool fail;                 /**< MP.begin(subid) fails */
+  volatile unsigned long sent;        /**< Messages sent to the SubCore */
+} MpStubConfig;
+
+inline MpStubConfig &MpStub(void)
+{
+  static MpStubConfig Config;
+
+  return Config;
+}
+
+/**
+ * @brief Mailbox from the main core to one SubCore.
+ */
+class MPClass
+{
+public:
+  MPClass() : booted(false)
+  {
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&cond, NULL);
+  }
+
+  /* Main core: boot the SubCore and wait until it calls begin(). */
+  int begin(int subid)
+  {
+    pthread_t thread;
+
+    if ((MpStub().fail == true) || (MpStub().pSubCore == NULL) ||
+        (pthread_create(&thread, NULL, Run, NULL) != 0))
+    {
+      return -1;
+    }
+    pthread_detach(thread);
+    pthread_mutex_lock(&lock);
+    while (booted == false)
+    {
+      pthread_cond_wait(&cond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+    return 0;
+  }
+
+  /* SubCore: report the boot to the main core. */
+  int begin(void)
+  {
+    pthread_mutex_lock(&lock);
+    booted = true;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    return 0;
+  }
+
+  void RecvTimeout(uint32_t) {}
+  uintptr_t Virt2Phys(void *pVirt) { return (uintptr_t)pVirt; }
+  int Send(int8_t msgid, uint32_t msgdata, int subid = 0) { return Put(msgid, (uintptr_t)msgdata); }
+  int Send(int8_t msgid, void *msgaddr, int subid = 0) { return Put(msgid, (uintptr_t)msgaddr); }
+
+  int Recv(int8_t *msgid, uint32_t *msgdata, int subid = 0)
+  {
+    uintptr_t data = Get(msgid);
+
+    *msgdata = (uint32_t)data;
+    return *msgid;
+  }
+
+  int Recv(int8_t *msgid, void *msgaddr, int subid = 0)
+  {
+    uintptr_t data = Get(msgid);
+
+    *(void**)msgaddr = (void*)data;
+    return *msgid;
+  }
+
+private:
+  typedef struct
+  {
+    int8_t    msgid;
+    uintptr_t data;
+  } Message;
+
+  pthread_mutex_t     lock;
+  pthread_cond_t      cond;
+  std::deque<Message> mailbox;
+  bool                booted;
+
+  static void *Run(void *arg)
+  {
+    MpStub().pSubCore();
+    return NULL;
+  }
+
+  int Put(int8_t msgid, uintptr_t data)
+  {
+    Message message = { msgid, data };
+
+    pthread_mutex_lock(&lock);
+    mailbox.push_back(message);
+    MpStub().sent++;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&lock);
+    return 0;
+  }
+
+  uintptr_t Get(int8_t *msgid)
+  {
+    Message message;
+
+    pthread_mutex_lock(&lock);
+    while (mailbox.empty() == true)
+    {
+      pthread_cond_wait(&cond, &lock);
+    }
+    message = mailbox.front();
+    mailbox.pop_front();
+    pthread_mutex_unlock(&lock);
+    *msgid = message.msgid;
+    return message.data;
+  }
+};
+
+static MPClass MP __attribute__((unused));
+
+#endif /* _TEST_STUB_MP_H_ */
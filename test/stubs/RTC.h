@@ -0,0 +1,35 @@
+/**
+ * @file RTC.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Spresense RTC library for the tests in test/.
+ */
+
+#ifndef _TEST_STUB_RTC_H_
+#define _TEST_STUB_RTC_H_
+
+#include <Arduino.h>
+
+class RtcTime
+{
+public:
+  RtcTime(uint32_t sec = 0, long nsec = 0) : s(sec), ns(nsec) {}
+  uint32_t unixtime() const { return s; }
+  long nsec() const { return ns; }
+
+private:
+  uint32_t s;
+  long ns;
+};
+
+class RtcClass
+{
+public:
+  void begin() {}
+  void end() {}
+  RtcTime getTime() { return RtcTime(); }
+  void setTime(const RtcTime &) {}
+};
+
+static RtcClass RTC __attribute__((unused));
+
+#endif /* _TEST_STUB_RTC_H_ */
@@ -0,0 +1,99 @@
+/**
+ * @file SDHCI.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Spresense SD card library for the tests in test/.
+ * @details Files live under SD_MOUNT_DIR, which the test defines as a host
+ *          directory. SdStub() injects write stalls and failures.
+ */
+
+#ifndef _TEST_STUB_SDHCI_H_
+#define _TEST_STUB_SDHCI_H_
+
+#include <Arduino.h>
+#include <sys/stat.h>
+#include <string>
+
+#ifndef SD_MOUNT_DIR
+#error "Define SD_MOUNT_DIR as a host directory ending in '/'"
+#endif
+
+#define FILE_READ              O_RDONLY
+#define FILE_WRITE             (O_RDWR | O_CREAT)
+
+/**
+ * @brief Fault injection of File::write
+ */
+typedef struct
+{
+  volatile unsigned long stall_us;    /**< [us] Delay of a stalled write */
+  volatile unsigned long stall_every; /**< Every n-th write stalls, 0 for none */
+  volatile unsigned long fail_every;  /**< Every n-th write fails, 0 for none */
+  volatile unsigned long writes;      /**< File::write calls */
+  volatile unsigned long opens;       /**< SDClass::open calls */
+} SdStubConfig;
+
+inline SdStubConfig &SdStub(void)
+{
+  static SdStubConfig Config;
+
+  return Config;
+}
+
+/**
+ * @brief File on the host file system.
+ */
+class File
+{
+public:
+  File() : fd(-1) {}
+  explicit File(int handle) : fd(handle) {}
+  size_t write(const uint8_t *pBuff, size_t n) { return write((const char*)pBuff, n); }
+  size_t write(const char *pBuff, size_t n)
+  {
+    unsigned long count = ++SdStub().writes;
+    ssize_t done;
+
+    if ((SdStub().stall_every != 0) && ((count % SdStub().stall_every) == 0))
+    {
+      usleep(SdStub().stall_us);
+    }
+    if (((SdStub().fail_every != 0) && ((count % SdStub().fail_every) == 0)) || (fd < 0))
+    {
+      return 0;
+    }
+    done = ::write(fd, pBuff, n);
+    return (done < 0) ? 0 : (size_t)done;
+  }
+  int read(void *pBuff, size_t n) { ssize_t done = (fd < 0) ? -1 : ::read(fd, pBuff, n); return (done < 0) ? 0 : (int)done; }
+  bool seek(uint32_t pos) { return (fd >= 0) && (lseek(fd, pos, SEEK_SET) == (off_t)pos); }
+  uint32_t size() { struct stat st; return ((fd >= 0) && (fstat(fd, &st) == 0)) ? (uint32_t)st.st_size : 0; }
+  void flush() {}
+  void close() { if (fd >= 0) { ::close(fd); } fd = -1; }
+  operator bool() const { return fd >= 0; }
+  bool operator==(const void *) const { return fd < 0; }
+
+private:
+  int fd;
+};
+
+/**
+ * @brief SD card mounted at SD_MOUNT_DIR.
+ */
+class SDClass
+{
+public:
+  bool begin() { return (::mkdir(SD_MOUNT_DIR, 0777) == 0) || exists("/"); }
+  File open(const char *pName, int flag = FILE_READ)
+  {
+    SdStub().opens++;
+    return File(::open(Path(pName).c_str(), flag, 0666));
+  }
+  bool exists(const char *pName) { struct stat st; return stat(Path(pName).c_str(), &st) == 0; }
+  bool remove(const char *pName) { return unlink(Path(pName).c_str()) == 0; }
+  bool mkdir(const char *pName) { return ::mkdir(Path(pName).c_str(), 0777) == 0; }
+
+private:
+  static std::string Path(const char *pName) { return std::string(SD_MOUNT_DIR) + ((pName[0] == '/') ? pName + 1 : pName); }
+};
+
+#endif /* _TEST_STUB_SDHCI_H_ */
@@ -0,0 +1,21 @@
+/**
+ * @file Watchdog.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Spresense watchdog for the tests in test/.
+ */
+
+#ifndef _TEST_STUB_WATCHDOG_H_
+#define _TEST_STUB_WATCHDOG_H_
+
+class WatchdogClass
+{
+public:
+  void begin() {}
+  void start(unsigned) {}
+  void stop() {}
+  void kick() {}
+};
+
+static WatchdogClass Watchdog __attribute__((unused));
+
+#endif /* _TEST_STUB_WATCHDOG_H_ */
@@ -0,0 +1,28 @@
+/**
+ * @file Wire.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Host stand-in of the Arduino I2C library for the tests in test/.
+ */
+
+#ifndef _TEST_STUB_WIRE_H_
+#define _TEST_STUB_WIRE_H_
+
+#include <Arduino.h>
+
+class TwoWire
+{
+public:
+  void begin() {}
+  void end() {}
+  void beginTransmission(int) {}
+  uint8_t endTransmission(bool = true) { return 0; }
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t *, size_t n) { return n; }
+  uint8_t requestFrom(int, int, bool = true) { return 0; }
+  int available() { return 0; }
+  int read() { return 0; }
+};
+
+static TwoWire Wire __attribute__((unused));
+
+#endif /* _TEST_STUB_WIRE_H_ */
@@ -0,0 +1,69 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _TEST_CHECK_H_
+#define _TEST_CHECK_H_
+
+/**
+ * @file test_check.h
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Check counter shared by the host tests in test/.
+ */
+
+#include <stdio.h>
+
+static int Failures = 0;          /**< Failed checks */
+
+/**
+ * @brief Count a failed check.
+ * 
+ * @param [in] ok Check result
+ * @param [in] pName Test name
+ * @param [in] pWhat What was checked
+ */
+static void Check(bool ok, const char *pName, const char *pWhat)
+{
+  if (ok != true)
+  {
+    printf("FAIL %s: %s\n", pName, pWhat);
+    Failures++;
+  }
+  else
+  {
+    /* do nothing. */
+  }
+}
+
+/**
+ * @brief Print the result of the test.
+ * 
+ * @return Exit code of the test, 0 if every check passed
+ */
+static int CheckResult(void)
+{
+  printf("%s: %d failures\n", (Failures == 0) ? "PASS" : "FAIL", Failures);
+  return (Failures == 0) ? 0 : 1;
+}
+
+#endif /* _TEST_CHECK_H_ */
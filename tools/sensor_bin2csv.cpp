@@ -0,0 +1,260 @@
+/*
+MIT License
+
+Copyright (c) 2020 TechnoPro, Inc. TechnoPro Design Company
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * @file sensor_bin2csv.cpp
+ * @author TechnoPro, Inc. TechnoPro Design Company
+ * @brief Convert SENSOR%08d.BIN and BURST%08d.BIN files back to the CSV layout.
+ * @details Host side tool. Build:
+ *          g++ -O2 -Imain -o sensor_bin2csv tools/sensor_bin2csv.cpp
+ *              main/sensor_binary.cpp main/sensor_codec.cpp main/sensor_format.cpp
+ *          Usage: sensor_bin2csv SENSOR00000001.BIN [SENSOR00000001.CSV]
+ *          A file close record is checked against the bytes before it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sensor_binary.h"
+#include "sensor_codec.h"
+
+/**
+ * @brief Macro definitions
+ */
+#define RECORD_BUFFER_SIZE     65540          /**< Largest record: tag + 16 bit length */
+
+/**
+ * @brief Get the smallest length a record needs to be decoded.
+ * 
+ * @param [in] type Record type
+ * @param [in] num Count field of the tag
+ * @param [in] pHead File header
+ * @return Record length including the tag, 0 if the decoder checks it
+ */
+static int RecordSize(uint8_t type, uint8_t num, const SensorBinHead *pHead)
+{
+  switch (type)
+  {
+    case eBinBlock:
+      return SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BLOCK_HEAD +
+             num * ((pHead->version < 2) ? SENSOR_BIN_SAMPLE_SIZE_V1 : SENSOR_BIN_SAMPLE_SIZE);
+
+    case eBinJitter:
+      return SENSOR_BIN_JITTER_SIZE;
+
+    case eBinTime:
+      return SENSOR_BIN_TIME_SIZE;
+
+    case eBinGnss:
+      return SENSOR_BIN_GNSS_SIZE;
+
+    case eBinTrack:
+      return SENSOR_BIN_TRACK_SIZE;
+
+    case eBinBurst:
+      return SENSOR_BIN_TAG_SIZE + SENSOR_BIN_BURST_HEAD + num * 6;
+
+    case eBinClose:
+      return SENSOR_BIN_CLOSE_SIZE;
+
+    case eBinDelta:
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Convert one binary file.
+ * 
+ * @param [in] pIn Binary file
+ * @param [in] pOut CSV file
+ * @return 0 if success, -1 if failure
+ */
+static int Convert(FILE *pIn, FILE *pOut)
+{
+  static uint8_t Record[RECORD_BUFFER_SIZE];
+  char Line[SENSOR_RECORD_MAX];
+  SensorBinHead Head;
+  SensorBinJitter Jitter;
+  SensorBinTime Time;
+  SensorBinGnss Gnss;
+  SensorBinTrack Track;
+  SensorBinBurst Burst;
+  SensorBinClose Close;
+  SensorRecord Sample;
+  SensorCodecDecoder Decoder;
+  uint8_t type;
+  uint8_t num;
+  uint32_t bytes;
+  uint32_t crc;
+  int length;
+  int cnt;
+
+  if ((fread(Record, 1, SENSOR_BIN_HEADER_SIZE, pIn) != SENSOR_BIN_HEADER_SIZE) ||
+      (SensorBinReadHead(Record, &Head) != 0))
+  {
+    fprintf(stderr, "Not a sensor binary file.\n");
+    return -1;
+  }
+  bytes = SENSOR_BIN_HEADER_SIZE;
+  crc = SensorBinCrc32(0, Record, SENSOR_BIN_HEADER_SIZE);
+
+  while (fread(Record, 1, SENSOR_BIN_TAG_SIZE, pIn) == SENSOR_BIN_TAG_SIZE)
+  {
+    length = SensorBinReadTag(Record, &type, &num);
+    if (type == 0)
+    {
+      /* Unwritten preallocated space, the logger lost power. */
+      break;
+    }
+    if (fread(&Record[SENSOR_BIN_TAG_SIZE], 1, length - SENSOR_BIN_TAG_SIZE, pIn) != (size_t)(length - SENSOR_BIN_TAG_SIZE))
+    {
+      fprintf(stderr, "Truncated record.\n");
+      return -1;
+    }
+    if (length < RecordSize(type, num, &Head))
+    {
+      /* Torn by a power loss, the rest of the buffer is from the record before. */
+      fprintf(stderr, "Corrupt record.\n");
+      return -1;
+    }
+
+    switch (type)
+    {
+      case eBinBlock:
+        for (cnt = 0; cnt < num; cnt++)
+        {
+          SensorBinReadSample(Record, cnt, &Head, &Sample);
+          fwrite(Line, 1, FormatSensorRecord(Line, sizeof(Line), &Sample), pOut);
+        }
+        break;
+
+      case eBinDelta:
+        SensorCodecBegin(&Decoder, Record, &Head);
+        while ((cnt = SensorCodecNext(&Decoder, &Sample)) > 0)
+        {
+          fwrite(Line, 1, FormatSensorRecord(Line, sizeof(Line), &Sample), pOut);
+        }
+        if (cnt < 0)
+        {
+          fprintf(stderr, "Corrupt delta block.\n");
+          return -1;
+        }
+        break;
+
+      case eBinJitter:
+        SensorBinReadJitter(Record, &Jitter);
+        fprintf(pOut, "$J00300,0x%04X,%lu,%lu,%lu,%lu,%lu\n", Head.device,
+                (unsigned long)Jitter.seq, (unsigned long)Jitter.num, (unsigned long)Jitter.min_us,
+                (unsigned long)Jitter.max_us, (unsigned long)Jitter.dropped);
+        break;
+
+      case eBinTime:
+        SensorBinReadTime(Record, &Time);
+        *FormatSensorTime(Line, Time.sec, Time.msec) = '\0';
+        fprintf(pOut, "$T00300,0x%04X,%s,%lu,%s,%ld,%ld\n", Head.device, Line, (unsigned long)Time.seq,
+                SensorBinTimeName(Time.type), (long)Time.offset_us, (long)Time.adjust_us);
+        break;
+
+      case eBinGnss:
+        SensorBinReadGnss(Record, &Gnss);
+        fprintf(pOut, "$G00300,0x%04X,%lu,%s,%s,%lu,%lu,%u,%ld,%ld,%lu\n", Head.device, (unsigned long)Gnss.seq,
+                SensorBinGnssStartName(Gnss.start), (Gnss.result == eGnssFixed) ? "FIX" : "TIMEOUT", (unsigned long)Gnss.ttff_ms, (unsigned long)Gnss.on_ms,
+                (unsigned)Gnss.fixes, (long)Gnss.error_us, (long)Gnss.residual_us, (unsigned long)Gnss.energy_mj);
+        break;
+
+      case eBinTrack:
+        SensorBinReadTrack(Record, &Track);
+        fwrite(Line, 1, SensorBinFormatTrack(Line, sizeof(Line), Head.device, &Track), pOut);
+        break;
+
+      case eBinBurst:
+        SensorBinReadBurst(Record, &Burst);
+        for (cnt = 0; cnt < Burst.num; cnt++)
+        {
+          fwrite(Line, 1, SensorBinFormatBurst(Line, sizeof(Line), Head.device, Head.sens, &Burst, cnt), pOut);
+        }
+        break;
+
+      case eBinClose:
+        SensorBinReadClose(Record, &Close);
+        fwrite(Line, 1, SensorBinFormatClose(Line, sizeof(Line), Head.device, &Close), pOut);
+        if ((Close.bytes != bytes) || (Close.crc != crc))
+        {
+          fprintf(stderr, "File check failed: %lu bytes, crc32 %08lx, close record %lu bytes, crc32 %08lx.\n",
+                  (unsigned long)bytes, (unsigned long)crc, (unsigned long)Close.bytes, (unsigned long)Close.crc);
+          return -1;
+        }
+        break;
+
+      default:
+        /* Unknown record, skip. */
+        break;
+    }
+    bytes += length;
+    crc = SensorBinCrc32(crc, Record, length);
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  FILE *pIn;
+  FILE *pOut = stdout;
+  int ret;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "Usage: %s SENSORxxxxxxxx.BIN [output.CSV]\n", argv[0]);
+    return 1;
+  }
+
+  pIn = fopen(argv[1], "rb");
+  if (pIn == NULL)
+  {
+    perror(argv[1]);
+    return 1;
+  }
+
+  if (argc >= 3)
+  {
+    pOut = fopen(argv[2], "w");
+    if (pOut == NULL)
+    {
+      perror(argv[2]);
+      fclose(pIn);
+      return 1;
+    }
+  }
+
+  ret = Convert(pIn, pOut);
+
+  fclose(pIn);
+  if (pOut != stdout)
+  {
+    fclose(pOut);
+  }
+
+  return (ret == 0) ? 0 : 1;
+}